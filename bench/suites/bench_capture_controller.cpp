@@ -0,0 +1,699 @@
+#include <vector>
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdarg>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <benchmark/benchmark.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/SyntheticCapture.hpp"
+#include "common/LatencyHistogram.hpp"
+#include "common/AsyncLogger.hpp"
+#include "common/MotionGate.hpp"
+#include "common/PixelConversion.hpp"
+#include "common/SharedFramePublisher.hpp"
+#include "common/SharedFrameCapture.hpp"
+#include "common/CaptureExecutor.hpp"
+
+
+static constexpr int jitter_us_ = 500;
+static constexpr uint64_t numFrames_ = 120;  // frames per controller and session (2 s at 60 fps)
+
+// what one reader saw during a session
+struct ReaderResult
+{
+    std::vector<uint64_t> Latencies;  // [ns] due time of the frame to its delivery
+    uint64_t Delivered = 0;
+    uint64_t Skipped = 0;
+};
+
+static double GetPercentile(std::vector<uint64_t>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    auto idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return static_cast<double>(sorted[idx]);
+}
+
+// latest-frame readers polling ReadNext, as the tests and the sample do
+static void ReadLatest(MultiThreadCaptureController* controller, ReaderResult* result)
+{
+    uint64_t lastSequence = 0;
+    while (true)
+    {
+        auto [data, time, sequence, skipped] = controller->ReadNext(lastSequence);
+        if (data == nullptr)
+        {
+            break;
+        }
+
+        result->Latencies.push_back(SyntheticCapture::GetTimeAsNs() - SyntheticCapture::StampOf(data.get()).Time);
+        result->Skipped += skipped;
+        ++result->Delivered;
+        lastSequence = sequence;
+    }
+}
+
+// broadcast readers taking every frame through their own FrameConsumer
+static void ReadEvery(FrameConsumer* consumer, ReaderResult* result)
+{
+    while (auto lease = consumer->ReadNext())
+    {
+        result->Latencies.push_back(SyntheticCapture::GetTimeAsNs() - SyntheticCapture::StampOf(lease.Get()).Time);
+        ++result->Delivered;
+    }
+    result->Skipped = consumer->GetStats().Dropped;
+}
+
+// arguments: readers per controller, controllers, fps (0: unpaced), frame width (16:9), use FrameConsumer
+//
+// Each iteration is one session of numFrames_ frames per controller. Reported per reader:
+// fps delivered, drop rate (frames published but never delivered) and capture-to-read latency percentiles [us].
+static void BM_CaptureController(benchmark::State& state)
+{
+    auto numReaders = static_cast<int>(state.range(0));
+    auto numControllers = static_cast<int>(state.range(1));
+    auto fps = static_cast<double>(state.range(2));
+    auto width = static_cast<uint32_t>(state.range(3));
+    auto height = width * 9 / 16;
+    auto useConsumer = (state.range(4) != 0);
+
+    auto latencies = std::vector<uint64_t>{};
+    uint64_t delivered = 0;
+    uint64_t skipped = 0;
+    double elapsed = 0.0;
+
+    for (auto _ : state)
+    {
+        auto controllers = std::vector<std::unique_ptr<MultiThreadCaptureController>>{};
+        auto consumers = std::vector<std::unique_ptr<FrameConsumer>>{};
+        for (int c = 0; c < numControllers; ++c)
+        {
+            auto cap = new SyntheticCapture(width, height, 3, fps, (fps > 0.0) ? jitter_us_ : 0, numFrames_, c);
+            controllers.emplace_back(new MultiThreadCaptureController(cap, true));
+            controllers.back()->Setup();
+            for (int r = 0; useConsumer && (r < numReaders); ++r)
+            {
+                consumers.push_back(controllers.back()->RegisterConsumer());
+            }
+        }
+
+        auto results = std::vector<ReaderResult>(numControllers * numReaders);
+        for (auto& result : results)
+        {
+            result.Latencies.reserve(numFrames_);
+        }
+
+        auto begin = SyntheticCapture::GetTimeAsNs();
+        auto readers = std::vector<std::thread>{};
+        for (int c = 0; c < numControllers; ++c)
+        {
+            for (int r = 0; r < numReaders; ++r)
+            {
+                auto result = &results[c * numReaders + r];
+                if (useConsumer)
+                {
+                    readers.emplace_back(ReadEvery, consumers[c * numReaders + r].get(), result);
+                }
+                else
+                {
+                    readers.emplace_back(ReadLatest, controllers[c].get(), result);
+                }
+            }
+            controllers[c]->StartCapture();
+        }
+
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+        elapsed += (SyntheticCapture::GetTimeAsNs() - begin) * 1e-9;
+
+        for (auto& result : results)
+        {
+            latencies.insert(latencies.end(), result.Latencies.begin(), result.Latencies.end());
+            delivered += result.Delivered;
+            skipped += result.Skipped;
+        }
+
+        consumers.clear();
+        for (auto& controller : controllers)
+        {
+            controller->FinishCapture();
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto numReadersTotal = static_cast<double>(numControllers * numReaders);
+    auto published = static_cast<double>(state.iterations() * numFrames_) * numReadersTotal;
+
+    state.counters["fps"] = benchmark::Counter(delivered / numReadersTotal / elapsed);
+    state.counters["drop_rate"] = benchmark::Counter(1.0 - delivered / published);
+    state.counters["skipped"] = benchmark::Counter(static_cast<double>(skipped) / state.iterations());
+    state.counters["p50_us"] = benchmark::Counter(GetPercentile(latencies, 0.50) * 1e-3);
+    state.counters["p90_us"] = benchmark::Counter(GetPercentile(latencies, 0.90) * 1e-3);
+    state.counters["p99_us"] = benchmark::Counter(GetPercentile(latencies, 0.99) * 1e-3);
+    state.counters["max_us"] = benchmark::Counter(latencies.empty() ? 0.0 : latencies.back() * 1e-3);
+}
+
+// scaling with the number of readers, one 1080p60 controller
+BENCHMARK(BM_CaptureController)->Name("Readers")
+    ->ArgNames({ "readers", "controllers", "fps", "width", "consumer" })
+    ->Args({ 1, 1, 60, 1920, 0 })->Args({ 2, 1, 60, 1920, 0 })->Args({ 4, 1, 60, 1920, 0 })->Args({ 8, 1, 60, 1920, 0 })
+    ->Args({ 1, 1, 60, 1920, 1 })->Args({ 2, 1, 60, 1920, 1 })->Args({ 4, 1, 60, 1920, 1 })->Args({ 8, 1, 60, 1920, 1 })
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// scaling with the number of cameras, one reader each
+BENCHMARK(BM_CaptureController)->Name("Controllers")
+    ->ArgNames({ "readers", "controllers", "fps", "width", "consumer" })
+    ->Args({ 1, 1, 60, 1920, 0 })->Args({ 1, 2, 60, 1920, 0 })->Args({ 1, 4, 60, 1920, 0 })->Args({ 1, 8, 60, 1920, 0 })
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// unpaced sources: the frame rate the controller sustains, by resolution
+BENCHMARK(BM_CaptureController)->Name("Unpaced")
+    ->ArgNames({ "readers", "controllers", "fps", "width", "consumer" })
+    ->Args({ 1, 1, 0, 640, 0 })->Args({ 1, 1, 0, 1920, 0 })->Args({ 1, 1, 0, 3840, 0 })
+    ->Args({ 1, 1, 0, 640, 1 })->Args({ 1, 1, 0, 1920, 1 })->Args({ 1, 1, 0, 3840, 1 })
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+/* ----- Cost of the statistics ----- */
+
+static void BM_HistogramRecord(benchmark::State& state)
+{
+    static LatencyHistogram histogram;
+    uint64_t value = 1000 + state.thread_index();
+
+    for (auto _ : state)
+    {
+        histogram.Record(value);
+        value = value * 13 % 1000003;
+    }
+}
+
+BENCHMARK(BM_HistogramRecord)->Threads(1)->Threads(4)->UseRealTime();
+
+// argument: CollectStats; each iteration leases the latest frame of an unpaced source
+static void BM_LeaseWithStats(benchmark::State& state)
+{
+    auto config = CaptureControllerConfig{};
+    config.CollectStats = (state.range(0) != 0);
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, 0.0), true, config);
+    controller.Setup();
+    controller.StartCapture();
+
+    for (auto _ : state)
+    {
+        auto lease = controller.Lease();
+        benchmark::DoNotOptimize(lease.Data());
+    }
+
+    controller.FinishCapture();
+}
+
+BENCHMARK(BM_LeaseWithStats)->ArgName("stats")->Arg(0)->Arg(1);
+
+
+/* ----- Cost of the debug log ----- */
+
+// what __logMessage did before: format on the calling thread and print synchronously
+static void SyncLogMessage(FILE* output, int line, const char* str, const char* fmt, ...)
+{
+    char buf[1024];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+
+    std::fprintf(output, "[%d][%s] %s (Line:%d @%s)\n", 0, str, buf, line, __FILE__);
+}
+
+static void BM_SyncLog(benchmark::State& state)
+{
+    static FILE* output = nullptr;
+    if (state.thread_index() == 0)
+    {
+        output = std::fopen("/dev/null", "w");
+    }
+    uint64_t sequence = 0;
+
+    for (auto _ : state)
+    {
+        SyncLogMessage(output, __LINE__, "GetLatestIndex", "locked=%d, sequence=%lu", 1, ++sequence);
+    }
+
+    if (state.thread_index() == 0)
+    {
+        std::fclose(output);
+    }
+}
+
+static void BM_AsyncLog(benchmark::State& state)
+{
+    auto& logger = AsyncLogger::GetInstance();
+    static FILE* output = nullptr;
+    if (state.thread_index() == 0)
+    {
+        output = std::fopen("/dev/null", "w");
+        logger.SetOutput(output);
+    }
+    uint64_t sequence = 0;
+    auto dropped = logger.GetNumDropped();
+
+    for (auto _ : state)
+    {
+        CAPTURE_LOG(LogLevel::Trace, "GetLatestIndex", "locked=%d, sequence=%lu", 1, ++sequence);
+
+        // let the logger's thread catch up out of the timing, so that records are written rather than dropped
+        if ((sequence % 1024) == 0)
+        {
+            state.PauseTiming();
+            logger.Flush();
+            state.ResumeTiming();
+        }
+    }
+
+    state.counters["dropped"] = benchmark::Counter(static_cast<double>(logger.GetNumDropped() - dropped), benchmark::Counter::kAvgIterations);
+
+    if (state.thread_index() == 0)
+    {
+        logger.SetOutput(stdout);
+        std::fclose(output);
+    }
+}
+
+BENCHMARK(BM_SyncLog)->Threads(1)->Threads(4)->UseRealTime();
+BENCHMARK(BM_AsyncLog)->Threads(1)->Threads(4)->UseRealTime();
+
+
+/* ----- Jitter of the capture thread ----- */
+
+// arguments: scheduling policy (SCHED_OTHER, SCHED_FIFO), pin to CPU 0, busy threads competing for the CPUs
+//
+// A 1000 fps source runs for one second while busy threads load every CPU. Reported are the percentiles of
+// how late each frame was published after it was due [us], and how often the capture thread migrated.
+static void BM_CaptureJitter(benchmark::State& state)
+{
+    constexpr double fps = 1000.0;
+    constexpr uint64_t numFrames = 1000;
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 64;  // the reader may be held off by the busy threads, the frames wait for it
+    config.SchedPolicy = static_cast<int>(state.range(0));
+    config.SchedPriority = (config.SchedPolicy == SCHED_OTHER) ? 0 : 10;
+    if (state.range(1) != 0)
+    {
+        config.CpuAffinity = { 0 };
+        config.NumaNode = 0;
+    }
+    auto numBusy = static_cast<int>(state.range(2));
+
+    auto lateness = std::vector<uint64_t>{};
+    auto stats = CaptureStats{};
+    for (auto _ : state)
+    {
+        auto isBusy = std::atomic<bool>(true);
+        auto busy = std::vector<std::thread>{};
+        for (int n = 0; n < numBusy; ++n)
+        {
+            busy.emplace_back([&isBusy]{
+                uint64_t count = 0;
+                while (isBusy.load(std::memory_order_relaxed))
+                {
+                    benchmark::DoNotOptimize(++count);
+                }
+            });
+        }
+
+        auto controller = MultiThreadCaptureController(new SyntheticCapture(640, 360, 3, fps, 0, numFrames), true, config);
+        controller.Setup();
+        auto consumer = controller.RegisterConsumer();
+        controller.StartCapture();
+
+        while (auto lease = consumer->ReadNext())
+        {
+            auto due = SyntheticCapture::StampOf(lease.Get()).Time;
+            lateness.push_back((lease.GetCapturedTime() > due) ? lease.GetCapturedTime() - due : 0);
+        }
+        stats = controller.GetStats();
+        consumer.reset();
+        controller.FinishCapture();
+
+        isBusy.store(false, std::memory_order_relaxed);
+        for (auto& thread : busy)
+        {
+            thread.join();
+        }
+    }
+
+    std::sort(lateness.begin(), lateness.end());
+    state.SetLabel(std::string((stats.SchedPolicy == SCHED_FIFO) ? "fifo" : "other") + (stats.IsPinned ? ", pinned" : ""));
+    state.counters["late_p50_us"] = benchmark::Counter(GetPercentile(lateness, 0.50) * 1e-3);
+    state.counters["late_p99_us"] = benchmark::Counter(GetPercentile(lateness, 0.99) * 1e-3);
+    state.counters["late_p999_us"] = benchmark::Counter(GetPercentile(lateness, 0.999) * 1e-3);
+    state.counters["late_max_us"] = benchmark::Counter(lateness.empty() ? 0.0 : lateness.back() * 1e-3);
+    state.counters["migrations"] = benchmark::Counter(static_cast<double>(stats.Migrations));
+}
+
+static void RegisterJitterCases(benchmark::internal::Benchmark* bench)
+{
+    auto numBusy = static_cast<int64_t>(std::thread::hardware_concurrency());
+    for (auto busy : { int64_t{0}, numBusy })
+    {
+        for (auto policy : { SCHED_OTHER, SCHED_FIFO })
+        {
+            for (auto pinned : { 0, 1 })
+            {
+                bench->Args({ policy, pinned, busy });
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_CaptureJitter)->ArgNames({ "policy", "pinned", "busy" })->Apply(RegisterJitterCases)
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+/* ----- Lazy retrieve ----- */
+
+static double GetCpuTimeAsMs(void)
+{
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-3;
+}
+
+// argument: LazyRetrieve
+//
+// A 60 fps 1080p source, whose fill stands for the decode, runs for two seconds while one reader leases the latest
+// frame at 15 fps. Reported are the frames decoded, the CPU time of the process and the age of the frames read [us].
+static void BM_LazyRetrieve(benchmark::State& state)
+{
+    constexpr double fps = 60.0;
+    constexpr uint64_t numFrames = 120;
+    constexpr auto readInterval = std::chrono::microseconds(1000000 / 15);
+
+    auto config = CaptureControllerConfig{};
+    config.LazyRetrieve = (state.range(0) != 0);
+
+    auto ages = std::vector<uint64_t>{};
+    auto stats = CaptureStats{};
+    auto cpu = 0.0;
+    for (auto _ : state)
+    {
+        auto begin = GetCpuTimeAsMs();
+        auto controller = MultiThreadCaptureController(new SyntheticCapture(1920, 1080, 3, fps, 0, numFrames), true, config);
+        controller.Setup();
+        controller.StartCapture();
+
+        while (auto lease = controller.Lease())
+        {
+            ages.push_back(SyntheticCapture::GetTimeAsNs() - SyntheticCapture::StampOf(lease.Get()).Time);
+            lease.Release();
+            std::this_thread::sleep_for(readInterval);
+        }
+        stats = controller.GetStats();
+        controller.FinishCapture();
+        cpu += GetCpuTimeAsMs() - begin;
+    }
+
+    std::sort(ages.begin(), ages.end());
+    state.counters["decoded"] = benchmark::Counter(static_cast<double>(stats.Produced));
+    state.counters["not_retrieved"] = benchmark::Counter(static_cast<double>(stats.NotRetrieved));
+    state.counters["cpu_ms"] = benchmark::Counter(cpu, benchmark::Counter::kAvgIterations);
+    state.counters["age_p50_us"] = benchmark::Counter(GetPercentile(ages, 0.50) * 1e-3);
+    state.counters["age_p99_us"] = benchmark::Counter(GetPercentile(ages, 0.99) * 1e-3);
+}
+
+BENCHMARK(BM_LazyRetrieve)->ArgName("lazy")->Arg(0)->Arg(1)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+/* ----- Temporal windows ----- */
+
+// arguments: window length, packed
+//
+// Each iteration builds an N x H x W x C tensor of the newest 720p frames of a 120 fps source: by copying the frames
+// of a window into one buffer, or by taking the window packed by the producer as it captured.
+static void BM_ReadWindow(benchmark::State& state)
+{
+    auto length = static_cast<int>(state.range(0));
+    auto isPacked = (state.range(1) != 0);
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = length + 4;
+    config.PackedWindowCapacity = isPacked ? length * 2 : 0;
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(1280, 720, 3, 120.0), true, config);
+    controller.Setup();
+    controller.StartCapture();
+
+    auto sizeOfFrame = controller.GetFormat().GetSizeOfFrame();
+    auto tensor = std::vector<uint8_t>(isPacked ? 0 : sizeOfFrame * length);
+    uint64_t numUnpacked = 0;
+    for (auto _ : state)
+    {
+        auto window = controller.ReadWindow(length, isPacked);
+        if (!isPacked || !window.IsPacked())
+        {
+            numUnpacked += isPacked ? 1 : 0;
+            for (int n = 0; n < window.GetLength(); ++n)
+            {
+                std::memcpy(tensor.data() + sizeOfFrame * n, window[n].Data(), sizeOfFrame);
+            }
+            benchmark::DoNotOptimize(tensor.data());
+            continue;
+        }
+        benchmark::DoNotOptimize(window.GetPacked());
+    }
+    state.counters["unpacked"] = benchmark::Counter(static_cast<double>(numUnpacked));
+
+    controller.FinishCapture();
+}
+
+BENCHMARK(BM_ReadWindow)->ArgNames({ "length", "packed" })
+    ->Args({ 4, 0 })->Args({ 4, 1 })->Args({ 8, 0 })->Args({ 8, 1 })->Unit(benchmark::kMicrosecond);
+
+
+/* ----- Motion gate ----- */
+
+// arguments: instruction set, grid step; each iteration measures the change between two 1080p BGR frames
+static void BM_MotionGate(benchmark::State& state)
+{
+    auto isa = static_cast<PixelIsa>(state.range(0));
+    if (!PixelConversion::SetIsa(isa))
+    {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+
+    auto format = FrameFormat{ 1920, 1080, 3, 1, 0 };
+    auto a = std::vector<uint8_t>(format.GetSizeOfFrame(), 0x5a);
+    auto b = std::vector<uint8_t>(format.GetSizeOfFrame(), 0x5b);
+    auto frame = CaptureDataObject(a.data(), format);
+    auto reference = CaptureDataObject(b.data(), format);
+    auto gate = MotionGate(2.0, static_cast<uint32_t>(state.range(1)));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(gate.Measure(&frame, &reference));
+    }
+
+    state.SetLabel(PixelConversion::GetIsaName(isa));
+
+    PixelConversion::SetIsa(PixelConversion::GetBestIsa());
+}
+
+static void RegisterMotionGateCases(benchmark::internal::Benchmark* bench)
+{
+    for (auto step : { 1, 4 })
+    {
+        for (auto isa : { PixelIsa::Scalar, PixelIsa::Sse41, PixelIsa::Avx2, PixelIsa::Neon })
+        {
+            bench->Args({ static_cast<int64_t>(isa), step });
+        }
+    }
+}
+
+BENCHMARK(BM_MotionGate)->ArgNames({ "isa", "step" })->Apply(RegisterMotionGateCases)->Unit(benchmark::kMicrosecond);
+
+
+/* ----- Shared memory ----- */
+
+// arguments: zero copy; each iteration publishes a 1080p BGR frame and reads it back through the shared ring
+static void BM_SharedFrames(benchmark::State& state)
+{
+    auto isZeroCopy = (state.range(0) != 0);
+    auto name = "/BM_SharedFrames_" + std::to_string(getpid());
+
+    auto format = FrameFormat{ 1920, 1080, 3, 1, 0 };
+    auto source = std::vector<uint8_t>(format.GetSizeOfFrame(), 0x5a);
+    auto target = std::vector<uint8_t>(format.GetSizeOfFrame());
+    auto frame = CaptureDataObject(source.data(), format);
+    auto copied = CaptureDataObject(target.data(), format);
+
+    auto publisher = SharedFramePublisher(name, format, 8);
+    auto client = SharedFrameCapture(name, isZeroCopy);
+    if (!client.IsOpen())
+    {
+        state.SkipWithError("shared memory not available");
+        return;
+    }
+
+    uint64_t sequence = 0;
+    for (auto _ : state)
+    {
+        ++sequence;
+        publisher.Publish(&frame, sequence, sequence);
+        if (isZeroCopy)
+        {
+            benchmark::DoNotOptimize(client.Borrow());
+        }
+        else
+        {
+            client.Capture(&copied);
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * format.GetSizeOfFrame());
+}
+
+BENCHMARK(BM_SharedFrames)->ArgName("zero_copy")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+
+/* ----- Shared capture workers ----- */
+
+// arguments: streams, workers (0: a thread per controller)
+//
+// Each stream is a 30 fps VGA source of 60 frames (two seconds); one reader goes round the controllers leasing
+// the latest frame. Reported are the CPU time and the context switches of the process, and the time from a frame
+// being due to it being published [us].
+static void BM_CaptureExecutor(benchmark::State& state)
+{
+    constexpr double fps = 30.0;
+    constexpr uint64_t numFrames = 60;
+
+    auto numStreams = static_cast<int>(state.range(0));
+    auto numWorkers = static_cast<int>(state.range(1));
+
+    auto latencies = std::vector<uint64_t>{};
+    auto cpu = 0.0;
+    auto switches = 0.0;
+    for (auto _ : state)
+    {
+        auto executor = std::unique_ptr<CaptureExecutor>((numWorkers > 0) ? new CaptureExecutor(numWorkers) : nullptr);
+        auto config = CaptureControllerConfig{};
+        config.Executor = executor.get();
+
+        auto usage = rusage{};
+        getrusage(RUSAGE_SELF, &usage);
+        auto beginSwitches = usage.ru_nvcsw + usage.ru_nivcsw;
+        auto begin = GetCpuTimeAsMs();
+
+        auto controllers = std::vector<std::unique_ptr<MultiThreadCaptureController>>{};
+        for (int n = 0; n < numStreams; ++n)
+        {
+            controllers.emplace_back(new MultiThreadCaptureController(new SyntheticCapture(640, 480, 3, fps, 0, numFrames), true, config));
+            controllers.back()->Setup();
+            controllers.back()->StartCapture();
+        }
+
+        auto sequences = std::vector<uint64_t>(numStreams, 0);
+        auto numEnded = 0;
+        while (numEnded < numStreams)
+        {
+            numEnded = 0;
+            for (int n = 0; n < numStreams; ++n)
+            {
+                auto lease = controllers[n]->LeaseNext(sequences[n], 1000 * 1000);
+                if (!lease.IsValid())
+                {
+                    numEnded += (controllers[n]->GetState() == MultiThreadCaptureController::CaptureState::Quit) ? 1 : 0;
+                    continue;
+                }
+                latencies.push_back(lease.GetCapturedTime() - SyntheticCapture::StampOf(lease.Get()).Time);
+                sequences[n] = lease.GetSequence();
+            }
+        }
+
+        for (auto& controller : controllers)
+        {
+            controller->FinishCapture();
+        }
+
+        cpu += GetCpuTimeAsMs() - begin;
+        getrusage(RUSAGE_SELF, &usage);
+        switches += static_cast<double>(usage.ru_nvcsw + usage.ru_nivcsw - beginSwitches);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["cpu_ms"] = benchmark::Counter(cpu, benchmark::Counter::kAvgIterations);
+    state.counters["ctx_switches"] = benchmark::Counter(switches, benchmark::Counter::kAvgIterations);
+    state.counters["latency_p50_us"] = benchmark::Counter(GetPercentile(latencies, 0.50) * 1e-3);
+    state.counters["latency_p99_us"] = benchmark::Counter(GetPercentile(latencies, 0.99) * 1e-3);
+}
+
+BENCHMARK(BM_CaptureExecutor)->ArgNames({ "streams", "workers" })
+    ->Args({ 64, 0 })->Args({ 64, 2 })->Args({ 64, 4 })
+    ->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+/* ----- Buffering policy ----- */
+
+// argument: 0 latest only, 1 lossless and blocking, 2 lossless and dropping
+//
+// An unpaced VGA source of 2000 frames feeds one reader, which takes the latest frames with LeaseNext, or the queue
+// of 8 frames with Dequeue, touching each frame. Reported are the frames per second published and those the reader
+// got or missed.
+static void BM_BufferingPolicy(benchmark::State& state)
+{
+    constexpr uint64_t numFrames = 2000;
+
+    auto config = CaptureControllerConfig{};
+    config.Buffering = (state.range(0) == 0) ? BufferingPolicy::LatestOnly : BufferingPolicy::Lossless;
+    config.QueueOverflow = (state.range(0) == 2) ? QueueOverflowPolicy::Drop : QueueOverflowPolicy::Block;
+    config.QueueDepth = 8;
+
+    auto read = 0.0;
+    auto missed = 0.0;
+    auto published = 0.0;
+    for (auto _ : state)
+    {
+        auto controller = MultiThreadCaptureController(new SyntheticCapture(640, 480, 3, 0.0, 0, numFrames), true, config);
+        controller.Setup();
+        controller.StartCapture();
+
+        uint64_t sequence = 0;
+        uint64_t numRead = 0;
+        while (true)
+        {
+            auto lease = (config.Buffering == BufferingPolicy::Lossless) ? controller.Dequeue() : controller.LeaseNext(sequence);
+            if (!lease.IsValid())
+            {
+                break;
+            }
+            benchmark::DoNotOptimize(static_cast<const uint8_t*>(lease.Data())[lease.Get()->Format.GetSizeOfFrame() - 1]);
+            sequence = lease.GetSequence();
+            ++numRead;
+        }
+        controller.FinishCapture();
+
+        read += static_cast<double>(numRead);
+        missed += static_cast<double>(numFrames - numRead);
+        published += static_cast<double>(controller.GetStats().Produced);
+    }
+
+    state.counters["fps"] = benchmark::Counter(published, benchmark::Counter::kIsRate);
+    state.counters["read"] = benchmark::Counter(read, benchmark::Counter::kAvgIterations);
+    state.counters["missed"] = benchmark::Counter(missed, benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_BufferingPolicy)->ArgName("policy")->Arg(0)->Arg(1)->Arg(2)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,78 @@
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+#include <benchmark/benchmark.h>
+#include "common/EncodingSink.hpp"
+#include "cv/CvImageEncoder.hpp"
+
+
+static constexpr int width_ = 1280;
+static constexpr int height_ = 720;
+
+static const char* extensions_[] = { ".jpg", ".png" };
+
+// smooth gradient with some noise, so that the codecs have a realistic amount of work
+static std::vector<uint8_t> MakeImage(const FrameFormat& format)
+{
+    auto random = std::mt19937(0);
+    auto image = std::vector<uint8_t>(format.GetSizeOfFrame());
+    for (uint32_t y = 0; y < format.Height; ++y)
+    {
+        for (uint32_t x = 0; x < format.Width * format.NumChannels; ++x)
+        {
+            image[y * format.GetStride() + x] = static_cast<uint8_t>((x / 8 + y / 4) + (random() & 7));
+        }
+    }
+    return image;
+}
+
+// time the reader's thread spends per snapshot: imencode in place against handing the frame to a sink
+// arguments: format (0: JPEG, 1: PNG), workers (0: encode on the reader's thread)
+static void BM_EncodeSnapshot(benchmark::State& state)
+{
+    auto extension = extensions_[state.range(0)];
+    auto numWorkers = static_cast<int>(state.range(1));
+
+    auto format = FrameFormat{ width_, height_, 3, 1, 0 };
+    auto image = MakeImage(format);
+    auto frame = CaptureDataObject(image.data(), format);
+
+    auto encoder = CvImageEncoder(extension, (state.range(0) == 0) ? 90 : 1);
+    auto encoded = std::vector<uint8_t>{};
+    auto stats = EncodingSinkStats{};
+    uint64_t sequence = 0;
+
+    if (numWorkers == 0)
+    {
+        for (auto _ : state)
+        {
+            encoder.Encode(&frame, encoded);
+            benchmark::DoNotOptimize(encoded.data());
+        }
+    }
+    else
+    {
+        auto config = EncodingSinkConfig{};
+        config.NumWorkers = numWorkers;
+        config.OverflowPolicy = SinkOverflowPolicy::Block;
+        auto discard = [](uint64_t, uint64_t, const uint8_t* data, uint64_t){ benchmark::DoNotOptimize(data); return true; };
+        auto sink = EncodingSink(&encoder, false, discard, config);
+
+        for (auto _ : state)
+        {
+            sink.Submit(&frame, 0, ++sequence);
+        }
+        sink.Flush();
+        stats = sink.GetStats();
+
+        state.counters["fps"] = benchmark::Counter(stats.GetFramesPerSecond());
+        state.counters["encode_p50_ms"] = benchmark::Counter(stats.EncodeDuration.GetPercentile(0.50) * 1e-6);
+        state.counters["max_depth"] = benchmark::Counter(stats.MaxQueueDepth);
+    }
+
+    state.SetLabel(extension);
+}
+
+BENCHMARK(BM_EncodeSnapshot)->ArgNames({ "png", "workers" })
+    ->ArgsProduct({ { 0, 1 }, { 0, 1, 2, 4 } })->UseRealTime()->Unit(benchmark::kMillisecond);
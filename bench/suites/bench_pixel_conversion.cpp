@@ -0,0 +1,138 @@
+#include <vector>
+#include <cstdint>
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "common/PixelConversion.hpp"
+
+
+static constexpr int width_ = 1920;
+static constexpr int height_ = 1080;
+
+// ImageNet normalization, in RGB order
+static const float mean_[] = { 123.675f, 116.28f, 103.53f, 0.0f };
+static const float scale_[] = { 1.0f / 58.395f, 1.0f / 57.12f, 1.0f / 57.375f, 1.0f };
+
+
+static FrameFormat MakeInputFormat(PixelConversionType type)
+{
+    auto format = FrameFormat{};
+    format.Width = width_;
+    format.Height = height_;
+    format.NumChannels = (type == PixelConversionType::YuyvToBgr) ? 2 : 3;
+    format.NumBytesPerChannel = 1;
+    return format;
+}
+
+// arguments: conversion, instruction set
+static void BM_PixelConversion(benchmark::State& state)
+{
+    auto type = static_cast<PixelConversionType>(state.range(0));
+    auto isa = static_cast<PixelIsa>(state.range(1));
+    if (!PixelConversion::SetIsa(isa))
+    {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+
+    auto inputFormat = MakeInputFormat(type);
+    auto outputFormat = PixelConversion::GetOutputFormat(type, inputFormat);
+    auto inputBuffer = std::vector<uint8_t>(inputFormat.GetSizeOfFrame(), 0x5a);
+    auto outputBuffer = std::vector<uint8_t>(outputFormat.GetSizeOfFrame());
+    auto input = CaptureDataObject(inputBuffer.data(), inputFormat);
+    auto output = CaptureDataObject(outputBuffer.data(), outputFormat);
+
+    for (auto _ : state)
+    {
+        PixelConversion::Convert(type, &input, &output, mean_, scale_);
+        benchmark::DoNotOptimize(outputBuffer.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetLabel(PixelConversion::GetIsaName(isa));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * inputFormat.GetSizeOfFrame());
+
+    PixelConversion::SetIsa(PixelConversion::GetBestIsa());
+}
+
+static void RegisterIsas(benchmark::internal::Benchmark* bench, PixelConversionType type)
+{
+    for (auto isa : { PixelIsa::Scalar, PixelIsa::Sse41, PixelIsa::Avx2, PixelIsa::Neon })
+    {
+        bench->Args({ static_cast<int64_t>(type), static_cast<int64_t>(isa) });
+    }
+}
+
+BENCHMARK(BM_PixelConversion)->Name("BgrToRgb")->Apply([](benchmark::internal::Benchmark* b){ RegisterIsas(b, PixelConversionType::BgrToRgb); });
+BENCHMARK(BM_PixelConversion)->Name("BgrToGray")->Apply([](benchmark::internal::Benchmark* b){ RegisterIsas(b, PixelConversionType::BgrToGray); });
+BENCHMARK(BM_PixelConversion)->Name("BgrToPlanar")->Apply([](benchmark::internal::Benchmark* b){ RegisterIsas(b, PixelConversionType::BgrToPlanar); });
+BENCHMARK(BM_PixelConversion)->Name("YuyvToBgr")->Apply([](benchmark::internal::Benchmark* b){ RegisterIsas(b, PixelConversionType::YuyvToBgr); });
+BENCHMARK(BM_PixelConversion)->Name("U8ToF32")->Apply([](benchmark::internal::Benchmark* b){ RegisterIsas(b, PixelConversionType::U8ToF32); });
+BENCHMARK(BM_PixelConversion)->Name("BgrToRgbPlanarF32")->Apply([](benchmark::internal::Benchmark* b){ RegisterIsas(b, PixelConversionType::BgrToRgbPlanarF32); });
+
+
+/* ----- OpenCV counterparts ----- */
+
+static void BM_CvCvtColor(benchmark::State& state)
+{
+    auto code = static_cast<int>(state.range(0));
+    auto isYuyv = (code == cv::COLOR_YUV2BGR_YUYV);
+    auto input = cv::Mat(height_, width_, isYuyv ? CV_8UC2 : CV_8UC3, cv::Scalar::all(0x5a));
+    auto output = cv::Mat();
+
+    for (auto _ : state)
+    {
+        cv::cvtColor(input, output, code);
+        benchmark::DoNotOptimize(output.data);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * input.total() * input.elemSize());
+}
+
+BENCHMARK(BM_CvCvtColor)->Name("CvBgrToRgb")->Arg(cv::COLOR_BGR2RGB);
+BENCHMARK(BM_CvCvtColor)->Name("CvBgrToGray")->Arg(cv::COLOR_BGR2GRAY);
+BENCHMARK(BM_CvCvtColor)->Name("CvYuyvToBgr")->Arg(cv::COLOR_YUV2BGR_YUYV);
+
+static void BM_CvSplit(benchmark::State& state)
+{
+    auto input = cv::Mat(height_, width_, CV_8UC3, cv::Scalar::all(0x5a));
+    auto planes = std::vector<cv::Mat>{};
+
+    for (auto _ : state)
+    {
+        cv::split(input, planes);
+        benchmark::DoNotOptimize(planes.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * input.total() * input.elemSize());
+}
+
+BENCHMARK(BM_CvSplit)->Name("CvBgrToPlanar");
+
+// what BgrToRgbPlanarF32 replaces: color swap, float conversion, normalization and split as separate passes
+static void BM_CvBgrToRgbPlanarF32(benchmark::State& state)
+{
+    auto input = cv::Mat(height_, width_, CV_8UC3, cv::Scalar::all(0x5a));
+    auto mean = cv::Scalar(mean_[0], mean_[1], mean_[2]);
+    auto scale = cv::Scalar(scale_[0], scale_[1], scale_[2]);
+    auto rgb = cv::Mat();
+    auto normalized = cv::Mat();
+    auto planes = std::vector<cv::Mat>{};
+
+    for (auto _ : state)
+    {
+        cv::cvtColor(input, rgb, cv::COLOR_BGR2RGB);
+        rgb.convertTo(normalized, CV_32FC3);
+        cv::subtract(normalized, mean, normalized);
+        cv::multiply(normalized, scale, normalized);
+        cv::split(normalized, planes);
+        benchmark::DoNotOptimize(planes.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * input.total() * input.elemSize());
+}
+
+BENCHMARK(BM_CvBgrToRgbPlanarF32)->Name("CvBgrToRgbPlanarF32");
@@ -0,0 +1,152 @@
+#include <mutex>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include "common/FrameRing.hpp"
+
+
+// index bookkeeping of the former MultiThreadCaptureController (every call takes one mutex)
+class MutexSlotExchange
+{
+    private:
+        static constexpr int numSlots_ = 4;
+        static constexpr int notApplicatable_ = -1;
+
+        std::mutex mtx_;
+        bool isQuit_ = false;
+        int idx_latest_ = notApplicatable_;
+        int idx_previous_ = notApplicatable_;
+        int idx_update_ = notApplicatable_;
+        int idx_locked_ = notApplicatable_;
+
+    public:
+        bool IsEnd(void)
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            return isQuit_;
+        }
+
+        bool IsFirstCaptured(void)
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            return idx_latest_ != notApplicatable_;
+        }
+
+        int GetUpdateIndex(void)
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            int ret = 0;
+            for (int idx = 0; idx < numSlots_; ++idx)
+            {
+                if ((idx != idx_latest_) || (idx != idx_update_) || (idx != idx_locked_))
+                {
+                    ret = idx;
+                    break;
+                }
+            }
+            idx_previous_ = idx_latest_;
+            idx_latest_ = idx_update_;
+            idx_update_ = ret;
+            return ret;
+        }
+
+        int GetLatestIndex(void)
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            int ret = notApplicatable_;
+            for (int idx = 0; idx < numSlots_; ++idx)
+            {
+                if ((idx != idx_previous_) || (idx != idx_update_) || (idx != idx_locked_))
+                {
+                    ret = idx;
+                    break;
+                }
+            }
+            idx_previous_ = idx_locked_;
+            idx_locked_ = ret;
+            idx_latest_ = notApplicatable_;
+            return ret;
+        }
+};
+
+// atomic counterpart on the ring, whose reader pins the latest slot wait-free, with the flags the controller keeps next to it
+class AtomicSlotExchange
+{
+    private:
+        std::atomic<bool> isQuit_{false};
+        FrameRing ring_{4, 4};
+        int idx_locked_ = FrameRing::NotApplicatable;
+
+    public:
+        AtomicSlotExchange()
+        {
+            for (int idx = 0; idx < ring_.GetDepth(); ++idx)
+            {
+                ring_.Append(nullptr);
+            }
+        }
+
+        bool IsEnd(void)
+        {
+            return isQuit_.load(std::memory_order_acquire);
+        }
+
+        bool IsFirstCaptured(void)
+        {
+            return ring_.GetPublishedSequence() != 0;
+        }
+
+        int GetUpdateIndex(void)
+        {
+            auto idx = ring_.AcquireForWrite();
+            ring_.Publish(0);
+            return idx;
+        }
+
+        int GetLatestIndex(void)
+        {
+            uint64_t sequence;
+            auto idx = ring_.PinLatest(&sequence);
+            if (idx_locked_ != FrameRing::NotApplicatable)
+            {
+                ring_.Unpin(idx_locked_);
+            }
+            idx_locked_ = idx;
+            return idx;
+        }
+};
+
+// thread 0 acts as the capture thread and the others as readers, and each iteration is one frame
+template <typename Exchange>
+static void BM_Exchange(benchmark::State& state)
+{
+    static Exchange* exchange = nullptr;
+    if (state.thread_index() == 0)
+    {
+        exchange = new Exchange();
+    }
+
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            benchmark::DoNotOptimize(exchange->IsEnd());
+            benchmark::DoNotOptimize(exchange->GetUpdateIndex());
+            benchmark::DoNotOptimize(exchange->IsFirstCaptured());
+        }
+        else
+        {
+            benchmark::DoNotOptimize(exchange->IsEnd());
+            benchmark::DoNotOptimize(exchange->IsFirstCaptured());
+            benchmark::DoNotOptimize(exchange->GetLatestIndex());
+        }
+    }
+
+    if (state.thread_index() == 0)
+    {
+        delete exchange;
+        exchange = nullptr;
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_Exchange, MutexSlotExchange)->Threads(1)->Threads(2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Exchange, AtomicSlotExchange)->Threads(1)->Threads(2)->UseRealTime();
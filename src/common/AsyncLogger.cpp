@@ -0,0 +1,286 @@
+#include  "AsyncLogger.hpp"
+#include  <chrono>
+#include  <string>
+#include  <algorithm>
+#include  <unistd.h>
+#include  <sys/syscall.h>
+
+static const char* const levelNames_[] = { "T", "D", "I", "W", "E", "-" };
+
+
+/* ----- Public ----- */
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        isQuit_ = true;
+    }
+    cvar_.notify_one();
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+AsyncLogger& AsyncLogger::GetInstance(void)
+{
+    static AsyncLogger instance(DefaultCapacity);
+    return instance;
+}
+
+void AsyncLogger::SetLevel(LogLevel level)
+{
+    level_.store(level, std::memory_order_relaxed);
+}
+
+void AsyncLogger::SetOutput(FILE* output)
+{
+    // records already written go to the former output
+    Flush();
+    output_.store(output, std::memory_order_release);
+}
+
+void AsyncLogger::Flush(void)
+{
+    auto target = tail_.load(std::memory_order_acquire);
+
+    auto lk = std::unique_lock<std::mutex>(mtx_);
+    isFlushRequested_ = true;
+    cvar_.notify_one();
+
+    // records claimed but not committed yet hold the head back until they are
+    cvarFlushed_.wait(lk, [this, target]{ return (head_.load(std::memory_order_acquire) >= target) || isQuit_; });
+}
+
+int AsyncLogger::Format(const LogRecord& record, char* buf, size_t size)
+{
+    size_t n = 0;
+    auto append = [&n, buf, size](int written){
+        if (written > 0)
+        {
+            n = std::min(n + static_cast<size_t>(written), size - 1);
+        }
+    };
+
+    append(std::snprintf(buf, size, "[%lu.%06lu][%s][%u][%s] ",
+            static_cast<unsigned long>(record.Time / 1000000000), static_cast<unsigned long>(record.Time / 1000 % 1000000),
+            levelNames_[static_cast<int>(record.Level)], record.ThreadId, record.Tag));
+
+    // printf-like formatting, one conversion at a time with the argument taken back from its bits
+    int arg = 0;
+    for (auto p = record.Format; (*p != '\0') && (n < size - 1); )
+    {
+        if ((*p != '%') || (p[1] == '%'))
+        {
+            buf[n++] = *p;
+            p += (*p == '%') ? 2 : 1;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        auto head = p++;
+        char spec[32];
+        size_t len = 0;
+        spec[len++] = '%';
+        while ((*p != '\0') && std::strchr("-+ #0123456789.", *p) && (len < sizeof(spec) - 4))
+        {
+            spec[len++] = *p++;
+        }
+        while ((*p != '\0') && std::strchr("hlLqjzt", *p))
+        {
+            ++p;
+        }
+        auto conversion = *p;
+        if ((conversion == '\0') || (arg == record.NumArgs))
+        {
+            // malformed, or more conversions than arguments: print it as it is
+            append(std::snprintf(buf + n, size - n, "%.*s", static_cast<int>(p - head), head));
+            if (conversion == '\0')
+            {
+                break;
+            }
+            ++p;
+            continue;
+        }
+        ++p;
+
+        auto bits = record.Args[arg++];
+        switch (conversion)
+        {
+            case 'd': case 'i':
+                spec[len++] = 'l'; spec[len++] = 'l'; spec[len++] = conversion; spec[len] = '\0';
+                append(std::snprintf(buf + n, size - n, spec, static_cast<long long>(bits)));
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                spec[len++] = 'l'; spec[len++] = 'l'; spec[len++] = conversion; spec[len] = '\0';
+                append(std::snprintf(buf + n, size - n, spec, static_cast<unsigned long long>(bits)));
+                break;
+            case 'c':
+                spec[len++] = conversion; spec[len] = '\0';
+                append(std::snprintf(buf + n, size - n, spec, static_cast<int>(bits)));
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            {
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                spec[len++] = conversion; spec[len] = '\0';
+                append(std::snprintf(buf + n, size - n, spec, value));
+                break;
+            }
+            case 's':
+            {
+                auto str = reinterpret_cast<const char*>(static_cast<uintptr_t>(bits));
+                spec[len++] = conversion; spec[len] = '\0';
+                append(std::snprintf(buf + n, size - n, spec, (str != nullptr) ? str : "(null)"));
+                break;
+            }
+            default:
+                spec[len++] = 'p'; spec[len] = '\0';
+                append(std::snprintf(buf + n, size - n, spec, reinterpret_cast<void*>(static_cast<uintptr_t>(bits))));
+                break;
+        }
+    }
+
+    auto file = std::strrchr(record.File, '/');
+    append(std::snprintf(buf + n, size - n, " (Line:%u @%s)", record.Line, (file != nullptr) ? file + 1 : record.File));
+    buf[n] = '\0';
+
+    return static_cast<int>(n);
+}
+
+
+/* ----- Private ----- */
+
+AsyncLogger::AsyncLogger(int capacity)
+    : capacity_(static_cast<uint64_t>(capacity)), cells_(new Cell[capacity]),
+      tail_(0), head_(0), dropped_(0),
+      level_(LogLevel::Trace), output_(stdout), startTime_(GetTimeAsNs()),
+      isQuit_(false), isFlushRequested_(false)
+{
+    for (uint64_t pos = 0; pos < capacity_; ++pos)
+    {
+        cells_[pos].Sequence.store(pos, std::memory_order_relaxed);
+    }
+
+    thread_ = std::thread(&AsyncLogger::Main, this);
+}
+
+void AsyncLogger::Main(void)
+{
+    // writers never wake this thread, it polls so that logging costs them no system call
+    constexpr auto interval = std::chrono::milliseconds(1);
+
+    while (true)
+    {
+        auto isDrained = Drain();
+
+        auto lk = std::unique_lock<std::mutex>(mtx_);
+        if (isFlushRequested_)
+        {
+            // the flushing thread checks its own target; keep going while writers add records
+            cvarFlushed_.notify_all();
+            isFlushRequested_ = !isDrained;
+        }
+        if (isQuit_)
+        {
+            break;
+        }
+        cvar_.wait_for(lk, interval, [this]{ return isQuit_ || isFlushRequested_; });
+    }
+
+    Drain();
+    cvarFlushed_.notify_all();
+}
+
+bool AsyncLogger::Drain(void)
+{
+    auto output = output_.load(std::memory_order_acquire);
+    auto head = head_.load(std::memory_order_relaxed);
+    auto isPrinted = false;
+
+    while (true)
+    {
+        auto& cell = cells_[head & (capacity_ - 1)];
+        if (cell.Sequence.load(std::memory_order_acquire) != head + 1)
+        {
+            break;
+        }
+
+        Print(cell.Record, output);
+        isPrinted = true;
+
+        cell.Sequence.store(head + capacity_, std::memory_order_release);
+        head_.store(++head, std::memory_order_release);
+    }
+
+    if (isPrinted)
+    {
+        std::fflush(output);
+    }
+
+    // every claimed record is printed (a writer between Claim and Commit keeps this false)
+    return head == tail_.load(std::memory_order_acquire);
+}
+
+void AsyncLogger::Print(const LogRecord& record, FILE* output)
+{
+    char buf[1024];
+    auto relative = record;
+    relative.Time = (record.Time > startTime_) ? record.Time - startTime_ : 0;
+    Format(relative, buf, sizeof(buf));
+    std::fputs(buf, output);
+    std::fputc('\n', output);
+}
+
+uint32_t AsyncLogger::GetThreadId(void)
+{
+    thread_local auto id = static_cast<uint32_t>(syscall(SYS_gettid));
+    return id;
+}
+
+uint64_t AsyncLogger::GetTimeAsNs(void)
+{
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+}
+
+LogRecord* AsyncLogger::Claim(uint64_t* position)
+{
+    auto pos = tail_.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        auto& cell = cells_[pos & (capacity_ - 1)];
+        auto sequence = cell.Sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+
+        if (diff == 0)
+        {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                *position = pos;
+                return &cell.Record;
+            }
+        }
+        else if (diff < 0)
+        {
+            // the logger's thread has not caught up: drop rather than wait
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        else
+        {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLogger::Commit(uint64_t position)
+{
+    cells_[position & (capacity_ - 1)].Sequence.store(position + 1, std::memory_order_release);
+}
@@ -0,0 +1,192 @@
+#ifndef  H__ASYNC_LOGGER__H
+#define  H__ASYNC_LOGGER__H
+
+#include  <thread>
+#include  <atomic>
+#include  <mutex>
+#include  <condition_variable>
+#include  <memory>
+#include  <type_traits>
+#include  <cstdio>
+#include  <cstdint>
+#include  <cstring>
+
+// lowest level compiled in (0: trace, 1: debug, 2: info, 3: warn, 4: error, 5: none); e.g. -DCAPTURE_LOG_LEVEL=2
+#ifndef  CAPTURE_LOG_LEVEL
+#define  CAPTURE_LOG_LEVEL  0
+#endif
+
+enum class LogLevel : int
+{
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off,
+};
+
+// One message as written by the hot path: the format is formatted later, on the logger's thread
+struct LogRecord
+{
+    static constexpr int MaxNumArgs = 6;
+
+    uint64_t Time;  // [ns] steady clock
+    const char* Tag;
+    const char* File;
+    const char* Format;
+    uint32_t Line;
+    uint32_t ThreadId;
+    LogLevel Level;
+    int NumArgs;
+    uint64_t Args[MaxNumArgs];  // integers, doubles and pointers, stored bit for bit
+};
+
+// Process-wide logger writing binary records to a lock-free ring, formatted and printed by a background thread.
+//
+// Writing a record takes no lock, allocates nothing and never blocks: when the ring is full the record is dropped
+// and counted. Formats are printf-like and must be string literals, like the tags and the file names;
+// a "%s" argument is stored as a pointer, so it must point to static storage as well.
+class AsyncLogger
+{
+    public:
+        static constexpr int DefaultCapacity = 4096;  // records, a power of two
+
+    private:
+        struct Cell
+        {
+            std::atomic<uint64_t> Sequence;  // Vyukov's bounded queue: tells whether the cell is free or written
+            LogRecord Record;
+        };
+
+        const uint64_t capacity_;
+        std::unique_ptr<Cell[]> cells_;
+
+        alignas(64) std::atomic<uint64_t> tail_;  // next position to write, shared by the writers
+        alignas(64) std::atomic<uint64_t> head_;  // next position to format, owned by the logger's thread
+        std::atomic<uint64_t> dropped_;
+
+        std::atomic<LogLevel> level_;
+        std::atomic<FILE*> output_;
+        uint64_t startTime_;
+
+        std::thread thread_;
+        std::mutex mtx_;
+        std::condition_variable cvar_;  // wakes the logger's thread early for Flush and shutdown
+        bool isQuit_;
+        bool isFlushRequested_;
+        std::condition_variable cvarFlushed_;
+
+        AsyncLogger(int capacity);
+
+        void Main(void);
+
+        bool Drain(void);
+
+        void Print(const LogRecord& record, FILE* output);
+
+        static uint32_t GetThreadId(void);
+
+        static uint64_t GetTimeAsNs(void);
+
+        template <typename T>
+        static uint64_t Encode(T value)
+        {
+            uint64_t bits = 0;
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                auto d = static_cast<double>(value);
+                std::memcpy(&bits, &d, sizeof(d));
+            }
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                bits = static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(value));
+            }
+            else
+            {
+                static_assert(std::is_integral_v<T>, "log arguments are integers, floating point numbers or pointers");
+                bits = static_cast<uint64_t>(value);
+            }
+            return bits;
+        }
+
+        LogRecord* Claim(uint64_t* position);
+
+        void Commit(uint64_t position);
+
+    public:
+        ~AsyncLogger();
+
+        AsyncLogger(const AsyncLogger&) = delete;
+
+        AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+        static AsyncLogger& GetInstance(void);
+
+        bool IsEnabled(LogLevel level) const
+        {
+            return level >= level_.load(std::memory_order_relaxed);
+        }
+
+        template <typename... Ts>
+        void Write(LogLevel level, const char* tag, const char* file, int line, const char* format, Ts... args)
+        {
+            static_assert(sizeof...(Ts) <= LogRecord::MaxNumArgs, "too many log arguments");
+
+            if (!IsEnabled(level))
+            {
+                return;
+            }
+
+            uint64_t position;
+            auto record = Claim(&position);
+            if (record == nullptr)
+            {
+                return;
+            }
+
+            record->Time = GetTimeAsNs();
+            record->Tag = tag;
+            record->File = file;
+            record->Format = format;
+            record->Line = static_cast<uint32_t>(line);
+            record->ThreadId = GetThreadId();
+            record->Level = level;
+            record->NumArgs = static_cast<int>(sizeof...(Ts));
+            auto arg = record->Args;
+            ((*arg++ = Encode(args)), ...);
+
+            Commit(position);
+        }
+
+        // runtime filter on top of CAPTURE_LOG_LEVEL (default: Trace, everything compiled in)
+        void SetLevel(LogLevel level);
+
+        // stdout by default; the stream must stay open until the next SetOutput or the end of the process
+        void SetOutput(FILE* output);
+
+        // waits until every record written before the call is printed
+        void Flush(void);
+
+        uint64_t GetNumDropped(void) const { return dropped_.load(std::memory_order_relaxed); }
+
+        // formats one record as the logger's thread prints it
+        static int Format(const LogRecord& record, char* buf, size_t size);
+};
+
+// the format is checked against the arguments at compile time, and levels below CAPTURE_LOG_LEVEL compile to nothing
+#define  CAPTURE_LOG(level, tag, fmt, ...)                                                                  \
+    do                                                                                                      \
+    {                                                                                                       \
+        if constexpr (static_cast<int>(level) >= CAPTURE_LOG_LEVEL)                                         \
+        {                                                                                                   \
+            (void)sizeof(std::printf(fmt, ##__VA_ARGS__));                                                  \
+            AsyncLogger::GetInstance().Write(level, tag, __FILE__, __LINE__, fmt, ##__VA_ARGS__);           \
+        }                                                                                                   \
+    } while (0)
+
+#endif  // H__ASYNC_LOGGER__H
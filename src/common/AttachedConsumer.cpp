@@ -0,0 +1,76 @@
+#include  "AttachedConsumer.hpp"
+#include  "MultiThreadCaptureController.hpp"
+
+
+/* ----- Public ----- */
+
+AttachedConsumer::AttachedConsumer()
+    : controller_(nullptr), isAttached_(false)
+{
+}
+
+AttachedConsumer::~AttachedConsumer()
+{
+    Stop();
+}
+
+bool AttachedConsumer::Start(MultiThreadCaptureController* controller, Handler handler)
+{
+    if ((controller == nullptr) || thread_.joinable())
+    {
+        return false;
+    }
+
+    controller_ = controller;
+    consumer_ = controller->RegisterConsumer();
+    handler_ = std::move(handler);
+    isAttached_.store(true, std::memory_order_release);
+    thread_ = std::thread(&AttachedConsumer::Main, this);
+
+    return true;
+}
+
+uint64_t AttachedConsumer::Stop(void)
+{
+    isAttached_.store(false, std::memory_order_release);
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    auto missed = uint64_t{0};
+    if (consumer_ != nullptr)
+    {
+        missed = consumer_->GetStats().Dropped;
+        consumer_.reset();
+    }
+    handler_ = nullptr;
+
+    return missed;
+}
+
+
+/* ----- Private ----- */
+
+void AttachedConsumer::Main(void)
+{
+    // wake up now and then to notice Stop
+    constexpr uint64_t timeout = 100 * 1000 * 1000;
+
+    while (isAttached_.load(std::memory_order_acquire))
+    {
+        auto lease = consumer_->ReadNext(timeout);
+        if (!lease.IsValid())
+        {
+            if (controller_->GetState() == MultiThreadCaptureController::CaptureState::Quit)
+            {
+                // the capture has finished, nothing more will be published
+                break;
+            }
+            continue;
+        }
+
+        handler_(lease);
+    }
+}
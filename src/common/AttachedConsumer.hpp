@@ -0,0 +1,49 @@
+#ifndef  H__ATTACHED_CONSUMER__H
+#define  H__ATTACHED_CONSUMER__H
+
+#include  <thread>
+#include  <atomic>
+#include  <memory>
+#include  <functional>
+#include  <cstdint>
+#include  "FrameLease.hpp"
+
+class MultiThreadCaptureController;
+class FrameConsumer;
+
+// Thread handing every frame a controller publishes to a function, in order, through a FrameConsumer of its own.
+//
+// Sinks attached to a controller (RawRecorder, EncodingSink, SharedFramePublisher) run their Start and Stop on it,
+// so that a slow sink never holds back the controller or the other readers. The thread ends on Stop, or by itself
+// once the capture has finished.
+class AttachedConsumer
+{
+    public:
+        using Handler = std::function<void(const FrameLease&)>;
+
+    private:
+        MultiThreadCaptureController* controller_;
+        std::unique_ptr<FrameConsumer> consumer_;
+        Handler handler_;
+        std::thread thread_;
+        std::atomic<bool> isAttached_;
+
+        void Main(void);
+
+    public:
+        AttachedConsumer();
+
+        ~AttachedConsumer();
+
+        AttachedConsumer(const AttachedConsumer&) = delete;
+
+        AttachedConsumer& operator=(const AttachedConsumer&) = delete;
+
+        // handles the frames published from now on until Stop; false if already started
+        bool Start(MultiThreadCaptureController* controller, Handler handler);
+
+        // joins the thread and returns the frames the consumer missed since Start (0 if not started)
+        uint64_t Stop(void);
+};
+
+#endif  // H__ATTACHED_CONSUMER__H
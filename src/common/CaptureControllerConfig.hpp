@@ -0,0 +1,76 @@
+#ifndef  H__CAPTURE_CONTROLLER_CONFIG__H
+#define  H__CAPTURE_CONTROLLER_CONFIG__H
+
+#include  <vector>
+#include  <memory>
+#include  <sched.h>
+#include  "IFrameStage.hpp"
+
+class CaptureExecutor;
+
+// How the controller keeps frames no reader has taken yet
+enum class BufferingPolicy : int
+{
+    LatestOnly,  // the newest frame wins: frames not read in time are written over
+    Lossless,  // the frames also make a bounded queue for one reader calling Dequeue, which gets every frame in order
+};
+
+// What the producer does in Lossless mode with a frame when the queue is full
+enum class QueueOverflowPolicy : int
+{
+    Block,  // wait for Dequeue to make room, so the source backs up
+    Drop,  // capture on and drop the new frames, counting them in QueueOverflows
+};
+
+// Options given to MultiThreadCaptureController at construction
+struct CaptureControllerConfig
+{
+    int NumCaptureData = 4;  // depth of the frame history ring (at least 3)
+
+    int MaxNumCaptureData = 0;  // buffers the ring may grow to while readers hold leases (0: no growth)
+
+    BufferingPolicy Buffering = BufferingPolicy::LatestOnly;
+
+    int QueueDepth = 8;  // frames published and not dequeued yet in Lossless mode; the ring gets two slots more at least
+
+    QueueOverflowPolicy QueueOverflow = QueueOverflowPolicy::Block;
+
+    bool UseHugePages = false;  // back the frame buffers with 2 MB pages (falls back to transparent huge pages)
+
+    bool LockMemory = false;  // mlock the frame buffers (needs RLIMIT_MEMLOCK or CAP_IPC_LOCK)
+
+    std::vector<std::shared_ptr<IFrameStage>> Stages;  // processing applied to every frame before it is published (empty: none)
+
+    int NumStageWorkers = 2;  // threads running Stages; one more frame than workers is in flight
+
+    std::vector<int> CpuAffinity;  // CPUs the capture thread may run on (empty: any)
+
+    int SchedPolicy = SCHED_OTHER;  // SCHED_FIFO or SCHED_RR give the capture thread real-time priority (needs CAP_SYS_NICE or RLIMIT_RTPRIO)
+
+    int SchedPriority = 0;  // 1 to 99 with SCHED_FIFO and SCHED_RR
+
+    int NumaNode = -1;  // node the frame buffers are bound to and first touched on (-1: left to the kernel)
+
+    // with a source that IsGrabbable, the capture thread only grabs and time-stamps, and decodes a frame only when
+    // a reader is waiting for one; Read and Lease wait for the newest grab to be decoded (ignored with Stages)
+    bool LazyRetrieve = false;
+
+    int PackedWindowCapacity = 0;  // frames the producer also copies back to back for ReadWindow(n, true), at least n (0: none)
+
+    // frames differing from the last one published by less than this mean absolute difference per byte (0 to 255)
+    // are not published (0: every frame is); see MotionGate
+    double MotionThreshold = 0.0;
+
+    int MotionGridStep = 4;  // the difference is taken on every n-th row and every n-th run of 64 bytes
+
+    uint64_t MotionKeepAlive = 1000000000;  // [ns] publish a frame anyway after this long without one (0: never)
+
+    // run the capture as a stream of this shared pool of workers instead of a thread of its own; it must outlive
+    // the controller. CpuAffinity and the scheduling options are the executor's then, and sources not overriding
+    // ICapturable::GetTimeToReady (or Stages waiting for a lane) hold a worker while they wait (nullptr: own thread)
+    CaptureExecutor* Executor = nullptr;
+
+    bool CollectStats = true;  // keep the counters and histograms returned by GetStats (a few clock reads per frame)
+};
+
+#endif  // H__CAPTURE_CONTROLLER_CONFIG__H
@@ -4,6 +4,7 @@
 #include  <memory>
 #include  <cstdint>
 #include  "Ensuring.hpp"
+#include  "FrameFormat.hpp"
 
 class CaptureDataObject
 {
@@ -14,8 +15,20 @@ class CaptureDataObject
 
         const uint64_t Length;
 
+        const FrameFormat Format;
+
         CaptureDataObject(const void* const data, std::uint64_t sizeOfData, std::uint64_t length)
-            : Data(data), SizeOfData(sizeOfData), Length(length)
+            : Data(data), SizeOfData(sizeOfData), Length(length),
+              Format{ static_cast<uint32_t>(length), 1, 1, static_cast<uint32_t>(sizeOfData), length * sizeOfData }
+        {
+            ThrowExceptionIfNull(this->Data);
+            ThrowExceptionIfZero(this->SizeOfData);
+            ThrowExceptionIfZero(this->Length);
+        }
+
+        CaptureDataObject(const void* const data, const FrameFormat& format)
+            : Data(data), SizeOfData(format.NumBytesPerChannel), Length(format.GetSizeOfFrame() / format.NumBytesPerChannel),
+              Format(format)
         {
             ThrowExceptionIfNull(this->Data);
             ThrowExceptionIfZero(this->SizeOfData);
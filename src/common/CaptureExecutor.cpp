@@ -0,0 +1,367 @@
+#include  "CaptureExecutor.hpp"
+#include  <chrono>
+#include  <algorithm>
+#include  <pthread.h>
+#include  <sched.h>
+#include  "Ensuring.hpp"
+
+
+struct CaptureExecutor::Stream
+{
+    enum class State : int
+    {
+        Parked,
+        Queued,
+        Running,
+        Deferred,
+        Finished
+    };
+
+    Step Function;
+    std::atomic<State> Current;
+    std::atomic<bool> IsWakeRequested;  // set by Wake while the stream is not parked
+    std::atomic<int> Home;  // worker that queued it last
+    uint64_t ReadyTime;  // [ns] written under the queue's mutex by Push, read by the worker popping it
+};
+
+
+/* ----- Public ----- */
+
+CaptureExecutor::CaptureExecutor(int numWorkers, const std::vector<int>& cpuAffinity)
+    : cpuAffinity_(cpuAffinity), nextDue_(UINT64_MAX), numQueued_(0), numSleeping_(0), isTimerWatched_(false),
+      nextHome_(0), isQuit_(false), steps_(0), steals_(0), deferred_(0)
+{
+    ThrowExceptionIfOutOfRange(numWorkers, 1, 256);
+
+    // every worker exists before any of them looks for work to steal
+    for (int idx = 0; idx < numWorkers; ++idx)
+    {
+        workers_.emplace_back(new Worker());
+    }
+    for (int idx = 0; idx < numWorkers; ++idx)
+    {
+        workers_[idx]->Thread = std::thread(&CaptureExecutor::Main, this, idx);
+    }
+}
+
+CaptureExecutor::~CaptureExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        isQuit_ = true;
+    }
+    cvarToWakeWorker_.notify_all();
+    cvarToWakeTimerWatcher_.notify_all();
+
+    for (auto& worker : workers_)
+    {
+        worker->Thread.join();
+    }
+}
+
+std::shared_ptr<CaptureExecutor::Stream> CaptureExecutor::Add(Step step)
+{
+    auto stream = std::make_shared<Stream>();
+    stream->Function = std::move(step);
+    stream->Current.store(Stream::State::Parked, std::memory_order_relaxed);
+    stream->IsWakeRequested.store(false, std::memory_order_relaxed);
+    stream->Home.store(static_cast<int>(nextHome_.fetch_add(1, std::memory_order_relaxed) % workers_.size()), std::memory_order_relaxed);
+    stream->ReadyTime = 0;
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    streams_.push_back(stream);
+
+    return stream;
+}
+
+void CaptureExecutor::Wake(const std::shared_ptr<Stream>& stream)
+{
+    // a worker parking the stream right now sees the request and queues it again itself
+    stream->IsWakeRequested.store(true, std::memory_order_seq_cst);
+
+    auto expected = Stream::State::Parked;
+    if (stream->Current.compare_exchange_strong(expected, Stream::State::Queued, std::memory_order_seq_cst))
+    {
+        stream->IsWakeRequested.store(false, std::memory_order_relaxed);
+        Push(stream, stream->Home.load(std::memory_order_relaxed), GetTimeAsNs(), false);
+    }
+}
+
+void CaptureExecutor::Remove(const std::shared_ptr<Stream>& stream)
+{
+    auto lk = std::unique_lock<std::mutex>(mtx_);
+    cvarToWaitFinished_.wait(lk, [&stream]{ return stream->Current.load(std::memory_order_acquire) == Stream::State::Finished; });
+
+    streams_.erase(std::remove(streams_.begin(), streams_.end(), stream), streams_.end());
+}
+
+CaptureExecutorStats CaptureExecutor::GetStats(void)
+{
+    auto stats = CaptureExecutorStats{};
+    stats.NumWorkers = GetNumWorkers();
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stats.NumStreams = static_cast<int>(streams_.size());
+    }
+    stats.Steps = steps_.load(std::memory_order_relaxed);
+    stats.Steals = steals_.load(std::memory_order_relaxed);
+    stats.Deferred = deferred_.load(std::memory_order_relaxed);
+    stats.ScheduleDelay = scheduleDelay_.Snapshot();
+
+    return stats;
+}
+
+
+/* ----- Private ----- */
+
+void CaptureExecutor::Main(int id)
+{
+    if (!cpuAffinity_.empty())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto cpu : cpuAffinity_)
+        {
+            CPU_SET(cpu, &cpus);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    while (true)
+    {
+        // busy workers take due timers too, so that deferred streams are not starved by streams always ready
+        if (nextDue_.load(std::memory_order_acquire) <= GetTimeAsNs())
+        {
+            MoveDueTimers(id);
+        }
+
+        auto stream = Pop(id);
+        if (stream != nullptr)
+        {
+            Run(stream, id);
+            continue;
+        }
+
+        auto lk = std::unique_lock<std::mutex>(mtx_);
+        if (isQuit_)
+        {
+            return;
+        }
+
+        // one idle worker sleeps until the earliest timer, the others until a stream is queued, so that a timer
+        // wakes one worker instead of all of them; pairs with Push: either it sees this worker sleeping
+        // or this worker sees the stream queued
+        auto isWatcher = !isTimerWatched_.load(std::memory_order_relaxed);
+        if (isWatcher)
+        {
+            isTimerWatched_.store(true, std::memory_order_seq_cst);
+        }
+        else
+        {
+            numSleeping_.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        auto due = nextDue_.load(std::memory_order_relaxed);
+        auto now = GetTimeAsNs();
+        if ((numQueued_.load(std::memory_order_seq_cst) == 0) && (due > now))
+        {
+            if (!isWatcher)
+            {
+                cvarToWakeWorker_.wait(lk);
+            }
+            else if (due == UINT64_MAX)
+            {
+                cvarToWakeTimerWatcher_.wait(lk);
+            }
+            else
+            {
+                cvarToWakeTimerWatcher_.wait_for(lk, std::chrono::nanoseconds(due - now));
+            }
+        }
+
+        // a watcher now busy takes the timers due after its step, as busy workers do, and the next one idle watches
+        if (isWatcher)
+        {
+            isTimerWatched_.store(false, std::memory_order_relaxed);
+        }
+        else
+        {
+            numSleeping_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::shared_ptr<CaptureExecutor::Stream> CaptureExecutor::Pop(int id)
+{
+    if (numQueued_.load(std::memory_order_acquire) == 0)
+    {
+        return nullptr;
+    }
+
+    auto take = [this](Worker& worker) -> std::shared_ptr<Stream> {
+        std::lock_guard<std::mutex> lk(worker.Mtx);
+        if (worker.Queue.empty())
+        {
+            return nullptr;
+        }
+        auto stream = std::move(worker.Queue.front());
+        worker.Queue.pop_front();
+        numQueued_.fetch_sub(1, std::memory_order_relaxed);
+        return stream;
+    };
+
+    // the own queue first
+    auto stream = take(*workers_[id]);
+    if (stream != nullptr)
+    {
+        return stream;
+    }
+
+    // then the oldest stream of the others, as it has waited longest: the fronts are compared by the time they
+    // were queued, so no queue is favoured by its place among the workers
+    auto numWorkers = static_cast<int>(workers_.size());
+    auto victim = -1;
+    auto oldest = UINT64_MAX;
+    for (int n = 1; n < numWorkers; ++n)
+    {
+        auto other = (id + n) % numWorkers;
+        std::lock_guard<std::mutex> lk(workers_[other]->Mtx);
+        if (!workers_[other]->Queue.empty() && (workers_[other]->Queue.front()->ReadyTime < oldest))
+        {
+            oldest = workers_[other]->Queue.front()->ReadyTime;
+            victim = other;
+        }
+    }
+
+    // the victim's front may have been taken meanwhile; what is left at its front is then the oldest of that queue
+    stream = (victim >= 0) ? take(*workers_[victim]) : nullptr;
+    if (stream != nullptr)
+    {
+        steals_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return stream;
+}
+
+void CaptureExecutor::Run(const std::shared_ptr<Stream>& stream, int id)
+{
+    auto begin = GetTimeAsNs();
+    scheduleDelay_.Record((begin > stream->ReadyTime) ? begin - stream->ReadyTime : 0);
+    stream->Current.store(Stream::State::Running, std::memory_order_relaxed);
+    steps_.fetch_add(1, std::memory_order_relaxed);
+
+    auto ret = stream->Function();
+
+    if (ret == 0)
+    {
+        // to the back of the queue, so the streams of this worker take turns
+        stream->Current.store(Stream::State::Queued, std::memory_order_relaxed);
+        Push(stream, id, GetTimeAsNs(), true);
+    }
+    else if (ret == Finished)
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            stream->Current.store(Stream::State::Finished, std::memory_order_release);
+        }
+        cvarToWaitFinished_.notify_all();
+    }
+    else if (ret == Park)
+    {
+        stream->Current.store(Stream::State::Parked, std::memory_order_seq_cst);
+        auto expected = Stream::State::Parked;
+        if (stream->IsWakeRequested.exchange(false, std::memory_order_seq_cst)
+                && stream->Current.compare_exchange_strong(expected, Stream::State::Queued, std::memory_order_seq_cst))
+        {
+            Push(stream, id, GetTimeAsNs(), true);
+        }
+    }
+    else
+    {
+        deferred_.fetch_add(1, std::memory_order_relaxed);
+        stream->Current.store(Stream::State::Deferred, std::memory_order_relaxed);
+
+        auto due = GetTimeAsNs() + ret;
+        auto isEarliest = false;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            timers_.push(Timer{ due, stream });
+            isEarliest = due < nextDue_.load(std::memory_order_relaxed);
+            if (isEarliest)
+            {
+                nextDue_.store(due, std::memory_order_release);
+            }
+        }
+        if (isEarliest)
+        {
+            // the watcher sleeps until the timer it saw, which is later
+            cvarToWakeTimerWatcher_.notify_one();
+        }
+    }
+}
+
+void CaptureExecutor::Push(const std::shared_ptr<Stream>& stream, int id, uint64_t readyTime, bool isFromWorker)
+{
+    auto& worker = *workers_[id];
+    auto isBacklogged = false;
+    {
+        std::lock_guard<std::mutex> lk(worker.Mtx);
+        stream->ReadyTime = readyTime;
+        stream->Home.store(id, std::memory_order_relaxed);
+        worker.Queue.push_back(stream);
+        numQueued_.fetch_add(1, std::memory_order_seq_cst);
+        isBacklogged = worker.Queue.size() > 1;
+    }
+
+    // a worker queueing its only stream runs it next itself; anything more is worth a sleeping worker stealing
+    if (isFromWorker && !isBacklogged)
+    {
+        return;
+    }
+
+    if (numSleeping_.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+        }
+        cvarToWakeWorker_.notify_one();
+    }
+    else if (isTimerWatched_.load(std::memory_order_seq_cst))
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+        }
+        cvarToWakeTimerWatcher_.notify_one();
+    }
+}
+
+void CaptureExecutor::MoveDueTimers(int id)
+{
+    auto& expired = workers_[id]->Expired;
+    auto now = GetTimeAsNs();
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        while (!timers_.empty() && (timers_.top().Due <= now))
+        {
+            expired.push_back(timers_.top());
+            timers_.pop();
+        }
+        nextDue_.store(timers_.empty() ? UINT64_MAX : timers_.top().Due, std::memory_order_release);
+    }
+
+    for (auto& timer : expired)
+    {
+        timer.Target->Current.store(Stream::State::Queued, std::memory_order_relaxed);
+        Push(timer.Target, id, timer.Due, true);
+    }
+    expired.clear();
+}
+
+uint64_t CaptureExecutor::GetTimeAsNs(void)
+{
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+}
@@ -0,0 +1,127 @@
+#ifndef  H__CAPTURE_EXECUTOR__H
+#define  H__CAPTURE_EXECUTOR__H
+
+#include  <thread>
+#include  <mutex>
+#include  <condition_variable>
+#include  <atomic>
+#include  <functional>
+#include  <memory>
+#include  <deque>
+#include  <queue>
+#include  <vector>
+#include  <cstdint>
+#include  "LatencyHistogram.hpp"
+
+// Statistics of a CaptureExecutor returned by GetStats, counted since it was created
+struct CaptureExecutorStats
+{
+    int NumWorkers = 0;
+
+    int NumStreams = 0;  // streams added and not removed yet
+
+    uint64_t Steps = 0;  // steps run, each one frame captured or one look at a source whose frame was not due
+
+    uint64_t Steals = 0;  // steps a worker took from the queue of another worker
+
+    uint64_t Deferred = 0;  // steps put off until the source's frame was due
+
+    HistogramSnapshot ScheduleDelay;  // [ns] time a stream ready to run waited for a worker
+};
+
+// Fixed pool of capture workers shared by many streams, in place of one thread per controller.
+//
+// A stream is a step function run over and over, never by two workers at once; a step captures one frame and returns
+// when to run it again: 0 right away, a delay [ns] when the source's frame is not due yet (ICapturable::GetTimeToReady),
+// Park to sleep until Wake, or Finished. Each worker runs the streams of its own queue in turn, oldest first, and an idle
+// worker steals the stream queued earliest among the other queues (whatever their order), so a stream waits for at most
+// one step of each stream ahead of it.
+// Sources that cannot tell when their frame is due block a worker inside their step: give the executor at least as many
+// workers as such sources may wait at once.
+class CaptureExecutor
+{
+    public:
+        static constexpr uint64_t Park = UINT64_MAX;
+
+        static constexpr uint64_t Finished = UINT64_MAX - 1;
+
+        using Step = std::function<uint64_t(void)>;
+
+        struct Stream;
+
+    private:
+        struct Timer
+        {
+            uint64_t Due;  // [ns]
+            std::shared_ptr<Stream> Target;
+
+            bool operator>(const Timer& other) const { return Due > other.Due; }
+        };
+
+        struct Worker
+        {
+            std::mutex Mtx;
+            std::deque<std::shared_ptr<Stream>> Queue;
+            std::vector<Timer> Expired;  // used by the worker's own thread only
+            std::thread Thread;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        const std::vector<int> cpuAffinity_;
+
+        std::mutex mtx_;  // timers_, streams_ and the sleep of idle workers
+        std::condition_variable cvarToWakeWorker_;
+        std::condition_variable cvarToWakeTimerWatcher_;
+        std::condition_variable cvarToWaitFinished_;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+        std::vector<std::shared_ptr<Stream>> streams_;
+        std::atomic<uint64_t> nextDue_;  // [ns] earliest timer (UINT64_MAX: none), checked by busy workers as well
+        std::atomic<int> numQueued_;  // streams in the queues of the workers
+        std::atomic<int> numSleeping_;  // idle workers other than the timer watcher
+        std::atomic<bool> isTimerWatched_;  // an idle worker sleeps until the earliest timer, the others until work comes
+        std::atomic<uint32_t> nextHome_;
+        bool isQuit_;
+
+        std::atomic<uint64_t> steps_;
+        std::atomic<uint64_t> steals_;
+        std::atomic<uint64_t> deferred_;
+        LatencyHistogram scheduleDelay_;
+
+        void Main(int id);
+
+        std::shared_ptr<Stream> Pop(int id);
+
+        void Run(const std::shared_ptr<Stream>& stream, int id);
+
+        void Push(const std::shared_ptr<Stream>& stream, int id, uint64_t readyTime, bool isFromWorker);
+
+        void MoveDueTimers(int id);
+
+        static uint64_t GetTimeAsNs(void);
+
+    public:
+        // workers are pinned to cpuAffinity if given (empty: any CPU)
+        explicit CaptureExecutor(int numWorkers, const std::vector<int>& cpuAffinity = {});
+
+        // every stream must have been removed
+        ~CaptureExecutor();
+
+        CaptureExecutor(const CaptureExecutor&) = delete;
+
+        CaptureExecutor& operator=(const CaptureExecutor&) = delete;
+
+        // the stream starts parked, so that the caller can keep the handle before the first step runs
+        std::shared_ptr<Stream> Add(Step step);
+
+        // runs a parked stream again; a stream running or queued runs once more
+        void Wake(const std::shared_ptr<Stream>& stream);
+
+        // waits until a step of the stream has returned Finished
+        void Remove(const std::shared_ptr<Stream>& stream);
+
+        int GetNumWorkers(void) const { return static_cast<int>(workers_.size()); }
+
+        CaptureExecutorStats GetStats(void);
+};
+
+#endif  // H__CAPTURE_EXECUTOR__H
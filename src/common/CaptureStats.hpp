@@ -0,0 +1,221 @@
+#ifndef  H__CAPTURE_STATS__H
+#define  H__CAPTURE_STATS__H
+
+#include  <atomic>
+#include  <cstdint>
+#include  <sched.h>
+#include  "LatencyHistogram.hpp"
+
+// Statistics of one controller returned by MultiThreadCaptureController::GetStats, counted since the last reset
+struct CaptureStats
+{
+    uint64_t Produced = 0;  // frames published
+
+    uint64_t Consumed = 0;  // frames handed out to readers (one frame read by two readers counts twice)
+
+    uint64_t Overwritten = 0;  // frames written over before any reader got them
+
+    uint64_t Skipped = 0;  // frames passed over by ReadNext callers and consumers that fell behind
+
+    uint64_t ProducerStalls = 0;  // times the capture thread found every slot held by readers
+
+    uint64_t Suppressed = 0;  // frames not published as the motion gate found them unchanged
+
+    uint64_t NotRetrieved = 0;  // frames grabbed in lazy mode and never decoded, as no reader asked for them
+
+    // Lossless mode: frames published and not dequeued yet (kept across resets), the most there were at once,
+    // frames dropped and times the producer waited as the queue was full
+    uint64_t QueueDepth = 0;
+
+    uint64_t QueueHighWater = 0;
+
+    uint64_t QueueOverflows = 0;
+
+    uint64_t QueueBlocks = 0;
+
+    HistogramSnapshot CaptureDuration;  // [ns] time spent in the source's Capture (Grab and Retrieve in lazy mode)
+
+    HistogramSnapshot FrameInterval;  // [ns] time between two frames published
+
+    HistogramSnapshot FrameAge;  // [ns] time from publishing a frame to handing it to a reader
+
+    HistogramSnapshot ReaderWait;  // [ns] time readers were blocked waiting for a new frame
+
+    HistogramSnapshot ProducerWait;  // [ns] time the capture thread waited for a buffer to write into, per frame
+
+    HistogramSnapshot MotionCheck;  // [ns] time the motion gate took per frame
+
+    uint64_t Migrations = 0;  // times the capture thread ran on another CPU than for the frame before
+
+    int Cpu = -1;  // CPU the capture thread ran on for the last frame
+
+    // placement of the capture thread and its buffers as applied, not as requested (kept across resets)
+    bool IsPinned = false;
+
+    int SchedPolicy = SCHED_OTHER;
+
+    int SchedPriority = 0;
+
+    int NumaNode = -1;  // node the frame buffers are bound to (-1: none)
+
+    uint64_t BytesOnNumaNode = 0;
+};
+
+// Lock-free counters behind CaptureStats.
+//
+// The producer's and the readers' counters live on separate cache lines, so readers updating their counters
+// do not slow down the capture thread.
+class CaptureStatsCollector
+{
+    private:
+        // capture thread (or the pipeline committing in its place)
+        alignas(64) std::atomic<uint64_t> produced_;
+        std::atomic<uint64_t> stalls_;
+        std::atomic<uint64_t> notRetrieved_;
+        std::atomic<uint64_t> suppressed_;
+        std::atomic<uint64_t> queueHighWater_;
+        std::atomic<uint64_t> queueOverflows_;
+        std::atomic<uint64_t> queueBlocks_;
+        std::atomic<uint64_t> migrations_;
+        std::atomic<int> cpu_;
+        uint64_t lastPublished_;  // [ns] owned by the publishing thread
+        LatencyHistogram captureDuration_;
+        LatencyHistogram frameInterval_;
+        LatencyHistogram producerWait_;
+        LatencyHistogram motionCheck_;
+
+        // readers
+        alignas(64) std::atomic<uint64_t> consumed_;
+        std::atomic<uint64_t> skipped_;
+        LatencyHistogram frameAge_;
+        LatencyHistogram readerWait_;
+
+    public:
+        CaptureStatsCollector()
+            : produced_(0), stalls_(0), notRetrieved_(0), suppressed_(0), queueHighWater_(0), queueOverflows_(0), queueBlocks_(0),
+              migrations_(0), cpu_(-1), lastPublished_(0), consumed_(0), skipped_(0)
+        {
+        }
+
+        /* ----- Producer ----- */
+
+        void OnCaptured(uint64_t duration)
+        {
+            captureDuration_.Record(duration);
+        }
+
+        void OnPublished(uint64_t capturedTime)
+        {
+            produced_.fetch_add(1, std::memory_order_relaxed);
+            if ((lastPublished_ != 0) && (capturedTime > lastPublished_))
+            {
+                frameInterval_.Record(capturedTime - lastPublished_);
+            }
+            lastPublished_ = capturedTime;
+        }
+
+        void OnRunOn(int cpu)
+        {
+            auto last = cpu_.load(std::memory_order_relaxed);
+            if (cpu != last)
+            {
+                if (last >= 0)
+                {
+                    migrations_.fetch_add(1, std::memory_order_relaxed);
+                }
+                cpu_.store(cpu, std::memory_order_relaxed);
+            }
+        }
+
+        void OnStalled(void)
+        {
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void OnNotRetrieved(void)
+        {
+            notRetrieved_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void OnMotionChecked(uint64_t duration, bool isSuppressed)
+        {
+            motionCheck_.Record(duration);
+            if (isSuppressed)
+            {
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void OnQueued(uint64_t depth)
+        {
+            // written by the producer only
+            if (depth > queueHighWater_.load(std::memory_order_relaxed))
+            {
+                queueHighWater_.store(depth, std::memory_order_relaxed);
+            }
+        }
+
+        void OnQueueOverflowed(void)
+        {
+            queueOverflows_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void OnQueueBlocked(void)
+        {
+            queueBlocks_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void OnProducerWaited(uint64_t duration)
+        {
+            producerWait_.Record(duration);
+        }
+
+        /* ----- Reader ----- */
+
+        void OnRead(uint64_t age, uint64_t skipped)
+        {
+            consumed_.fetch_add(1, std::memory_order_relaxed);
+            if (skipped != 0)
+            {
+                skipped_.fetch_add(skipped, std::memory_order_relaxed);
+            }
+            frameAge_.Record(age);
+        }
+
+        void OnReaderWaited(uint64_t duration)
+        {
+            readerWait_.Record(duration);
+        }
+
+        /* ----- Any thread ----- */
+
+        // Overwritten, QueueDepth and the placement are left to the caller
+        CaptureStats Snapshot(bool reset = false)
+        {
+            auto take = [reset](std::atomic<uint64_t>& counter){
+                return reset ? counter.exchange(0, std::memory_order_relaxed) : counter.load(std::memory_order_relaxed);
+            };
+
+            auto stats = CaptureStats{};
+            stats.Produced = take(produced_);
+            stats.Consumed = take(consumed_);
+            stats.Skipped = take(skipped_);
+            stats.ProducerStalls = take(stalls_);
+            stats.NotRetrieved = take(notRetrieved_);
+            stats.Suppressed = take(suppressed_);
+            stats.QueueHighWater = take(queueHighWater_);
+            stats.QueueOverflows = take(queueOverflows_);
+            stats.QueueBlocks = take(queueBlocks_);
+            stats.Migrations = take(migrations_);
+            stats.Cpu = cpu_.load(std::memory_order_relaxed);
+            stats.CaptureDuration = captureDuration_.Snapshot(reset);
+            stats.FrameInterval = frameInterval_.Snapshot(reset);
+            stats.FrameAge = frameAge_.Snapshot(reset);
+            stats.ReaderWait = readerWait_.Snapshot(reset);
+            stats.ProducerWait = producerWait_.Snapshot(reset);
+            stats.MotionCheck = motionCheck_.Snapshot(reset);
+            return stats;
+        }
+};
+
+#endif  // H__CAPTURE_STATS__H
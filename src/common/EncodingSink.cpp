@@ -0,0 +1,249 @@
+#include  "EncodingSink.hpp"
+#include  <algorithm>
+#include  <chrono>
+#include  <cerrno>
+#include  <cstdio>
+#include  <cstring>
+#include  <fcntl.h>
+#include  <unistd.h>
+#include  "Ensuring.hpp"
+
+
+/* ----- Public ----- */
+
+EncodingSink::EncodingSink(IFrameEncoder* encoder, bool isEncoderDelete, const std::string& directory, const EncodingSinkConfig& config)
+    : EncodingSink(encoder, isEncoderDelete, EncodedFrameWriter{}, config)
+{
+    auto extension = extension_;
+    writer_ = [directory, extension](uint64_t sequence, uint64_t, const uint8_t* data, uint64_t size){
+        char name[32];
+        std::snprintf(name, sizeof(name), "/%010llu", static_cast<unsigned long long>(sequence));
+        return WriteFile(directory + name + extension, data, size);
+    };
+}
+
+EncodingSink::EncodingSink(IFrameEncoder* encoder, bool isEncoderDelete, EncodedFrameWriter writer, const EncodingSinkConfig& config)
+    : encoder_(encoder), isEncoderDelete_(isEncoderDelete), config_(config), writer_(std::move(writer)),
+      numQueued_(0), numRunning_(0),
+      submitted_(0), written_(0), bytesWritten_(0), dropped_(0), missed_(0), failed_(0), maxQueued_(0),
+      startTime_(GetTimeAsNs())
+{
+    ThrowExceptionIfNull(encoder_);
+    ThrowExceptionIfOutOfRange(config_.NumWorkers, 1, 256);
+    ThrowExceptionIfOutOfRange(config_.QueueCapacity, 1, 0xffff);
+
+    extension_ = encoder_->GetExtension();
+    workers_ = std::unique_ptr<ThreadPool>(new ThreadPool(config_.NumWorkers));
+}
+
+EncodingSink::~EncodingSink()
+{
+    Stop();
+    Flush();
+    workers_.reset();
+
+    if (isEncoderDelete_)
+    {
+        delete encoder_;
+    }
+}
+
+bool EncodingSink::Submit(const CaptureDataObject* frame, uint64_t capturedTime, uint64_t sequence)
+{
+    auto input = std::shared_ptr<CaptureDataObject>{};
+    {
+        auto lk = std::unique_lock<std::mutex>(mtx_);
+
+        if (inputPool_ == nullptr)
+        {
+            // every frame that can be held at once: the queue plus one per worker
+            inputPool_ = std::unique_ptr<FrameBufferPool>(new FrameBufferPool(frame->Format));
+            inputPool_->Reserve(config_.QueueCapacity + config_.NumWorkers);
+        }
+
+        auto& format = inputPool_->GetFormat();
+        if ((frame->Format.Width != format.Width) || (frame->Format.Height != format.Height)
+            || (frame->Format.NumChannels != format.NumChannels) || (frame->Format.NumBytesPerChannel != format.NumBytesPerChannel)
+            || (frame->Format.GetSizeOfFrame() != format.GetSizeOfFrame()))
+        {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (numQueued_ >= config_.QueueCapacity)
+        {
+            if (config_.OverflowPolicy == SinkOverflowPolicy::Drop)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto begin = GetTimeAsNs();
+            cvarSpace_.wait(lk, [this]{ return numQueued_ < config_.QueueCapacity; });
+            blockedDuration_.Record(GetTimeAsNs() - begin);
+        }
+
+        if (inputs_.empty())
+        {
+            input = inputPool_->Allocate();
+        }
+        else
+        {
+            input = std::move(inputs_.back());
+            inputs_.pop_back();
+        }
+        if (input == nullptr)
+        {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // the place in the queue is taken before the copy, so that no other caller can overfill it meanwhile
+        ++numQueued_;
+        maxQueued_ = std::max(maxQueued_, numQueued_);
+    }
+
+    // the copy lets the caller release its frame right away; it costs far less than the encoding
+    std::memcpy(const_cast<void*>(input->Data), frame->Data, frame->Format.GetSizeOfFrame());
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    workers_->Submit([this, input, capturedTime, sequence]{ Encode(input, capturedTime, sequence); });
+
+    return true;
+}
+
+bool EncodingSink::Start(MultiThreadCaptureController* controller)
+{
+    return attachment_.Start(controller, [this](const FrameLease& lease){
+            Submit(lease.Get(), lease.GetCapturedTime(), lease.GetSequence());
+        });
+}
+
+void EncodingSink::Stop(void)
+{
+    missed_.fetch_add(attachment_.Stop(), std::memory_order_relaxed);
+}
+
+void EncodingSink::Flush(void)
+{
+    auto lk = std::unique_lock<std::mutex>(mtx_);
+    cvarIdle_.wait(lk, [this]{ return (numQueued_ == 0) && (numRunning_ == 0); });
+}
+
+EncodingSinkStats EncodingSink::GetStats(void)
+{
+    auto stats = EncodingSinkStats{};
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stats.QueueDepth = numQueued_;
+        stats.MaxQueueDepth = maxQueued_;
+    }
+    stats.Submitted = submitted_.load(std::memory_order_relaxed);
+    stats.Written = written_.load(std::memory_order_relaxed);
+    stats.BytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    stats.Dropped = dropped_.load(std::memory_order_relaxed);
+    stats.Missed = missed_.load(std::memory_order_relaxed);
+    stats.Failed = failed_.load(std::memory_order_relaxed);
+    stats.Elapsed = GetTimeAsNs() - startTime_;
+    stats.EncodeDuration = encodeDuration_.Snapshot();
+    stats.WriteDuration = writeDuration_.Snapshot();
+    stats.BlockedDuration = blockedDuration_.Snapshot();
+
+    return stats;
+}
+
+
+/* ----- Private ----- */
+
+void EncodingSink::Encode(std::shared_ptr<CaptureDataObject> input, uint64_t capturedTime, uint64_t sequence)
+{
+    auto output = std::vector<uint8_t>{};
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        --numQueued_;
+        ++numRunning_;
+        if (!outputs_.empty())
+        {
+            output = std::move(outputs_.back());
+            outputs_.pop_back();
+        }
+    }
+    cvarSpace_.notify_one();
+
+    auto begin = GetTimeAsNs();
+    auto isEncoded = encoder_->Encode(input.get(), output);
+    auto encoded = GetTimeAsNs();
+    encodeDuration_.Record(encoded - begin);
+
+    // the input is no longer needed while the output is written
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        inputs_.push_back(std::move(input));
+    }
+
+    auto isWritten = isEncoded && writer_(sequence, capturedTime, output.data(), output.size());
+    if (isEncoded)
+    {
+        writeDuration_.Record(GetTimeAsNs() - encoded);
+    }
+
+    if (isWritten)
+    {
+        written_.fetch_add(1, std::memory_order_relaxed);
+        bytesWritten_.fetch_add(output.size(), std::memory_order_relaxed);
+    }
+    else
+    {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        outputs_.push_back(std::move(output));
+        --numRunning_;
+    }
+    cvarIdle_.notify_all();
+}
+
+bool EncodingSink::WriteFile(const std::string& path, const uint8_t* data, uint64_t size)
+{
+    // readers of the directory never see a file half written
+    auto temporary = path + ".part";
+    auto fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    auto isWritten = true;
+    for (uint64_t offset = 0; isWritten && (offset < size); )
+    {
+        auto ret = write(fd, data + offset, size - offset);
+        if (ret > 0)
+        {
+            offset += static_cast<uint64_t>(ret);
+        }
+        else if (!((ret < 0) && (errno == EINTR)))
+        {
+            isWritten = false;
+        }
+    }
+
+    isWritten = (close(fd) == 0) && isWritten;
+    if (!isWritten || (std::rename(temporary.c_str(), path.c_str()) != 0))
+    {
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t EncodingSink::GetTimeAsNs(void)
+{
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+}
@@ -0,0 +1,153 @@
+#ifndef  H__ENCODING_SINK__H
+#define  H__ENCODING_SINK__H
+
+#include  <string>
+#include  <vector>
+#include  <mutex>
+#include  <condition_variable>
+#include  <atomic>
+#include  <memory>
+#include  <functional>
+#include  <cstdint>
+#include  "AttachedConsumer.hpp"
+#include  "CaptureDataObject.hpp"
+#include  "FrameBufferPool.hpp"
+#include  "IFrameEncoder.hpp"
+#include  "LatencyHistogram.hpp"
+#include  "ThreadPool.hpp"
+
+class MultiThreadCaptureController;
+
+// What Submit does with a frame when QueueCapacity frames are already waiting for a worker
+enum class SinkOverflowPolicy : int
+{
+    Drop,  // refuse the frame and count it as dropped, the caller never waits
+    Block,  // wait for a worker to take a frame; when attached, the controller's history absorbs the delay
+};
+
+struct EncodingSinkConfig
+{
+    int NumWorkers = 2;
+
+    int QueueCapacity = 8;  // frames copied and waiting for a worker
+
+    SinkOverflowPolicy OverflowPolicy = SinkOverflowPolicy::Drop;
+};
+
+// Statistics of one sink returned by EncodingSink::GetStats, counted since it was created
+struct EncodingSinkStats
+{
+    uint64_t Submitted = 0;  // frames accepted into the queue
+
+    uint64_t Written = 0;
+
+    uint64_t BytesWritten = 0;  // [bytes] encoded
+
+    uint64_t Dropped = 0;  // frames refused as the queue was full
+
+    uint64_t Missed = 0;  // frames published while attached that the sink never got to, counted on Stop
+
+    uint64_t Failed = 0;  // frames that could not be encoded or written, or had another format than the first one
+
+    int QueueDepth = 0;  // frames waiting for a worker now
+
+    int MaxQueueDepth = 0;
+
+    uint64_t Elapsed = 0;  // [ns] since the sink was created
+
+    HistogramSnapshot EncodeDuration;  // [ns]
+
+    HistogramSnapshot WriteDuration;  // [ns]
+
+    HistogramSnapshot BlockedDuration;  // [ns] time Submit waited for room in the queue (Block only)
+
+    double GetFramesPerSecond(void) const
+    {
+        return (Elapsed != 0) ? Written * 1e9 / Elapsed : 0.0;
+    }
+
+    double GetBytesPerSecond(void) const
+    {
+        return (Elapsed != 0) ? BytesWritten * 1e9 / Elapsed : 0.0;
+    }
+};
+
+// Output of a sink: encoded bytes of frame sequence, true when stored. Called from the workers, one frame at a time per worker.
+using EncodedFrameWriter = std::function<bool(uint64_t sequence, uint64_t capturedTime, const uint8_t* data, uint64_t size)>;
+
+// Encoder of frames into image files off the reader's thread.
+//
+// Submit copies the frame into a pooled input buffer and returns; a worker pool encodes it into a pooled output buffer
+// and hands it to the writer, by default a file <directory>/<sequence><extension> written under a temporary name
+// and renamed when complete. At most QueueCapacity frames wait for a worker; OverflowPolicy decides what happens to
+// the next ones. Start attaches the sink to a controller, whose frames are then submitted through an AttachedConsumer.
+class EncodingSink
+{
+    private:
+        IFrameEncoder* encoder_;
+        const bool isEncoderDelete_;
+        const EncodingSinkConfig config_;
+        EncodedFrameWriter writer_;
+        std::string extension_;
+
+        std::mutex mtx_;
+        std::condition_variable cvarSpace_;
+        std::condition_variable cvarIdle_;
+        int numQueued_;  // waiting for a worker
+        int numRunning_;  // being encoded or written
+        std::unique_ptr<FrameBufferPool> inputPool_;  // created for the format of the first frame
+        std::vector<std::shared_ptr<CaptureDataObject>> inputs_;  // free input buffers
+        std::vector<std::vector<uint8_t>> outputs_;  // free output buffers, keeping their capacity
+
+        AttachedConsumer attachment_;
+
+        std::atomic<uint64_t> submitted_;
+        std::atomic<uint64_t> written_;
+        std::atomic<uint64_t> bytesWritten_;
+        std::atomic<uint64_t> dropped_;
+        std::atomic<uint64_t> missed_;
+        std::atomic<uint64_t> failed_;
+        int maxQueued_;  // guarded by mtx_
+        const uint64_t startTime_;
+        LatencyHistogram encodeDuration_;
+        LatencyHistogram writeDuration_;
+        LatencyHistogram blockedDuration_;
+
+        std::unique_ptr<ThreadPool> workers_;  // joined first, so that no worker touches the members above
+
+        void Encode(std::shared_ptr<CaptureDataObject> input, uint64_t capturedTime, uint64_t sequence);
+
+        static bool WriteFile(const std::string& path, const uint8_t* data, uint64_t size);
+
+        static uint64_t GetTimeAsNs(void);
+
+    public:
+        // writes the frames as files into directory, which must exist
+        EncodingSink(IFrameEncoder* encoder, bool isEncoderDelete, const std::string& directory, const EncodingSinkConfig& config = EncodingSinkConfig{});
+
+        EncodingSink(IFrameEncoder* encoder, bool isEncoderDelete, EncodedFrameWriter writer, const EncodingSinkConfig& config = EncodingSinkConfig{});
+
+        // stops, then encodes and writes the frames already submitted
+        ~EncodingSink();
+
+        EncodingSink(const EncodingSink&) = delete;
+
+        EncodingSink& operator=(const EncodingSink&) = delete;
+
+        // false if the frame was dropped or has another format than the first frame submitted
+        bool Submit(const CaptureDataObject* frame, uint64_t capturedTime, uint64_t sequence);
+
+        // submits the frames published from now on until Stop; the controller must outlive the attachment
+        bool Start(MultiThreadCaptureController* controller);
+
+        void Stop(void);
+
+        // waits until every frame submitted so far is written
+        void Flush(void);
+
+        EncodingSinkStats GetStats(void);
+
+        const EncodingSinkConfig& GetConfig(void) const { return config_; }
+};
+
+#endif  // H__ENCODING_SINK__H
@@ -21,5 +21,14 @@ static void ThrowExceptionIfZero(T value)
     }
 }
 
+template <typename T>
+static void ThrowExceptionIfOutOfRange(T value, T min, T max)
+{
+    if ((value < min) || (max < value))
+    {
+        throw new std::exception();
+    }
+}
+
 #endif  // H__ENSURING__H
 
@@ -0,0 +1,40 @@
+#include  "FrameAwaiter.hpp"
+#include  "MultiThreadCaptureController.hpp"
+
+
+/* ----- Public ----- */
+
+bool FrameAwaiter::await_ready(void)
+{
+    return controller_->IsEnd() || (controller_->ring_.GetPublishedSequence() > lastSequence_);
+}
+
+bool FrameAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    handle_ = handle;
+
+    // false: a frame came in the meantime, go on without suspending
+    return controller_->Suspend(this);
+}
+
+FrameLease FrameAwaiter::await_resume(void)
+{
+    return controller_->LeaseNext(lastSequence_, 0);
+}
+
+
+/* ----- Private ----- */
+
+void FrameAwaiter::Resume(void)
+{
+    // the coroutine may destroy this awaiter as soon as it runs
+    auto handle = handle_;
+    if (executor_ != nullptr)
+    {
+        auto executor = std::move(executor_);
+        executor([handle]{ handle.resume(); });
+        return;
+    }
+
+    handle.resume();
+}
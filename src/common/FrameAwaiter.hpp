@@ -0,0 +1,45 @@
+#ifndef  H__FRAME_AWAITER__H
+#define  H__FRAME_AWAITER__H
+
+#include  <coroutine>
+#include  <functional>
+#include  <cstdint>
+#include  "FrameLease.hpp"
+
+class MultiThreadCaptureController;
+
+// Runs a task on some thread, e.g. [&pool](auto task){ pool.Submit(std::move(task)); } (nullptr: on the capture thread)
+using FrameExecutor = std::function<void(std::function<void(void)>)>;
+
+// Awaitable returned by MultiThreadCaptureController::NextFrame.
+//
+// co_await gives a lease on the newest frame after lastSequence, as LeaseNext does, but suspends the coroutine
+// instead of blocking its thread. The coroutine is resumed by the thread publishing the frame, or on the executor
+// given to NextFrame; at the end of capture it is resumed with an invalid lease.
+// The controller must outlive the resumption.
+class FrameAwaiter
+{
+    friend class MultiThreadCaptureController;
+
+    private:
+        MultiThreadCaptureController* controller_;
+        uint64_t lastSequence_;
+        FrameExecutor executor_;
+        std::coroutine_handle<> handle_;
+
+        void Resume(void);
+
+    public:
+        FrameAwaiter(MultiThreadCaptureController* controller, uint64_t lastSequence, FrameExecutor executor)
+            : controller_(controller), lastSequence_(lastSequence), executor_(std::move(executor)), handle_(nullptr)
+        {
+        }
+
+        bool await_ready(void);
+
+        bool await_suspend(std::coroutine_handle<> handle);
+
+        FrameLease await_resume(void);
+};
+
+#endif  // H__FRAME_AWAITER__H
@@ -0,0 +1,186 @@
+#include  "FrameBufferPool.hpp"
+#include  <cstdlib>
+#include  <cstring>
+#include  <vector>
+#include  <unistd.h>
+#include  <sys/mman.h>
+#include  <sys/syscall.h>
+#include  <linux/mempolicy.h>
+#include  "Ensuring.hpp"
+
+
+/* ----- Public ----- */
+
+FrameBufferPool::FrameBufferPool(const FrameFormat& format, bool useHugePages, bool lockMemory, int numaNode)
+    : format_(format), sizeOfBuffer_(RoundUp(format.GetSizeOfFrame(), Alignment)),
+      useHugePages_(useHugePages), lockMemory_(lockMemory), numaNode_(numaNode),
+      memory_(std::make_shared<Memory>()),
+      bytesHeld_(0), bytesLocked_(0), bytesOnHugePages_(0), bytesOnNode_(0)
+{
+    ThrowExceptionIfZero(format_.GetSizeOfFrame());
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    // the objects still held keep memory_, and so the mappings, alive
+}
+
+bool FrameBufferPool::Reserve(int numBuffers)
+{
+    auto region = Region{};
+    if (!Map(sizeOfBuffer_ * numBuffers, &region))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+
+    memory_->Regions.push_back(region);
+    for (int idx = 0; idx < numBuffers; ++idx)
+    {
+        reserved_.push_back(reinterpret_cast<uint8_t*>(region.Address) + sizeOfBuffer_ * idx);
+    }
+
+    return true;
+}
+
+std::shared_ptr<CaptureDataObject> FrameBufferPool::Allocate(void)
+{
+    uint8_t* buffer = nullptr;
+
+    for (int n = 0; (n < 2) && (buffer == nullptr); ++n)
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (!reserved_.empty())
+            {
+                buffer = reserved_.front();
+                reserved_.erase(reserved_.begin());
+            }
+        }
+
+        if ((buffer == nullptr) && !Reserve(1))
+        {
+            return nullptr;
+        }
+    }
+
+    // the object describes the memory and keeps it mapped until it is dropped
+    return std::shared_ptr<CaptureDataObject>(
+            new CaptureDataObject(buffer, format_),
+            [memory = memory_](CaptureDataObject* captureDataObject){ delete captureDataObject; }
+        );
+}
+
+
+/* ----- Private ----- */
+
+FrameBufferPool::Memory::~Memory()
+{
+    for (auto& region : Regions)
+    {
+        Unmap(region);
+    }
+}
+
+bool FrameBufferPool::Map(uint64_t size, Region* region)
+{
+    region->Address = nullptr;
+    region->IsMapped = false;
+    region->IsLocked = false;
+
+    if (useHugePages_)
+    {
+        region->Size = RoundUp(size, HugePageSize);
+
+        // explicit huge pages first, then transparent huge pages on an aligned mapping
+        auto address = mmap(nullptr, region->Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (address != MAP_FAILED)
+        {
+            bytesOnHugePages_.fetch_add(region->Size, std::memory_order_relaxed);
+        }
+        else
+        {
+            address = mmap(nullptr, region->Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (address == MAP_FAILED)
+            {
+                return false;
+            }
+            madvise(address, region->Size, MADV_HUGEPAGE);
+        }
+
+        region->Address = address;
+        region->IsMapped = true;
+    }
+    else if (numaNode_ >= 0)
+    {
+        // a mapping of its own, so that the policy applies to these pages only
+        region->Size = RoundUp(size, static_cast<uint64_t>(sysconf(_SC_PAGESIZE)));
+        auto address = mmap(nullptr, region->Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED)
+        {
+            return false;
+        }
+
+        region->Address = address;
+        region->IsMapped = true;
+    }
+    else
+    {
+        region->Size = RoundUp(size, Alignment);
+        region->Address = std::aligned_alloc(Alignment, region->Size);
+        if (region->Address == nullptr)
+        {
+            return false;
+        }
+    }
+
+    if ((numaNode_ >= 0) && BindToNode(region->Address, region->Size))
+    {
+        // first touch: fault every page in now, on the node, instead of on the first frame
+        std::memset(region->Address, 0, region->Size);
+        bytesOnNode_.fetch_add(region->Size, std::memory_order_relaxed);
+    }
+
+    if (lockMemory_)
+    {
+        // without CAP_IPC_LOCK this may exceed RLIMIT_MEMLOCK, the buffer is still usable then
+        region->IsLocked = (mlock(region->Address, region->Size) == 0);
+        if (region->IsLocked)
+        {
+            bytesLocked_.fetch_add(region->Size, std::memory_order_relaxed);
+        }
+    }
+
+    bytesHeld_.fetch_add(region->Size, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool FrameBufferPool::BindToNode(void* address, uint64_t size)
+{
+    // mbind(2) through syscall, so that libnuma is not needed
+    constexpr int bitsPerWord = 8 * sizeof(unsigned long);
+    auto mask = std::vector<unsigned long>(numaNode_ / bitsPerWord + 1, 0);
+    mask[numaNode_ / bitsPerWord] |= 1UL << (numaNode_ % bitsPerWord);
+
+    // fails with EINVAL for a node that does not exist and ENOSYS on kernels without NUMA
+    return syscall(SYS_mbind, address, size, MPOL_BIND, mask.data(), mask.size() * bitsPerWord + 1, 0) == 0;
+}
+
+void FrameBufferPool::Unmap(const Region& region)
+{
+    if (region.IsLocked)
+    {
+        munlock(region.Address, region.Size);
+    }
+
+    if (region.IsMapped)
+    {
+        munmap(region.Address, region.Size);
+    }
+    else
+    {
+        std::free(region.Address);
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef  H__FRAME_BUFFER_POOL__H
+#define  H__FRAME_BUFFER_POOL__H
+
+#include  <mutex>
+#include  <atomic>
+#include  <vector>
+#include  <memory>
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+
+// Owner of the frame buffers of a controller.
+//
+// Buffers are sized from the full frame format and aligned to a cache line.
+// Reserve() carves several buffers out of one mapping, which keeps huge pages dense;
+// optionally the mappings are backed by 2 MB huge pages, locked in RAM, and bound to a NUMA node
+// and touched once so that their pages are placed there before the first frame.
+// The memory is freed once the pool and every object it handed out are gone, so a frame kept by a caller stays valid
+// after the controller is destroyed.
+class FrameBufferPool
+{
+    public:
+        static constexpr uint64_t Alignment = 64;
+        static constexpr uint64_t HugePageSize = 2 * 1024 * 1024;
+
+    private:
+        struct Region
+        {
+            void* Address;
+            uint64_t Size;
+            bool IsMapped;  // munmap if true, free otherwise
+            bool IsLocked;
+        };
+
+        // the mappings, shared by the pool and the deleter of every object handed out
+        struct Memory
+        {
+            std::vector<Region> Regions;
+
+            ~Memory();
+        };
+
+        const FrameFormat format_;
+        const uint64_t sizeOfBuffer_;  // size of a frame rounded up to Alignment
+        const bool useHugePages_;
+        const bool lockMemory_;
+        const int numaNode_;
+
+        std::mutex mtx_;
+        std::shared_ptr<Memory> memory_;
+        std::vector<uint8_t*> reserved_;  // carved but not handed out yet
+
+        std::atomic<uint64_t> bytesHeld_;
+        std::atomic<uint64_t> bytesLocked_;
+        std::atomic<uint64_t> bytesOnHugePages_;
+        std::atomic<uint64_t> bytesOnNode_;
+
+        static uint64_t RoundUp(uint64_t value, uint64_t unit)
+        {
+            return (value + unit - 1) / unit * unit;
+        }
+
+        bool Map(uint64_t size, Region* region);
+
+        bool BindToNode(void* address, uint64_t size);
+
+        static void Unmap(const Region& region);
+
+    public:
+        FrameBufferPool(const FrameFormat& format, bool useHugePages = false, bool lockMemory = false, int numaNode = -1);
+
+        ~FrameBufferPool();
+
+        FrameBufferPool(const FrameBufferPool&) = delete;
+
+        FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+        bool Reserve(int numBuffers);
+
+        // nullptr if the memory could not be allocated
+        std::shared_ptr<CaptureDataObject> Allocate(void);
+
+        const FrameFormat& GetFormat(void) const { return format_; }
+
+        uint64_t GetSizeOfBuffer(void) const { return sizeOfBuffer_; }
+
+        uint64_t GetBytesHeld(void) const { return bytesHeld_.load(std::memory_order_relaxed); }
+
+        uint64_t GetBytesLocked(void) const { return bytesLocked_.load(std::memory_order_relaxed); }
+
+        uint64_t GetBytesOnHugePages(void) const { return bytesOnHugePages_.load(std::memory_order_relaxed); }
+
+        // bytes bound to the NUMA node given at construction (0 if none was given or binding failed)
+        uint64_t GetBytesOnNode(void) const { return bytesOnNode_.load(std::memory_order_relaxed); }
+
+        int GetNumaNode(void) const { return numaNode_; }
+};
+
+#endif  // H__FRAME_BUFFER_POOL__H
@@ -0,0 +1,79 @@
+#include  "FrameConsumer.hpp"
+#include  <algorithm>
+#include  "MultiThreadCaptureController.hpp"
+
+
+/* ----- Public ----- */
+
+FrameConsumer::FrameConsumer(MultiThreadCaptureController* controller, FrameRing* ring, int id, uint64_t cursor)
+    : controller_(controller), ring_(ring), id_(id),
+      cursor_(cursor),
+      delivered_(0), dropped_(0), lastSequence_(cursor)
+{
+}
+
+FrameConsumer::~FrameConsumer()
+{
+    controller_->UnregisterConsumer(this);
+}
+
+FrameLease FrameConsumer::ReadNext(uint64_t timeout)
+{
+    // frames published before the end of the capture are still handed out: WaitForSequence returns at once for them
+    if (!controller_->WaitForSequence(cursor_, timeout))
+    {
+        return FrameLease();
+    }
+
+    while (true)
+    {
+        auto latest = ring_->GetPublishedSequence();
+
+        // frames older than the history are gone for this consumer
+        for (auto sequence = std::max(cursor_ + 1, ring_->GetOldestSequence()); sequence <= latest; ++sequence)
+        {
+            auto idx = ring_->PinSequence(sequence);
+            if (idx == FrameRing::NotApplicatable)
+            {
+                // overwritten while we were looking, try the next one
+                continue;
+            }
+
+            controller_->OnFrameRead(ring_->GetCapturedTime(idx), sequence - cursor_ - 1);
+            dropped_.fetch_add(sequence - cursor_ - 1, std::memory_order_relaxed);
+            delivered_.fetch_add(1, std::memory_order_relaxed);
+            lastSequence_.store(sequence, std::memory_order_relaxed);
+            cursor_ = sequence;
+
+            return FrameLease(ring_, idx, sequence);
+        }
+    }
+}
+
+void FrameConsumer::SkipToLatest(void)
+{
+    auto latest = ring_->GetPublishedSequence();
+    if (latest > cursor_)
+    {
+        dropped_.fetch_add(latest - cursor_, std::memory_order_relaxed);
+        lastSequence_.store(latest, std::memory_order_relaxed);
+        cursor_ = latest;
+    }
+}
+
+uint64_t FrameConsumer::GetLag(void) const
+{
+    auto latest = ring_->GetPublishedSequence();
+    auto last = lastSequence_.load(std::memory_order_relaxed);
+    return (latest > last) ? latest - last : 0;
+}
+
+FrameConsumerStats FrameConsumer::GetStats(void) const
+{
+    auto stats = FrameConsumerStats{};
+    stats.Id = id_;
+    stats.Delivered = delivered_.load(std::memory_order_relaxed);
+    stats.Dropped = dropped_.load(std::memory_order_relaxed);
+    stats.Lag = GetLag();
+    return stats;
+}
@@ -0,0 +1,63 @@
+#ifndef  H__FRAME_CONSUMER__H
+#define  H__FRAME_CONSUMER__H
+
+#include  <atomic>
+#include  <cstdint>
+#include  "FrameLease.hpp"
+
+class MultiThreadCaptureController;
+
+// Statistics of one registered consumer
+struct FrameConsumerStats
+{
+    int Id = 0;
+
+    uint64_t Delivered = 0;  // frames handed out to the consumer
+
+    uint64_t Dropped = 0;  // frames overwritten before the consumer got to them
+
+    uint64_t Lag = 0;  // frames published after the last one delivered
+};
+
+// Reader of the broadcast ring with its own cursor.
+//
+// Each consumer gets every frame in order as long as it keeps up with the producer;
+// a consumer that falls behind the history depth skips to the oldest frame still held and counts the drops.
+// Frames are handed out as leases, so no consumer blocks the producer or another consumer.
+// Created by MultiThreadCaptureController::RegisterConsumer and must not outlive the controller.
+class FrameConsumer
+{
+    private:
+        MultiThreadCaptureController* controller_;
+        FrameRing* ring_;
+        const int id_;
+
+        uint64_t cursor_;  // sequence number of the last frame delivered (owned by the consumer's thread)
+
+        std::atomic<uint64_t> delivered_;
+        std::atomic<uint64_t> dropped_;
+        std::atomic<uint64_t> lastSequence_;  // copy of cursor_ for GetStats
+
+    public:
+        FrameConsumer(MultiThreadCaptureController* controller, FrameRing* ring, int id, uint64_t cursor);
+
+        ~FrameConsumer();
+
+        FrameConsumer(const FrameConsumer&) = delete;
+
+        FrameConsumer& operator=(const FrameConsumer&) = delete;
+
+        // next frame after the cursor; invalid lease on timeout [ns], or at the end of capture once every frame published is read
+        FrameLease ReadNext(uint64_t timeout = UINT64_MAX);
+
+        // move the cursor to the newest frame, counting the frames in between as dropped
+        void SkipToLatest(void);
+
+        uint64_t GetLag(void) const;
+
+        FrameConsumerStats GetStats(void) const;
+
+        int GetId(void) const { return id_; }
+};
+
+#endif  // H__FRAME_CONSUMER__H
@@ -0,0 +1,37 @@
+#ifndef  H__FRAME_FORMAT__H
+#define  H__FRAME_FORMAT__H
+
+#include  <cstdint>
+
+// Layout of one frame in memory
+struct FrameFormat
+{
+    uint32_t Width = 0;
+
+    uint32_t Height = 0;
+
+    uint32_t NumChannels = 0;
+
+    uint32_t NumBytesPerChannel = 0;
+
+    uint64_t Stride = 0;  // [bytes] distance between the heads of two rows (0: packed rows)
+
+    bool IsPlanar = false;  // channels stored one after another as planes of Height rows
+
+    uint64_t GetRowBytes(void) const
+    {
+        return static_cast<uint64_t>(Width) * (IsPlanar ? 1 : NumChannels) * NumBytesPerChannel;
+    }
+
+    uint64_t GetStride(void) const
+    {
+        return (Stride != 0) ? Stride : GetRowBytes();
+    }
+
+    uint64_t GetSizeOfFrame(void) const
+    {
+        return GetStride() * Height * (IsPlanar ? NumChannels : 1);
+    }
+};
+
+#endif  // H__FRAME_FORMAT__H
@@ -0,0 +1,107 @@
+#ifndef  H__FRAME_LEASE__H
+#define  H__FRAME_LEASE__H
+
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+#include  "FrameRing.hpp"
+
+// Handle to one frame of a FrameRing.
+//
+// The slot stays pinned, so the producer never writes it, until the lease is released or destroyed.
+// A lease is movable but not copyable, and must not outlive the controller it was taken from.
+class FrameLease
+{
+    private:
+        FrameRing* ring_;
+        int idx_;
+        uint64_t sequence_;
+
+    public:
+        FrameLease()
+            : ring_(nullptr), idx_(FrameRing::NotApplicatable), sequence_(0)
+        {
+        }
+
+        // takes over a pin already held on idx
+        FrameLease(FrameRing* ring, int idx, uint64_t sequence)
+            : ring_(ring), idx_(idx), sequence_(sequence)
+        {
+        }
+
+        FrameLease(const FrameLease&) = delete;
+
+        FrameLease& operator=(const FrameLease&) = delete;
+
+        FrameLease(FrameLease&& other) noexcept
+            : ring_(other.ring_), idx_(other.idx_), sequence_(other.sequence_)
+        {
+            other.ring_ = nullptr;
+            other.idx_ = FrameRing::NotApplicatable;
+        }
+
+        FrameLease& operator=(FrameLease&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                ring_ = other.ring_;
+                idx_ = other.idx_;
+                sequence_ = other.sequence_;
+                other.ring_ = nullptr;
+                other.idx_ = FrameRing::NotApplicatable;
+            }
+            return *this;
+        }
+
+        ~FrameLease()
+        {
+            Release();
+        }
+
+        void Release(void)
+        {
+            if (ring_ != nullptr)
+            {
+                ring_->Unpin(idx_);
+                ring_ = nullptr;
+                idx_ = FrameRing::NotApplicatable;
+            }
+        }
+
+        bool IsValid(void) const
+        {
+            return ring_ != nullptr;
+        }
+
+        explicit operator bool(void) const
+        {
+            return IsValid();
+        }
+
+        const CaptureDataObject* Get(void) const
+        {
+            return IsValid() ? ring_->GetData(idx_).get() : nullptr;
+        }
+
+        const CaptureDataObject* operator->(void) const
+        {
+            return Get();
+        }
+
+        const void* Data(void) const
+        {
+            return IsValid() ? ring_->GetData(idx_)->Data : nullptr;
+        }
+
+        uint64_t GetCapturedTime(void) const
+        {
+            return IsValid() ? ring_->GetCapturedTime(idx_) : 0;
+        }
+
+        uint64_t GetSequence(void) const
+        {
+            return sequence_;
+        }
+};
+
+#endif  // H__FRAME_LEASE__H
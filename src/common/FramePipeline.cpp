@@ -0,0 +1,189 @@
+#include  "FramePipeline.hpp"
+#include  "Ensuring.hpp"
+
+
+/* ----- Public ----- */
+
+FramePipeline::FramePipeline(
+    const std::vector<std::shared_ptr<IFrameStage>>& stages,
+    const FrameFormat& inputFormat,
+    int numWorkers,
+    int numLanes,
+    FrameBufferPool* outputPool,
+    CommitFunction commit
+) :
+    stages_(stages), outputPool_(outputPool), commit_(commit),
+    nextIndex_(0), nextCommit_(0), isCancelled_(false),
+    processed_(0), dropped_(0)
+{
+    ThrowExceptionIfZero(stages_.size());
+    ThrowExceptionIfZero(numLanes);
+    ThrowExceptionIfNull(outputPool_);
+
+    formats_.push_back(inputFormat);
+    for (auto& stage : stages_)
+    {
+        ThrowExceptionIfNull(stage.get());
+        formats_.push_back(stage->GetOutputFormat(formats_.back()));
+    }
+
+    // every lane owns its input and intermediate buffers, only the output travels to the ring
+    for (size_t idx = 0; idx < stages_.size(); ++idx)
+    {
+        pools_.emplace_back(new FrameBufferPool(formats_[idx]));
+        pools_.back()->Reserve(numLanes);
+    }
+
+    lanes_.resize(numLanes);
+    for (int lane = 0; lane < numLanes; ++lane)
+    {
+        for (auto& pool : pools_)
+        {
+            auto buffer = pool->Allocate();
+            ThrowExceptionIfNull(buffer.get());
+            lanes_[lane].Buffers.push_back(buffer);
+        }
+        freeLanes_.push_back(lane);
+    }
+
+    workers_ = std::unique_ptr<ThreadPool>(new ThreadPool(numWorkers));
+}
+
+FramePipeline::~FramePipeline()
+{
+    Drain();
+    workers_.reset();
+}
+
+FrameFormat FramePipeline::GetOutputFormat(const std::vector<std::shared_ptr<IFrameStage>>& stages, const FrameFormat& inputFormat)
+{
+    auto format = inputFormat;
+    for (auto& stage : stages)
+    {
+        format = stage->GetOutputFormat(format);
+    }
+    return format;
+}
+
+int FramePipeline::AcquireLane(void)
+{
+    auto lk = std::unique_lock<std::mutex>(mtx_);
+    cvar_.wait(lk, [this]{ return isCancelled_ || !freeLanes_.empty(); });
+
+    if (isCancelled_)
+    {
+        return NotApplicatable;
+    }
+
+    auto lane = freeLanes_.back();
+    freeLanes_.pop_back();
+    return lane;
+}
+
+const std::shared_ptr<CaptureDataObject>& FramePipeline::GetInput(int lane) const
+{
+    return lanes_[lane].Buffers.front();
+}
+
+void FramePipeline::Submit(int lane, uint64_t capturedTime)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        lanes_[lane].Index = nextIndex_++;
+        lanes_[lane].CapturedTime = capturedTime;
+    }
+
+    workers_->Submit([this, lane]{ Process(lane); });
+}
+
+void FramePipeline::ReleaseLane(int lane)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        freeLanes_.push_back(lane);
+    }
+    cvar_.notify_all();
+}
+
+void FramePipeline::Cancel(void)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        isCancelled_ = true;
+    }
+    cvar_.notify_all();
+}
+
+void FramePipeline::Drain(void)
+{
+    auto lk = std::unique_lock<std::mutex>(mtx_);
+    cvar_.wait(lk, [this]{ return nextCommit_ == nextIndex_; });
+}
+
+
+/* ----- Private ----- */
+
+void FramePipeline::Process(int lane)
+{
+    // the lane belongs to this worker until it is listed in finished_
+    auto& target = lanes_[lane];
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (!freeOutputs_.empty())
+        {
+            target.Output = std::move(freeOutputs_.back());
+            freeOutputs_.pop_back();
+        }
+    }
+    if (target.Output == nullptr)
+    {
+        target.Output = outputPool_->Allocate();
+    }
+
+    auto isSuccess = (target.Output != nullptr);
+    for (size_t idx = 0; isSuccess && (idx < stages_.size()); ++idx)
+    {
+        auto& input = target.Buffers[idx];
+        auto& output = (idx + 1 < stages_.size()) ? target.Buffers[idx + 1] : target.Output;
+        isSuccess &= stages_[idx]->Process(input.get(), output.get());
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        target.IsSuccess = isSuccess;
+        finished_[target.Index] = lane;
+        CommitInOrder();
+    }
+    cvar_.notify_all();
+}
+
+void FramePipeline::CommitInOrder(void)
+{
+    // called with mtx_ held, which also serializes the producer side of the ring
+    while (!finished_.empty() && (finished_.begin()->first == nextCommit_))
+    {
+        auto lane = finished_.begin()->second;
+        finished_.erase(finished_.begin());
+
+        auto& target = lanes_[lane];
+        if (target.IsSuccess && commit_(target.Output, target.CapturedTime))
+        {
+            processed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // either the buffer swapped out of the ring or the output that was not published
+        if (target.Output != nullptr)
+        {
+            freeOutputs_.push_back(std::move(target.Output));
+            target.Output = nullptr;
+        }
+
+        freeLanes_.push_back(lane);
+        ++nextCommit_;
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef  H__FRAME_PIPELINE__H
+#define  H__FRAME_PIPELINE__H
+
+#include  <mutex>
+#include  <condition_variable>
+#include  <functional>
+#include  <atomic>
+#include  <vector>
+#include  <map>
+#include  <memory>
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+#include  "FrameBufferPool.hpp"
+#include  "IFrameStage.hpp"
+#include  "ThreadPool.hpp"
+
+// Runs a chain of IFrameStage on a worker pool behind the capture thread.
+//
+// The capture thread fills the input buffer of a free lane and submits it; a worker runs every stage
+// of that lane into an output buffer and the lanes are committed strictly in submission order.
+// The number of lanes bounds the frames in flight, so frame N+1 is captured while frame N is processed.
+// Output buffers come from the controller's pool and are swapped with the ring slot on commit (no copy).
+class FramePipeline
+{
+    public:
+        static constexpr int NotApplicatable = -1;
+
+        // publishes output; on success output is replaced by a buffer that may be reused
+        using CommitFunction = std::function<bool(std::shared_ptr<CaptureDataObject>& output, uint64_t capturedTime)>;
+
+    private:
+        struct Lane
+        {
+            std::vector<std::shared_ptr<CaptureDataObject>> Buffers;  // input, then the output of every stage but the last
+            std::shared_ptr<CaptureDataObject> Output;
+            uint64_t Index;
+            uint64_t CapturedTime;
+            bool IsSuccess;
+        };
+
+        std::vector<std::shared_ptr<IFrameStage>> stages_;
+        std::vector<FrameFormat> formats_;  // formats_[0] is the input, formats_[n + 1] the output of stage n
+        std::vector<std::unique_ptr<FrameBufferPool>> pools_;  // one per entry of Lane::Buffers
+        FrameBufferPool* outputPool_;
+        CommitFunction commit_;
+
+        std::mutex mtx_;
+        std::condition_variable cvar_;
+        std::vector<Lane> lanes_;
+        std::vector<int> freeLanes_;
+        std::vector<std::shared_ptr<CaptureDataObject>> freeOutputs_;
+        std::map<uint64_t, int> finished_;  // lanes done, keyed by submission index
+        uint64_t nextIndex_;  // given to the next submitted lane
+        uint64_t nextCommit_;  // index expected by the next commit
+        bool isCancelled_;
+
+        std::atomic<uint64_t> processed_;
+        std::atomic<uint64_t> dropped_;
+
+        std::unique_ptr<ThreadPool> workers_;  // destroyed first, so that no task touches the members above
+
+        void Process(int lane);
+
+        void CommitInOrder(void);
+
+    public:
+        FramePipeline(
+            const std::vector<std::shared_ptr<IFrameStage>>& stages,
+            const FrameFormat& inputFormat,
+            int numWorkers,
+            int numLanes,
+            FrameBufferPool* outputPool,
+            CommitFunction commit
+        );
+
+        ~FramePipeline();
+
+        // format produced by the last stage
+        static FrameFormat GetOutputFormat(const std::vector<std::shared_ptr<IFrameStage>>& stages, const FrameFormat& inputFormat);
+
+        /* ----- Capture thread ----- */
+
+        // blocks until a lane is free; NotApplicatable once cancelled
+        int AcquireLane(void);
+
+        const std::shared_ptr<CaptureDataObject>& GetInput(int lane) const;
+
+        void Submit(int lane, uint64_t capturedTime);
+
+        void ReleaseLane(int lane);
+
+        /* ----- Any thread ----- */
+
+        // wakes the capture thread waiting in AcquireLane and refuses further lanes
+        void Cancel(void);
+
+        // waits until every submitted lane is committed
+        void Drain(void);
+
+        uint64_t GetProcessed(void) const { return processed_.load(std::memory_order_relaxed); }
+
+        uint64_t GetDropped(void) const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+#endif  // H__FRAME_PIPELINE__H
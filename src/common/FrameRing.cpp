@@ -0,0 +1,277 @@
+#include  "FrameRing.hpp"
+#include  "Ensuring.hpp"
+#include  "SlotPinning.hpp"
+
+
+/* ----- Public ----- */
+
+FrameRing::FrameRing(int depth, int maxNumSlots)
+    : depth_(depth), maxNumSlots_(maxNumSlots), numSlots_(0),
+      published_(0), latest_(PackLatest(NotApplicatable, 0)), overwritten_(0), isUnpinWaited_(false), isUnpinned_(false),
+      sequence_(0), cursor_(0), idx_update_(NotApplicatable), idx_latest_(NotApplicatable)
+{
+    ThrowExceptionIfOutOfRange(depth_, MinNumSlots, MaxNumSlots);
+    ThrowExceptionIfOutOfRange(maxNumSlots_, depth_, MaxNumSlots);
+
+    // slot headers are reserved up to the capacity, so that appending never moves them under the readers
+    slots_ = std::unique_ptr<FrameSlot[]>(new FrameSlot[maxNumSlots_]);
+    history_ = std::unique_ptr<std::atomic<uint64_t>[]>(new std::atomic<uint64_t>[depth_]);
+
+    for (int idx = 0; idx < depth_; ++idx)
+    {
+        history_[idx].store(0, std::memory_order_relaxed);
+    }
+}
+
+int FrameRing::Append(std::shared_ptr<CaptureDataObject> data)
+{
+    auto idx = numSlots_.load(std::memory_order_relaxed);
+    if (idx == maxNumSlots_)
+    {
+        return NotApplicatable;
+    }
+
+    slots_[idx].Data = data;
+    numSlots_.store(idx + 1, std::memory_order_release);
+
+    return idx;
+}
+
+int FrameRing::AcquireForWrite(uint64_t keepAfter)
+{
+    auto numSlots = numSlots_.load(std::memory_order_relaxed);
+
+    for (int n = 0; n < numSlots; ++n)
+    {
+        auto idx = cursor_;
+        cursor_ = (cursor_ + 1 >= numSlots) ? 0 : cursor_ + 1;
+
+        // keep the latest frame readable while the next one is written
+        if (idx == idx_latest_) { continue; }
+
+        auto& slot = slots_[idx];
+        if (slot.Sequence.load(std::memory_order_relaxed) > keepAfter) { continue; }
+
+        uint64_t sequence;
+        if (!SlotPinning::TryClaim(slot.Sequence, slot.Pins, &sequence)) { continue; }
+
+        if ((sequence != 0) && !slot.IsRead.load(std::memory_order_relaxed))
+        {
+            overwritten_.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot.IsRead.store(false, std::memory_order_relaxed);
+
+        idx_update_ = idx;
+        return idx;
+    }
+
+    // every slot is held by readers
+    idx_update_ = NotApplicatable;
+    return NotApplicatable;
+}
+
+void FrameRing::Exchange(int idx, std::shared_ptr<CaptureDataObject>& data)
+{
+    // no reader holds the slot between AcquireForWrite and Publish
+    slots_[idx].Data.swap(data);
+}
+
+uint64_t FrameRing::Publish(uint64_t capturedTime)
+{
+    auto& slot = slots_[idx_update_];
+    auto sequence = ++sequence_;
+
+    slot.CapturedTime.store(capturedTime, std::memory_order_relaxed);
+    slot.Sequence.store(sequence, std::memory_order_release);
+    history_[sequence % depth_].store(PackEntry(sequence, idx_update_), std::memory_order_release);
+
+    // readers counted in the word of the previous frame hold its slot from now on
+    auto previous = latest_.exchange(PackLatest(idx_update_, 0), std::memory_order_acq_rel);
+    if ((previous >> countBits_) != slotMask_)
+    {
+        slots_[previous >> countBits_].Pins.fetch_add(static_cast<uint32_t>(previous & countMask_), std::memory_order_relaxed);
+    }
+
+    idx_latest_ = idx_update_;
+    idx_update_ = NotApplicatable;
+
+    published_.store(sequence, std::memory_order_release);
+
+    return sequence;
+}
+
+void FrameRing::WaitForUnpin(uint64_t keepAfter)
+{
+    auto lk = std::unique_lock<std::mutex>(mtxToWaitUnpin_);
+
+    // pairs with Unpin: either it sees the producer waiting or the producer sees the slot released
+    isUnpinWaited_.store(true, std::memory_order_seq_cst);
+    if (!HasWritableSlot(keepAfter))
+    {
+        cvarToWaitUnpin_.wait(lk, [this]{ return isUnpinned_; });
+    }
+    isUnpinWaited_.store(false, std::memory_order_relaxed);
+
+    // cleared only now, so that a WakeProducer just before the wait is not lost
+    isUnpinned_ = false;
+}
+
+void FrameRing::WakeProducer(void)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtxToWaitUnpin_);
+        isUnpinned_ = true;
+    }
+    cvarToWaitUnpin_.notify_one();
+}
+
+int FrameRing::PinLatest(uint64_t* sequence)
+{
+    // the slot named by the word is not written until the producer has moved this pin onto it
+    auto word = latest_.fetch_add(1, std::memory_order_acquire);
+    if ((word >> countBits_) == slotMask_) { return NotApplicatable; }  // the first publication drops this count
+
+    auto idx = static_cast<int>(word >> countBits_);
+    slots_[idx].IsRead.store(true, std::memory_order_relaxed);
+    *sequence = slots_[idx].Sequence.load(std::memory_order_relaxed);
+    return idx;
+}
+
+int FrameRing::PinNearest(uint64_t time, uint64_t* sequence)
+{
+    while (true)
+    {
+        auto latest = published_.load(std::memory_order_acquire);
+        if (latest == 0) { return NotApplicatable; }
+
+        auto oldest = (latest > static_cast<uint64_t>(depth_)) ? latest - depth_ + 1 : 1;
+
+        // find the first frame captured at or after the given time;
+        // frames already overwritten are older than any frame still held, so they count as "before"
+        auto lo = oldest;
+        auto hi = latest + 1;
+        while (lo < hi)
+        {
+            auto mid = lo + (hi - lo) / 2;
+            int idx;
+            uint64_t capturedTime;
+            if (!TryGetCapturedTime(mid, &idx, &capturedTime) || capturedTime < time)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        // the nearest frame is either the one found or its predecessor
+        int idx_nearest = NotApplicatable;
+        uint64_t seq_nearest = 0;
+        uint64_t diff_nearest = UINT64_MAX;
+        for (auto candidate : { lo - 1, lo })
+        {
+            int idx;
+            uint64_t capturedTime;
+            if ((candidate < oldest) || (candidate > latest)) { continue; }
+            if (!TryGetCapturedTime(candidate, &idx, &capturedTime)) { continue; }
+
+            auto diff = (capturedTime < time) ? time - capturedTime : capturedTime - time;
+            if (diff < diff_nearest)
+            {
+                idx_nearest = idx;
+                seq_nearest = candidate;
+                diff_nearest = diff;
+            }
+        }
+
+        if ((idx_nearest != NotApplicatable) && TryPin(idx_nearest, seq_nearest))
+        {
+            *sequence = seq_nearest;
+            return idx_nearest;
+        }
+    }
+}
+
+int FrameRing::PinSequence(uint64_t sequence)
+{
+    auto entry = history_[sequence % depth_].load(std::memory_order_acquire);
+    if ((entry >> slotBits_) != sequence) { return NotApplicatable; }
+
+    auto idx = static_cast<int>(entry & slotMask_);
+    return TryPin(idx, sequence) ? idx : NotApplicatable;
+}
+
+void FrameRing::Unpin(int idx)
+{
+    // give the pin back through the word while the slot is still the latest, so that the count there stays small;
+    // otherwise, or if the word has just changed, through the slot, where the pins of the word add up to the same
+    auto word = latest_.load(std::memory_order_relaxed);
+    if (((word >> countBits_) == static_cast<uint64_t>(idx)) && ((word & countMask_) != 0)
+            && latest_.compare_exchange_strong(word, word - 1, std::memory_order_release, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // the latest slot is never written, so only a pin given back through the slot may free one for the producer
+    Release(idx);
+}
+
+
+/* ----- Private ----- */
+
+bool FrameRing::TryPin(int idx, uint64_t sequence)
+{
+    auto& slot = slots_[idx];
+    if (SlotPinning::PinIfHeld(slot.Sequence, slot.Pins, sequence))
+    {
+        slot.IsRead.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    Release(idx);
+    return false;
+}
+
+void FrameRing::Release(int idx)
+{
+    // pairs with WaitForUnpin: either the producer sees the slot released or we see it waiting
+    slots_[idx].Pins.fetch_sub(1, std::memory_order_seq_cst);
+    if (isUnpinWaited_.load(std::memory_order_seq_cst))
+    {
+        WakeProducer();
+    }
+}
+
+bool FrameRing::HasWritableSlot(uint64_t keepAfter) const
+{
+    // same tests as AcquireForWrite, without taking the slot
+    auto numSlots = numSlots_.load(std::memory_order_relaxed);
+    for (int idx = 0; idx < numSlots; ++idx)
+    {
+        if (idx == idx_latest_) { continue; }
+        if (slots_[idx].Pins.load(std::memory_order_seq_cst) != 0) { continue; }
+        if (slots_[idx].Sequence.load(std::memory_order_relaxed) > keepAfter) { continue; }
+        return true;
+    }
+
+    return false;
+}
+
+bool FrameRing::TryGetCapturedTime(uint64_t sequence, int* idx, uint64_t* capturedTime) const
+{
+    auto entry = history_[sequence % depth_].load(std::memory_order_acquire);
+    if ((entry >> slotBits_) != sequence) { return false; }
+
+    auto& slot = slots_[entry & slotMask_];
+
+    // sequence lock read of the time stamp
+    if (slot.Sequence.load(std::memory_order_acquire) != sequence) { return false; }
+    auto time = slot.CapturedTime.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.Sequence.load(std::memory_order_relaxed) != sequence) { return false; }
+
+    *idx = static_cast<int>(entry & slotMask_);
+    *capturedTime = time;
+    return true;
+}
@@ -0,0 +1,178 @@
+#ifndef  H__FRAME_RING__H
+#define  H__FRAME_RING__H
+
+#include  <atomic>
+#include  <mutex>
+#include  <condition_variable>
+#include  <memory>
+#include  <tuple>
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+
+// One buffer of the frame history ring
+struct FrameSlot
+{
+    std::shared_ptr<CaptureDataObject> Data;
+
+    std::atomic<uint64_t> Sequence;  // sequence number of the frame held (0 while empty or being written)
+
+    std::atomic<uint64_t> CapturedTime;
+
+    std::atomic<uint32_t> Pins;  // number of readers holding this slot
+
+    std::atomic<bool> IsRead;  // pinned by a reader since it was published
+
+    FrameSlot() : Data(nullptr), Sequence(0), CapturedTime(0), Pins(0), IsRead(false) {}
+};
+
+// History ring of captured frames between one producer and its readers.
+//
+// The producer writes the oldest slot no reader has pinned, and publishes it with a new sequence number.
+// A history table indexed by sequence number keeps the slot of each of the last N (depth) frames,
+// so readers find the latest frame in O(1) and the frame nearest to a time stamp in O(log N).
+// Readers pin a slot before touching it and the producer never writes a pinned slot.
+// Pinning the latest frame is wait-free: the reader counts itself in the word naming the latest slot with one
+// atomic increment, and the producer moves that count onto the slot's pins when it publishes the next frame.
+// When every slot is pinned, the producer may append slots up to the capacity given at construction.
+class FrameRing
+{
+    public:
+        static constexpr int NotApplicatable = -1;
+        static constexpr int MinNumSlots = 3;  // update + latest + locked by a reader
+        static constexpr int MaxNumSlots = 0xffff;
+
+    private:
+        // layout of a history entry: [63:16] sequence number, [15:0] slot index
+        static constexpr int slotBits_ = 16;
+        static constexpr uint64_t slotMask_ = (1ULL << slotBits_) - 1;
+
+        // layout of the latest word: [63:48] slot index (slotMask_: none yet), [47:0] readers pinned through it
+        static constexpr int countBits_ = 48;
+        static constexpr uint64_t countMask_ = (1ULL << countBits_) - 1;
+
+        const int depth_;
+        const int maxNumSlots_;
+        std::atomic<int> numSlots_;  // appended by producer only
+        std::unique_ptr<FrameSlot[]> slots_;
+        std::unique_ptr<std::atomic<uint64_t>[]> history_;
+
+        alignas(64) std::atomic<uint64_t> published_;  // sequence number of the newest frame
+
+        alignas(64) std::atomic<uint64_t> latest_;  // slot of the newest frame and the pins taken through it
+
+        alignas(64) std::atomic<uint64_t> overwritten_;  // frames reused before any reader pinned them
+
+        alignas(64) std::atomic<bool> isUnpinWaited_;  // the producer sleeps in WaitForUnpin
+        std::mutex mtxToWaitUnpin_;
+        std::condition_variable cvarToWaitUnpin_;
+        bool isUnpinned_;  // guarded by mtxToWaitUnpin_
+
+        alignas(64) uint64_t sequence_;  // owned by producer
+        int cursor_;
+        int idx_update_;
+        int idx_latest_;
+
+        static constexpr uint64_t PackEntry(uint64_t sequence, int idx)
+        {
+            return (sequence << slotBits_) | (static_cast<uint64_t>(idx) & slotMask_);
+        }
+
+        static constexpr uint64_t PackLatest(int idx, uint64_t count)
+        {
+            return ((static_cast<uint64_t>(idx) & slotMask_) << countBits_) | count;
+        }
+
+        bool TryPin(int idx, uint64_t sequence);
+
+        void Release(int idx);
+
+        bool HasWritableSlot(uint64_t keepAfter) const;
+
+        bool TryGetCapturedTime(uint64_t sequence, int* idx, uint64_t* capturedTime) const;
+
+    public:
+        FrameRing(int depth, int maxNumSlots);
+
+        int GetDepth(void) const { return depth_; }
+
+        int GetNumSlots(void) const { return numSlots_.load(std::memory_order_acquire); }
+
+        int GetMaxNumSlots(void) const { return maxNumSlots_; }
+
+        /* ----- Producer ----- */
+
+        int Append(std::shared_ptr<CaptureDataObject> data);
+
+        // frames newer than keepAfter are not written over, even when no reader has pinned them
+        int AcquireForWrite(uint64_t keepAfter = UINT64_MAX);
+
+        // swap the buffer of the slot returned by AcquireForWrite, e.g. with a frame produced elsewhere
+        void Exchange(int idx, std::shared_ptr<CaptureDataObject>& data);
+
+        uint64_t Publish(uint64_t capturedTime);
+
+        // sleeps while AcquireForWrite(keepAfter) would find every slot held, until a reader unpins one or WakeProducer
+        void WaitForUnpin(uint64_t keepAfter = UINT64_MAX);
+
+        // any thread: lets WaitForUnpin return, e.g. to stop the producer
+        void WakeProducer(void);
+
+        // slot of the newest frame published, which AcquireForWrite leaves as it is (NotApplicatable before the first)
+        int GetPublishedIndex(void) const { return idx_latest_; }
+
+        /* ----- Reader ----- */
+
+        // wait-free
+        int PinLatest(uint64_t* sequence);
+
+        int PinNearest(uint64_t time, uint64_t* sequence);
+
+        int PinSequence(uint64_t sequence);
+
+        // wait-free
+        void Unpin(int idx);
+
+        /* ----- Any thread ----- */
+
+        uint64_t GetPublishedSequence(void) const
+        {
+            return published_.load(std::memory_order_acquire);
+        }
+
+        // frames the producer wrote over without any reader having pinned them
+        uint64_t GetNumOverwritten(bool reset = false)
+        {
+            return reset ? overwritten_.exchange(0, std::memory_order_relaxed) : overwritten_.load(std::memory_order_relaxed);
+        }
+
+        // oldest sequence number the history may still hold
+        uint64_t GetOldestSequence(void) const
+        {
+            auto latest = GetPublishedSequence();
+            return (latest > static_cast<uint64_t>(depth_)) ? latest - depth_ + 1 : 1;
+        }
+
+        // only stable while idx is pinned
+        const std::shared_ptr<CaptureDataObject>& GetData(int idx) const
+        {
+            return slots_[idx].Data;
+        }
+
+        uint64_t GetCapturedTime(int idx) const
+        {
+            return slots_[idx].CapturedTime.load(std::memory_order_relaxed);
+        }
+
+        uint64_t GetSequence(int idx) const
+        {
+            return slots_[idx].Sequence.load(std::memory_order_relaxed);
+        }
+
+        // (latest, update); only consistent while the producer is not running
+        std::tuple<int, int> GetIndicies(void) const
+        {
+            return std::tuple<int, int>(idx_latest_, idx_update_);
+        }
+};
+
+#endif  // H__FRAME_RING__H
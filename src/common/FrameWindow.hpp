@@ -0,0 +1,124 @@
+#ifndef  H__FRAME_WINDOW__H
+#define  H__FRAME_WINDOW__H
+
+#include  <vector>
+#include  <cstdint>
+#include  "FrameLease.hpp"
+#include  "FrameWindowBuffer.hpp"
+
+// Consecutive frames returned by MultiThreadCaptureController::ReadWindow, oldest first.
+//
+// Every frame is pinned as a FrameLease until the window is released or destroyed.
+// A packed window also points to the same frames back to back in one buffer (N x frame), which stays valid
+// as long as the window. Movable but not copyable, and must not outlive the controller.
+class FrameWindow
+{
+    private:
+        std::vector<FrameLease> leases_;
+        FrameWindowBuffer* buffer_;  // set when packed
+        const uint8_t* packed_;
+
+    public:
+        FrameWindow()
+            : buffer_(nullptr), packed_(nullptr)
+        {
+        }
+
+        // takes over the pins of the leases and, if packed is not nullptr, of the frames in buffer
+        FrameWindow(std::vector<FrameLease>&& leases, FrameWindowBuffer* buffer, const uint8_t* packed)
+            : leases_(std::move(leases)), buffer_(buffer), packed_(packed)
+        {
+        }
+
+        FrameWindow(const FrameWindow&) = delete;
+
+        FrameWindow& operator=(const FrameWindow&) = delete;
+
+        FrameWindow(FrameWindow&& other) noexcept
+            : leases_(std::move(other.leases_)), buffer_(other.buffer_), packed_(other.packed_)
+        {
+            other.leases_.clear();
+            other.buffer_ = nullptr;
+            other.packed_ = nullptr;
+        }
+
+        FrameWindow& operator=(FrameWindow&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                leases_ = std::move(other.leases_);
+                buffer_ = other.buffer_;
+                packed_ = other.packed_;
+                other.leases_.clear();
+                other.buffer_ = nullptr;
+                other.packed_ = nullptr;
+            }
+            return *this;
+        }
+
+        ~FrameWindow()
+        {
+            Release();
+        }
+
+        void Release(void)
+        {
+            if (packed_ != nullptr)
+            {
+                buffer_->Unpin(leases_.front().GetSequence(), GetLength());
+                buffer_ = nullptr;
+                packed_ = nullptr;
+            }
+            leases_.clear();
+        }
+
+        bool IsValid(void) const
+        {
+            return !leases_.empty();
+        }
+
+        explicit operator bool(void) const
+        {
+            return IsValid();
+        }
+
+        int GetLength(void) const
+        {
+            return static_cast<int>(leases_.size());
+        }
+
+        // n = 0 is the oldest frame, GetLength() - 1 the newest
+        const FrameLease& operator[](int n) const
+        {
+            return leases_[n];
+        }
+
+        uint64_t GetCapturedTime(int n) const
+        {
+            return leases_[n].GetCapturedTime();
+        }
+
+        uint64_t GetSequence(int n) const
+        {
+            return leases_[n].GetSequence();
+        }
+
+        bool IsPacked(void) const
+        {
+            return packed_ != nullptr;
+        }
+
+        // GetLength() frames of GetSizeOfFrame() bytes back to back (nullptr: not packed)
+        const void* GetPacked(void) const
+        {
+            return packed_;
+        }
+
+        uint64_t GetSizeOfFrame(void) const
+        {
+            return IsValid() ? leases_.front()->Format.GetSizeOfFrame() : 0;
+        }
+};
+
+#endif  // H__FRAME_WINDOW__H
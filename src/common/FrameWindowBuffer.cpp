@@ -0,0 +1,154 @@
+#include  "FrameWindowBuffer.hpp"
+#include  <numeric>
+#include  <cstring>
+#include  <unistd.h>
+#include  <sys/mman.h>
+#include  "Ensuring.hpp"
+#include  "SlotPinning.hpp"
+
+
+/* ----- Public ----- */
+
+FrameWindowBuffer::FrameWindowBuffer(const FrameFormat& format, int capacity)
+    : format_(format), sizeOfFrame_(format.GetSizeOfFrame()),
+      capacity_(capacity), isMirrored_(false), map_(nullptr), sizeOfMap_(0), skipped_(0)
+{
+    ThrowExceptionIfZero(sizeOfFrame_);
+    ThrowExceptionIfOutOfRange(capacity_, 1, 0xffff);
+
+    // the double mapping needs the buffer to end on a page boundary: round the capacity up to a multiple of
+    // the frames per page period, as long as that does not more than double it
+    auto pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    auto period = static_cast<int>(pageSize / std::gcd(sizeOfFrame_, pageSize));
+    auto rounded = (capacity_ + period - 1) / period * period;
+    if ((rounded <= capacity_ * 2) && MapMirrored(sizeOfFrame_ * rounded))
+    {
+        capacity_ = rounded;
+        isMirrored_ = true;
+    }
+    else if (!Map(sizeOfFrame_ * capacity_))
+    {
+        return;
+    }
+
+    slots_ = std::unique_ptr<Slot[]>(new Slot[capacity_]);
+    for (int idx = 0; idx < capacity_; ++idx)
+    {
+        slots_[idx].Sequence.store(0, std::memory_order_relaxed);
+        slots_[idx].Pins.store(0, std::memory_order_relaxed);
+    }
+}
+
+FrameWindowBuffer::~FrameWindowBuffer()
+{
+    if (map_ != nullptr)
+    {
+        munmap(map_, sizeOfMap_);
+    }
+}
+
+bool FrameWindowBuffer::Write(const CaptureDataObject* frame, uint64_t sequence)
+{
+    if ((map_ == nullptr) || (frame->Format.GetSizeOfFrame() != sizeOfFrame_))
+    {
+        return false;
+    }
+
+    auto idx = static_cast<int>(sequence % capacity_);
+    auto& slot = slots_[idx];
+
+    uint64_t held;
+    if (SlotPinning::TryClaim(slot.Sequence, slot.Pins, &held))
+    {
+        std::memcpy(map_ + sizeOfFrame_ * idx, frame->Data, sizeOfFrame_);
+        slot.Sequence.store(sequence, std::memory_order_release);
+        return true;
+    }
+
+    skipped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+const uint8_t* FrameWindowBuffer::Pin(uint64_t first, int length)
+{
+    auto head = static_cast<int>(first % capacity_);
+    if ((map_ == nullptr) || (length < 1) || (length > capacity_) || (!isMirrored_ && (head + length > capacity_)))
+    {
+        return nullptr;
+    }
+
+    for (int n = 0; n < length; ++n)
+    {
+        auto& slot = slots_[(head + n) % capacity_];
+
+        if (!SlotPinning::PinIfHeld(slot.Sequence, slot.Pins, first + n))
+        {
+            Unpin(first, n + 1);
+            return nullptr;
+        }
+    }
+
+    return map_ + sizeOfFrame_ * head;
+}
+
+void FrameWindowBuffer::Unpin(uint64_t first, int length)
+{
+    for (int n = 0; n < length; ++n)
+    {
+        slots_[(first + n) % capacity_].Pins.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+
+/* ----- Private ----- */
+
+bool FrameWindowBuffer::MapMirrored(uint64_t size)
+{
+    auto fd = memfd_create("frame_window", MFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    auto isMapped = false;
+    void* reserved = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    {
+        // reserve both halves at once, then map the same pages into each of them
+        reserved = mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (reserved != MAP_FAILED)
+    {
+        auto base = static_cast<uint8_t*>(reserved);
+        isMapped = (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+                && (mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED);
+        if (isMapped)
+        {
+            map_ = base;
+            sizeOfMap_ = size * 2;
+        }
+        else
+        {
+            munmap(reserved, size * 2);
+        }
+    }
+
+    // the mappings keep the memory
+    close(fd);
+
+    return isMapped;
+}
+
+bool FrameWindowBuffer::Map(uint64_t size)
+{
+    auto map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    map_ = static_cast<uint8_t*>(map);
+    sizeOfMap_ = size;
+
+    return true;
+}
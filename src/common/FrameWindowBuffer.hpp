@@ -0,0 +1,73 @@
+#ifndef  H__FRAME_WINDOW_BUFFER__H
+#define  H__FRAME_WINDOW_BUFFER__H
+
+#include  <atomic>
+#include  <memory>
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+
+// Frames of consecutive sequence numbers kept back to back, for ReadWindow(n, true).
+//
+// Frame s is copied to slot s % capacity by the producer as it is captured. The buffer is mapped twice in a row,
+// so any run of consecutive slots is contiguous in memory, even across the end: a window of n frames is a pointer
+// to n x GetSizeOfFrame() bytes. When the frame size does not allow the double mapping within twice the capacity,
+// the buffer is mapped once and windows running across the end are not available packed.
+// Readers pin the slots of a window; the producer skips a pinned slot, which leaves a hole for that frame.
+class FrameWindowBuffer
+{
+    private:
+        struct Slot
+        {
+            std::atomic<uint64_t> Sequence;  // frame held (0 while empty or being written)
+            std::atomic<uint32_t> Pins;
+        };
+
+        const FrameFormat format_;
+        const uint64_t sizeOfFrame_;
+        int capacity_;
+        bool isMirrored_;
+        uint8_t* map_;
+        uint64_t sizeOfMap_;
+        std::unique_ptr<Slot[]> slots_;
+
+        std::atomic<uint64_t> skipped_;  // frames not written because a reader held their slot
+
+        bool MapMirrored(uint64_t size);
+
+        bool Map(uint64_t size);
+
+    public:
+        FrameWindowBuffer(const FrameFormat& format, int capacity);
+
+        ~FrameWindowBuffer();
+
+        FrameWindowBuffer(const FrameWindowBuffer&) = delete;
+
+        FrameWindowBuffer& operator=(const FrameWindowBuffer&) = delete;
+
+        bool IsValid(void) const { return map_ != nullptr; }
+
+        bool IsMirrored(void) const { return isMirrored_; }
+
+        // may be rounded up from the capacity requested, so that the frames fill whole pages
+        int GetCapacity(void) const { return capacity_; }
+
+        uint64_t GetSizeOfFrame(void) const { return sizeOfFrame_; }
+
+        /* ----- Producer ----- */
+
+        // false if the slot is held by a reader or the frame has another size
+        bool Write(const CaptureDataObject* frame, uint64_t sequence);
+
+        uint64_t GetNumSkipped(void) const { return skipped_.load(std::memory_order_relaxed); }
+
+        /* ----- Reader ----- */
+
+        // head of frames first .. first + length - 1 back to back, nullptr if one of them is not held
+        const uint8_t* Pin(uint64_t first, int length);
+
+        void Unpin(uint64_t first, int length);
+};
+
+#endif  // H__FRAME_WINDOW_BUFFER__H
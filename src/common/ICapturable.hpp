@@ -1,6 +1,7 @@
 #ifndef  H__ICAPTURABLE__H
 #define  H__ICAPTURABLE__H
 
+#include  <memory>
 #include  "CaptureDataObject.hpp"
 
 class ICapturable
@@ -13,6 +14,33 @@ class ICapturable
         virtual uint64_t GetNBytes() = 0;
 
         virtual uint64_t GetLength() = 0;
+
+        // sources that know their image layout override this; the default is one packed row of GetLength() elements
+        virtual FrameFormat GetFormat()
+        {
+            auto length = GetLength();
+            auto nbytes = GetNBytes();
+            return FrameFormat{ static_cast<uint32_t>(length), 1, 1, static_cast<uint32_t>(nbytes), length * nbytes };
+        }
+
+        // sources already holding their frames in memory (e.g. a mapped recording) hand them out without a copy:
+        // the controller publishes the object returned by Borrow instead of calling Capture (nullptr: end of source)
+        virtual bool IsZeroCopy() { return false; }
+
+        virtual std::shared_ptr<CaptureDataObject> Borrow() { return nullptr; }
+
+        // sources that can take a frame without decoding it (e.g. VideoCapture::grab) split Capture in two:
+        // Grab takes the next frame and returns false at the end of the source, Retrieve decodes the frame
+        // grabbed last into the buffer. In lazy mode the controller retrieves only the frames readers ask for
+        virtual bool IsGrabbable() { return false; }
+
+        virtual bool Grab() { return false; }
+
+        virtual bool Retrieve(const CaptureDataObject *) { return false; }
+
+        // sources that know without blocking how long the next Capture (or Grab) would wait for its frame
+        // override this, so that a shared CaptureExecutor serves other streams meanwhile [ns] (0: ready or unknown)
+        virtual uint64_t GetTimeToReady() { return 0; }
 };
 
 #endif  /* H__ICAPTURABLE__H */
@@ -0,0 +1,24 @@
+#ifndef  H__IFRAME_ENCODER__H
+#define  H__IFRAME_ENCODER__H
+
+#include  <string>
+#include  <vector>
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+
+// Compression of a frame into a file format (JPEG, PNG, ...) for EncodingSink
+//
+// Encode is called from several worker threads at once for different frames, so it must be reentrant.
+class IFrameEncoder
+{
+    public:
+        virtual ~IFrameEncoder(){}
+
+        // file name extension including the dot, e.g. ".jpg"
+        virtual std::string GetExtension() = 0;
+
+        // replaces the contents of encoded; its capacity is kept between frames, so do not shrink it
+        virtual bool Encode(const CaptureDataObject* frame, std::vector<uint8_t>& encoded) = 0;
+};
+
+#endif  /* H__IFRAME_ENCODER__H */
@@ -0,0 +1,21 @@
+#ifndef  H__IFRAME_STAGE__H
+#define  H__IFRAME_STAGE__H
+
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+
+// One step of the post-capture processing chain (color conversion, resize, normalization, ...)
+//
+// Process is called from several worker threads at once for different frames, so it must be reentrant.
+class IFrameStage
+{
+    public:
+        virtual ~IFrameStage(){}
+
+        // format of the frames this stage produces from frames of the given format
+        virtual FrameFormat GetOutputFormat(const FrameFormat& input) = 0;
+
+        virtual bool Process(const CaptureDataObject* input, const CaptureDataObject* output) = 0;
+};
+
+#endif  /* H__IFRAME_STAGE__H */
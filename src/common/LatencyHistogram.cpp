@@ -0,0 +1,54 @@
+#include  "LatencyHistogram.hpp"
+#include  <algorithm>
+#include  <cmath>
+
+
+/* ----- Public ----- */
+
+uint64_t HistogramSnapshot::GetPercentile(double p) const
+{
+    if (Count == 0)
+    {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * Count));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < NumBuckets; ++bucket)
+    {
+        seen += Buckets[bucket];
+        if (seen >= rank)
+        {
+            auto upper = (bucket + 1 < NumBuckets) ? GetLowerBound(bucket + 1) - 1 : UINT64_MAX;
+            return std::min(upper, Max);
+        }
+    }
+    return Max;
+}
+
+LatencyHistogram::LatencyHistogram()
+    : sum_(0), max_(0)
+{
+    for (auto& bucket : buckets_)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot(bool reset)
+{
+    auto snapshot = HistogramSnapshot{};
+
+    for (int bucket = 0; bucket < HistogramSnapshot::NumBuckets; ++bucket)
+    {
+        snapshot.Buckets[bucket] = reset ? buckets_[bucket].exchange(0, std::memory_order_relaxed)
+                                         : buckets_[bucket].load(std::memory_order_relaxed);
+        snapshot.Count += snapshot.Buckets[bucket];
+    }
+    snapshot.Sum = reset ? sum_.exchange(0, std::memory_order_relaxed) : sum_.load(std::memory_order_relaxed);
+    snapshot.Max = reset ? max_.exchange(0, std::memory_order_relaxed) : max_.load(std::memory_order_relaxed);
+
+    return snapshot;
+}
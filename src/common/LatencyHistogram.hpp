@@ -0,0 +1,82 @@
+#ifndef  H__LATENCY_HISTOGRAM__H
+#define  H__LATENCY_HISTOGRAM__H
+
+#include  <atomic>
+#include  <cstdint>
+
+// Copy of a LatencyHistogram taken by Snapshot
+//
+// Buckets are log-linear: four per power of two, so a bucket spans at most 25% of its lower bound.
+struct HistogramSnapshot
+{
+    static constexpr int NumBuckets = 252;
+
+    uint64_t Buckets[NumBuckets] = {};
+
+    uint64_t Count = 0;
+
+    uint64_t Sum = 0;  // [ns]
+
+    uint64_t Max = 0;  // [ns]
+
+    double GetMean(void) const
+    {
+        return (Count != 0) ? static_cast<double>(Sum) / Count : 0.0;
+    }
+
+    // upper bound of the bucket holding the p-quantile (0 <= p <= 1), at most Max [ns]
+    uint64_t GetPercentile(double p) const;
+
+    static int GetBucket(uint64_t value)
+    {
+        if (value < 4)
+        {
+            return static_cast<int>(value);
+        }
+        auto msb = 63 - __builtin_clzll(value);
+        return (msb - 1) * 4 + static_cast<int>((value >> (msb - 2)) & 3);
+    }
+
+    static uint64_t GetLowerBound(int bucket)
+    {
+        if (bucket < 4)
+        {
+            return static_cast<uint64_t>(bucket);
+        }
+        return static_cast<uint64_t>(4 + bucket % 4) << (bucket / 4 - 1);
+    }
+};
+
+// Histogram of durations [ns] with fixed buckets, recorded lock-free from any number of threads.
+//
+// Recording is two relaxed additions, one to the bucket and one to the sum, plus a compare-and-swap when a new maximum is seen.
+class LatencyHistogram
+{
+    private:
+        std::atomic<uint64_t> buckets_[HistogramSnapshot::NumBuckets];
+        std::atomic<uint64_t> sum_;
+        std::atomic<uint64_t> max_;
+
+    public:
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void Record(uint64_t value)
+        {
+            buckets_[HistogramSnapshot::GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(value, std::memory_order_relaxed);
+
+            auto max = max_.load(std::memory_order_relaxed);
+            while ((value > max) && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // with reset, every count taken is cleared, so that no value recorded meanwhile is lost or counted twice
+        HistogramSnapshot Snapshot(bool reset = false);
+};
+
+#endif  // H__LATENCY_HISTOGRAM__H
@@ -0,0 +1,49 @@
+#include  "MotionGate.hpp"
+#include  <algorithm>
+#include  "PixelConversion.hpp"
+#include  "Ensuring.hpp"
+
+
+/* ----- Public ----- */
+
+MotionGate::MotionGate(double threshold, uint32_t gridStep)
+    : threshold_(threshold), gridStep_(gridStep)
+{
+    ThrowExceptionIfZero(gridStep_);
+}
+
+double MotionGate::Measure(const CaptureDataObject* frame, const CaptureDataObject* reference) const
+{
+    auto& format = frame->Format;
+    auto& other = reference->Format;
+    if ((format.Width != other.Width) || (format.Height != other.Height) || (format.NumChannels != other.NumChannels)
+        || (format.NumBytesPerChannel != other.NumBytesPerChannel) || (format.IsPlanar != other.IsPlanar))
+    {
+        return -1.0;
+    }
+
+    auto a = static_cast<const uint8_t*>(frame->Data);
+    auto b = static_cast<const uint8_t*>(reference->Data);
+    auto strideA = format.GetStride();
+    auto strideB = other.GetStride();
+    auto rowBytes = format.GetRowBytes();
+    auto numRows = static_cast<uint64_t>(format.Height) * (format.IsPlanar ? format.NumChannels : 1);
+    auto step = static_cast<uint64_t>(gridStep_);
+    auto run = (step == 1) ? rowBytes : RunBytes;  // without subsampling, one call per row
+
+    uint64_t sum = 0;
+    uint64_t numBytes = 0;
+    for (uint64_t y = 0; y < numRows; y += step)
+    {
+        auto rowA = a + strideA * y;
+        auto rowB = b + strideB * y;
+        for (uint64_t x = 0; x < rowBytes; x += run * step)
+        {
+            auto length = std::min(run, rowBytes - x);
+            sum += PixelConversion::SumOfAbsDiff(rowA + x, rowB + x, length);
+            numBytes += length;
+        }
+    }
+
+    return (numBytes != 0) ? static_cast<double>(sum) / numBytes : 0.0;
+}
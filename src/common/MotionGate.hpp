@@ -0,0 +1,39 @@
+#ifndef  H__MOTION_GATE__H
+#define  H__MOTION_GATE__H
+
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+
+// Cheap change metric between two frames, for suppressing frames of a still scene.
+//
+// The metric is the mean absolute difference per byte (0 to 255) over a grid: every gridStep-th row,
+// and on those rows one run of RunBytes bytes out of every gridStep, so about 1 / gridStep^2 of the frame is read.
+// The sums run on the SIMD kernels of PixelConversion.
+class MotionGate
+{
+    public:
+        static constexpr uint64_t RunBytes = 64;  // one cache line
+
+    private:
+        const double threshold_;
+        const uint32_t gridStep_;
+
+    public:
+        MotionGate(double threshold, uint32_t gridStep);
+
+        // -1 if the frames have different formats
+        double Measure(const CaptureDataObject* frame, const CaptureDataObject* reference) const;
+
+        // the frame differs from the reference by less than the threshold
+        bool IsStill(const CaptureDataObject* frame, const CaptureDataObject* reference) const
+        {
+            auto difference = Measure(frame, reference);
+            return (difference >= 0.0) && (difference < threshold_);
+        }
+
+        double GetThreshold(void) const { return threshold_; }
+
+        uint32_t GetGridStep(void) const { return gridStep_; }
+};
+
+#endif  // H__MOTION_GATE__H
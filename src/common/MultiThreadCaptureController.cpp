@@ -1,8 +1,10 @@
 #include  "MultiThreadCaptureController.hpp"
-#include  <cstdarg>
+#include  <algorithm>
+#include  "AsyncLogger.hpp"
 
-// using GCC extended syntax
-#define logMessage(str, fmt, ...)  __logMessage(__LINE__, str, fmt, ##__VA_ARGS__)
+// using GCC extended syntax; records are formatted later on the logger's thread
+#define logMessage(str, fmt, ...)  do { if (isDebug_) { CAPTURE_LOG(LogLevel::Debug, str, fmt, ##__VA_ARGS__); } } while (0)
+#define logTrace(str, fmt, ...)  do { if (isDebug_) { CAPTURE_LOG(LogLevel::Trace, str, fmt, ##__VA_ARGS__); } } while (0)
 
 
 /* ----- Public ----- */
@@ -12,25 +14,98 @@ MultiThreadCaptureController::MultiThreadCaptureController(
     bool disposeCaptureObejct,
     bool isDebug
 ) :
-    isReady_(false), isActive_(false), isQuit_(false),
+    MultiThreadCaptureController(cap, disposeCaptureObejct, CaptureControllerConfig{}, isDebug)
+{
+}
+
+MultiThreadCaptureController::MultiThreadCaptureController(
+    ICapturable* cap,
+    bool disposeCaptureObejct,
+    const CaptureControllerConfig& config,
+    bool isDebug
+) :
+    state_(CaptureState::Idle), numWaiters_(0),
     ownerThreadId_(-1), captureThreadId_(-1),
-    idx_latest_(notApplicatable_), idx_previous_(notApplicatable_), idx_update_(notApplicatable_), idx_locked_(notApplicatable_),
+    executor_(config.Executor), isYielding_(false),
+    ring_(GetRingDepth(config), GetRingCapacity(config)),
+    idx_locked_(notApplicatable_), nextConsumerId_(0),
+    numCallbacks_(0), nextCallbackId_(0),
+    collectStats_(config.CollectStats), stallBegin_(0),
+    cpuAffinity_(config.CpuAffinity), schedPolicy_(config.SchedPolicy), schedPriority_(config.SchedPriority),
+    isPinned_(false), appliedPolicy_(SCHED_OTHER), appliedPriority_(0),
+    keepAlive_(config.MotionKeepAlive),
+    isLossless_(config.Buffering == BufferingPolicy::Lossless), isQueueBlocking_(config.QueueOverflow == QueueOverflowPolicy::Block),
+    queueDepth_(static_cast<uint64_t>(config.QueueDepth)), queueHead_(0), isQueueWaited_(false),
+    isLazy_(false), grabbed_(0), retrievedGrab_(0),
     cap_(cap), disposeCaptureObejct_(disposeCaptureObejct), isDebug_(isDebug)
 {
     ThrowExceptionIfNull(cap_);
+    if (isLossless_ && (config.QueueDepth < 1))
+    {
+        throw new std::exception();
+    }
+
+    // lazy retrieve leaves frames undecoded, which a lossless queue must not
+    isLazy_ = config.LazyRetrieve && config.Stages.empty() && !isLossless_ && cap_->IsGrabbable();
+
+    // with processing stages the ring holds their output, not the raw frames
+    auto format = cap_->GetFormat();
+    auto formatOfRing = config.Stages.empty() ? format : FramePipeline::GetOutputFormat(config.Stages, format);
+
+    pool_ = std::unique_ptr<FrameBufferPool>(new FrameBufferPool(formatOfRing, config.UseHugePages, config.LockMemory, config.NumaNode));
+
+    // the slots of the history ring share one mapping
+    pool_->Reserve(ring_.GetDepth());
+    for (int idx = 0; idx < ring_.GetDepth(); ++idx)
+    {
+        auto captureData = AllocateCaptureData();
+        ThrowExceptionIfNull(captureData.get());
+        ring_.Append(captureData);
+    }
 
-    auto length = cap_->GetLength();
-    auto nbytes = cap_->GetNBytes();
+    if (config.MotionThreshold > 0.0)
+    {
+        gate_ = std::unique_ptr<MotionGate>(new MotionGate(config.MotionThreshold, static_cast<uint32_t>(config.MotionGridStep)));
+    }
+
+    if (config.PackedWindowCapacity > 0)
+    {
+        window_ = std::unique_ptr<FrameWindowBuffer>(new FrameWindowBuffer(formatOfRing, config.PackedWindowCapacity));
+    }
 
-    for (int idx = 0; idx < maxNumCaptureData_; ++idx)
+    if (!config.Stages.empty())
     {
-        captureData_[idx] = std::shared_ptr<CaptureDataObject>(new CaptureDataObject(reinterpret_cast<void*>(new uint8_t[length * nbytes]), nbytes, length));
-        capturedTimes_[idx] = (uint64_t)0;
+        auto commit = [this](std::shared_ptr<CaptureDataObject>& output, uint64_t capturedTime){ return PublishProcessed(output, capturedTime); };
+        pipeline_ = std::unique_ptr<FramePipeline>(
+                new FramePipeline(config.Stages, format, config.NumStageWorkers, config.NumStageWorkers + 1, pool_.get(), commit)
+            );
     }
 }
 
 MultiThreadCaptureController::~MultiThreadCaptureController()
 {
+    if (thread_.joinable() || (stream_ != nullptr))
+    {
+        FinishCapture();
+    }
+    else
+    {
+        // resume the coroutines still waiting for a frame
+        ChangeState(CaptureState::Quit);
+    }
+
+    // calls running on an executor hold leases on the ring
+    auto callbacks = std::vector<std::shared_ptr<FrameCallbackEntry>>{};
+    {
+        std::lock_guard<std::mutex> lk(mtxToCallbacks_);
+        callbacks.swap(callbacks_);
+        numCallbacks_.store(0, std::memory_order_release);
+    }
+    for (auto& callback : callbacks)
+    {
+        WaitForCallback(callback.get());
+    }
+
     Finalize();
 }
 
@@ -38,7 +113,22 @@ bool MultiThreadCaptureController::Setup(void)
 {
     logMessage("D", "entry to Setup");
 
-    thread_ = std::thread(&MultiThreadCaptureController::Main, this);
+    if (thread_.joinable() || (stream_ != nullptr) || IsEnd())
+    {
+        logMessage("D", "exit from Setup (already set up)");
+        return false;
+    }
+
+    if (executor_ != nullptr)
+    {
+        // the first step parks the stream until StartCapture, as the thread would wait in WaitForActive
+        stream_ = executor_->Add([this]{ return Step(); });
+        executor_->Wake(stream_);
+    }
+    else
+    {
+        thread_ = std::thread(&MultiThreadCaptureController::Main, this);
+    }
 
     mtxToSyncThread_.lock();
     ownerThreadId_ = std::this_thread::get_id();
@@ -53,49 +143,84 @@ bool MultiThreadCaptureController::StartCapture(void)
 {
     logMessage("D", "entry to StartCapture");
 
+    auto ret = true;
+
     mtxToSyncThread_.lock();
     {
-        isActive_ = true;
+        ret = (state_.load(std::memory_order_relaxed) != CaptureState::Quit);
+        if (ret)
+        {
+            state_.store(CaptureState::Active, std::memory_order_release);
+        }
     }
     mtxToSyncThread_.unlock();
 
+    // wake the capture thread parked in WaitForActive
+    cvarToWakeThread_.notify_one();
+    if (stream_ != nullptr)
+    {
+        executor_->Wake(stream_);
+    }
+
     logMessage("D", "exit from StartCapture");
 
-    return true;
+    return ret;
 }
 
 bool MultiThreadCaptureController::StopCapture(void)
 {
     logMessage("D", "entry to StopCapture");
 
+    auto ret = true;
+
     mtxToSyncThread_.lock();
     {
-        isActive_ = false;
+        ret = (state_.load(std::memory_order_relaxed) != CaptureState::Quit);
+        if (ret)
+        {
+            state_.store(CaptureState::Idle, std::memory_order_release);
+        }
     }
     mtxToSyncThread_.unlock();
 
     logMessage("D", "exit from StopCapture");
 
-    return true;
+    return ret;
 }
 
 bool MultiThreadCaptureController::FinishCapture(void)
 {
     logMessage("D", "entry to FinishCapture");
 
-    mtxToSyncThread_.lock();
+    ChangeState(CaptureState::Quit);
+
+    if (thread_.joinable())
     {
-        isQuit_ = true;
+        thread_.join();
     }
-    mtxToSyncThread_.unlock();
 
-    thread_.join();
+    if (stream_ != nullptr)
+    {
+        executor_->Remove(stream_);
+        stream_.reset();
+    }
+
+    if (pipeline_ != nullptr)
+    {
+        // publish the frames still in the stages
+        pipeline_->Drain();
+    }
 
     logMessage("D", "exit from FinishCapture");
 
     return true;
 }
 
+MultiThreadCaptureController::CaptureState MultiThreadCaptureController::GetState(void)
+{
+    return state_.load(std::memory_order_acquire);
+}
+
 std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t> MultiThreadCaptureController::Read(void)
 {
     if (IsEnd())
@@ -109,12 +234,19 @@ std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t> MultiThreadCaptureContr
         WaitForReady();
     }
 
+    WaitForNewestGrab();
+
     auto idx_latest = GetLatestIndex();
+    if (idx_latest == notApplicatable_)
+    {
+        return std::make_tuple<std::shared_ptr<CaptureDataObject>, uint64_t>(nullptr, -1);
+    }
 
-    auto capturedData = captureData_[idx_latest];
-    auto time_stamp = capturedTimes_[idx_latest];
+    auto capturedData = ring_.GetData(idx_latest);
+    auto time_stamp = ring_.GetCapturedTime(idx_latest);
+    OnFrameRead(time_stamp, 0);
 
-    return std::tuple<std::shared_ptr<CaptureDataObject>, int>(capturedData, time_stamp);
+    return std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>(capturedData, time_stamp);
 }
 
 std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t> MultiThreadCaptureController::ReadWithSync(uint64_t sync_time)
@@ -127,256 +259,1210 @@ std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t> MultiThreadCaptureContr
     if (!IsFirstCaptured())
     {
         // wait to become ready for reading captured data
-        auto lk = std::unique_lock<std::mutex>(mtxToConditionalWait_);
-        cvarToWaitThread_.wait(lk);
+        WaitForReady();
     }
 
     auto idx_locked = GetNearestIndex(sync_time);
+    if (idx_locked == notApplicatable_)
+    {
+        return std::make_tuple<std::shared_ptr<CaptureDataObject>, uint64_t>(nullptr, -1);
+    }
 
-    auto capturedData = captureData_[idx_locked];
-    auto captured_time = capturedTimes_[idx_locked];
+    auto capturedData = ring_.GetData(idx_locked);
+    auto captured_time = ring_.GetCapturedTime(idx_locked);
+    OnFrameRead(captured_time, 0);
 
-    return std::tuple<std::shared_ptr<CaptureDataObject>, int>(capturedData, captured_time);
+    return std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>(capturedData, captured_time);
 }
 
-
-/* ----- Private ----- */
-
-void MultiThreadCaptureController::Main(void)
+std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t, uint64_t, uint64_t> MultiThreadCaptureController::ReadNext(uint64_t lastSequence, uint64_t timeout)
 {
-    auto ret = true;
-    ret &= Initialize();
+    if (IsEnd() || !WaitForSequence(lastSequence, timeout))
+    {
+        return std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t, uint64_t, uint64_t>(nullptr, -1, lastSequence, 0);
+    }
 
-    while (ret)
+    auto idx_latest = GetLatestIndex();
+    if (idx_latest == notApplicatable_)
     {
-        ret &= Action();
+        return std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t, uint64_t, uint64_t>(nullptr, -1, lastSequence, 0);
     }
 
-    Finalize();
+    auto capturedData = ring_.GetData(idx_latest);
+    auto time_stamp = ring_.GetCapturedTime(idx_latest);
+    auto sequence = ring_.GetSequence(idx_latest);
+    OnFrameRead(time_stamp, sequence - lastSequence - 1);
+
+    return std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t, uint64_t, uint64_t>(capturedData, time_stamp, sequence, sequence - lastSequence - 1);
 }
 
-bool MultiThreadCaptureController::Initialize(void)
+uint64_t MultiThreadCaptureController::GetReadSequence(void)
 {
-    logMessage("D", "entry to Initialize");
-
-    mtxToSyncThread_.lock();
-    isReady_ = true;
-    mtxToSyncThread_.unlock();
-
-    captureThreadId_ = std::this_thread::get_id();
-
-    logMessage("D", "exit from Initialize");
-
-    return true;
+    // sequence number of the frame handed out by the last Read/ReadWithSync (0 if none)
+    return (idx_locked_ != notApplicatable_) ? ring_.GetSequence(idx_locked_) : 0;
 }
 
-bool MultiThreadCaptureController::Action(void)
+FrameLease MultiThreadCaptureController::Lease(void)
 {
-    auto ret = true;
-
-    if (IsReady())
+    if (IsEnd())
     {
-        // upon recieving a termination request
-        if (IsEnd()) { return false; }
-
-        auto idx_update = GetUpdateIndex();
+        return FrameLease();
+    }
 
-        auto capturedData = captureData_[idx_update];
-        ret &= cap_->Capture(capturedData.get());
-        if (!ret)
-        {
-            // end of capture by loading all the videos, or fail to capture from camera
-            isQuit_ = true;
-            return false;
-        }
+    if (!IsFirstCaptured())
+    {
+        WaitForReady();
+    }
 
-        auto time = GetTimeAsUs();
-        capturedTimes_[idx_update] = time;
+    WaitForNewestGrab();
 
-        if (!IsFirstCaptured())
-        {
-            OnCaptureReady();
-        }
+    uint64_t sequence = 0;
+    auto idx = ring_.PinLatest(&sequence);
+    if (idx == notApplicatable_)
+    {
+        return FrameLease();
     }
+    OnFrameRead(ring_.GetCapturedTime(idx), 0);
 
-    return ret;
+    return FrameLease(&ring_, idx, sequence);
 }
 
-void MultiThreadCaptureController::Finalize(void)
+FrameLease MultiThreadCaptureController::LeaseNext(uint64_t lastSequence, uint64_t timeout)
 {
-    logMessage("D", "entry to Finalize");
-
-    mtxToSyncThread_.lock();
+    if (IsEnd() || !WaitForSequence(lastSequence, timeout))
     {
-        idx_latest_ = notApplicatable_;
-        idx_previous_ = notApplicatable_;
-        idx_update_ = notApplicatable_;
-        idx_locked_ = notApplicatable_;
+        return FrameLease();
+    }
 
-        if (disposeCaptureObejct_)
-        {
-            delete cap_;
-            cap_ = nullptr;
-            disposeCaptureObejct_ = false;
-        }
+    uint64_t sequence = 0;
+    auto idx = ring_.PinLatest(&sequence);
+    if (idx == notApplicatable_)
+    {
+        return FrameLease();
     }
-    mtxToSyncThread_.unlock();
+    OnFrameRead(ring_.GetCapturedTime(idx), sequence - lastSequence - 1);
 
-    logMessage("D", "exit from Finalize");
+    return FrameLease(&ring_, idx, sequence);
 }
 
-bool MultiThreadCaptureController::IsEnd(void)
+FrameLease MultiThreadCaptureController::Dequeue(uint64_t timeout)
 {
-    auto is_quit = false;
-
-    mtxToSyncThread_.lock();
+    if (!isLossless_)
     {
-        is_quit = isQuit_;
+        return FrameLease();
     }
-    mtxToSyncThread_.unlock();
-
-    return is_quit;
-}
-    
-bool MultiThreadCaptureController::IsReady(void)
-{
-    return isReady_ && isActive_;
-}
-    
-bool MultiThreadCaptureController::IsFirstCaptured(void)
-{
-    auto ret = false;
 
-    mtxToSyncThread_.lock();
+    // queued frames outlive the capture, so the end only counts once they are all dequeued
+    auto head = queueHead_.load(std::memory_order_relaxed);
+    if (!WaitForSequence(head, timeout))
     {
-        ret = (idx_latest_ != notApplicatable_);
+        return FrameLease();
     }
-    mtxToSyncThread_.unlock();
 
-    return ret;
-}
-    
-void MultiThreadCaptureController::WaitForReady(void)
-{
-    logMessage("D", "entry to WaitForReady");
+    auto sequence = head + 1;
+    auto idx = ring_.PinSequence(sequence);
+    if (idx == notApplicatable_)
+    {
+        return FrameLease();
+    }
+    OnFrameRead(ring_.GetCapturedTime(idx), 0);
 
-    auto lk = std::unique_lock<std::mutex>(mtxToConditionalWait_);
-    cvarToWaitThread_.wait(lk);
+    // the lease keeps the frame now; let the producer write over it once released
+    queueHead_.store(sequence, std::memory_order_seq_cst);
+    if (isQueueWaited_.load(std::memory_order_seq_cst))
+    {
+        mtxToQueue_.lock();
+        mtxToQueue_.unlock();
+        cvarToWaitQueue_.notify_one();
+    }
 
-    logMessage("D", "exit from WaitForReady");
+    return FrameLease(&ring_, idx, sequence);
 }
 
-void MultiThreadCaptureController::OnCaptureReady(void)
+FrameLease MultiThreadCaptureController::LeaseWithSync(uint64_t sync_time)
 {
-    logMessage("D", "entry to OnCaptureReady");
+    if (IsEnd())
+    {
+        return FrameLease();
+    }
+
+    if (!IsFirstCaptured())
+    {
+        WaitForReady();
+    }
 
-    auto lk = std::unique_lock<std::mutex>(mtxToConditionalWait_);
-    cvarToWaitThread_.notify_one();
+    uint64_t sequence = 0;
+    auto idx = ring_.PinNearest(sync_time, &sequence);
+    if (idx == notApplicatable_)
+    {
+        return FrameLease();
+    }
+    OnFrameRead(ring_.GetCapturedTime(idx), 0);
 
-    logMessage("D", "exit from OnCaptureReady");
+    return FrameLease(&ring_, idx, sequence);
 }
-    
-void MultiThreadCaptureController::UpdateStateIndicies(void)
+
+FrameWindow MultiThreadCaptureController::ReadWindow(int length, bool isPacked)
 {
-    mtxToSyncThread_.lock();
+    // the producer keeps at least one slot to write into besides the window
+    if (IsEnd() || (length < 1) || (length >= ring_.GetDepth())
+        || (isPacked && ((window_ == nullptr) || !window_->IsValid() || (length > window_->GetCapacity()))))
     {
-        idx_previous_ = idx_latest_;
-        idx_latest_ = idx_update_;
+        return FrameWindow();
     }
-    mtxToSyncThread_.unlock();
 
-    //logMessage("D", "latest=%d, previous=%d, update=%d, locked=%d", idx_latest_, idx_previous_, idx_update_, idx_locked_);
-}
+    // wait for the first length frames
+    if (!WaitForSequence(static_cast<uint64_t>(length) - 1, InfiniteTimeout))
+    {
+        return FrameWindow();
+    }
 
-int MultiThreadCaptureController::GetUpdateIndex(void)
-{
-    int ret = 0;
+    WaitForNewestGrab();
 
-    mtxToSyncThread_.lock();
+    while (true)
     {
-        for (int idx = 0; idx < maxNumCaptureData_; ++idx)
+        auto latest = ring_.GetPublishedSequence();
+        auto first = latest - length + 1;
+
+        auto leases = std::vector<FrameLease>{};
+        leases.reserve(length);
+        for (auto sequence = first; sequence <= latest; ++sequence)
         {
-            if ((idx != idx_latest_) || (idx != idx_update_) || (idx != idx_locked_))
+            auto idx = ring_.PinSequence(sequence);
+            if (idx == notApplicatable_)
             {
-                ret = idx;
                 break;
             }
+            leases.emplace_back(&ring_, idx, sequence);
         }
 
-        idx_previous_ = idx_latest_;
-        idx_latest_ = idx_update_;
-        idx_update_ = ret;
-    }
-    mtxToSyncThread_.unlock();
+        if (static_cast<int>(leases.size()) < length)
+        {
+            // a frame of the window was written over (lapped, or its neighbours were leased): try the next window
+            logTrace("ReadWindow", "frame %lu of %lu..%lu not held", first + leases.size(), first, latest);
+            if ((ring_.GetPublishedSequence() == latest) && !WaitForSequence(latest, InfiniteTimeout))
+            {
+                return FrameWindow();
+            }
+            continue;
+        }
 
-    logMessage("GetUpdateIndex", "latest=%d, previous=%d, update=%d, locked=%d", idx_latest_, idx_previous_, idx_update_, idx_locked_);
+        auto packed = isPacked ? window_->Pin(first, length) : nullptr;
+        OnFrameRead(leases.back().GetCapturedTime(), 0);
 
-    return ret;
+        return FrameWindow(std::move(leases), window_.get(), packed);
+    }
 }
 
-int MultiThreadCaptureController::GetLatestIndex(void)
+FrameAwaiter MultiThreadCaptureController::NextFrame(uint64_t lastSequence, FrameExecutor executor)
+{
+    return FrameAwaiter(this, lastSequence, std::move(executor));
+}
+
+int MultiThreadCaptureController::OnFrame(FrameCallback callback, FrameExecutor executor)
 {
-    int ret = notApplicatable_;
+    auto entry = std::make_shared<FrameCallbackEntry>();
+    entry->Function = std::move(callback);
+    entry->Executor = std::move(executor);
+    entry->LastSequence = ring_.GetPublishedSequence();
+    entry->IsBusy.store(false, std::memory_order_relaxed);
 
-    mtxToSyncThread_.lock();
+    std::lock_guard<std::mutex> lk(mtxToCallbacks_);
+    entry->Id = nextCallbackId_++;
+    callbacks_.push_back(entry);
+    numCallbacks_.store(static_cast<int>(callbacks_.size()), std::memory_order_release);
+
+    logMessage("D", "register callback %d", entry->Id);
+
+    return entry->Id;
+}
+
+bool MultiThreadCaptureController::RemoveFrameCallback(int id)
+{
+    auto entry = std::shared_ptr<FrameCallbackEntry>{};
     {
-        for (int idx = 0; idx < maxNumCaptureData_; ++idx)
+        std::lock_guard<std::mutex> lk(mtxToCallbacks_);
+        auto it = std::find_if(callbacks_.begin(), callbacks_.end(), [id](auto& callback){ return callback->Id == id; });
+        if (it == callbacks_.end())
         {
-            if ((idx != idx_previous_) || (idx != idx_update_) || (idx != idx_locked_))
-            {
-                ret = idx;
-                break;
-            }
+            return false;
         }
-
-        idx_previous_ = idx_locked_;
-        idx_locked_ = ret;
-        idx_latest_ = notApplicatable_;
+        entry = *it;
+        callbacks_.erase(it);
+        numCallbacks_.store(static_cast<int>(callbacks_.size()), std::memory_order_release);
     }
-    mtxToSyncThread_.unlock();
 
-    logMessage("GetLatestIndex", "latest=%d, previous=%d, update=%d, locked=%d", idx_latest_, idx_previous_, idx_update_, idx_locked_);
+    WaitForCallback(entry.get());
 
-    return ret;
+    return true;
 }
 
-int MultiThreadCaptureController::GetNearestIndex(uint64_t sync_time)
+int MultiThreadCaptureController::GetNumCaptureData(void)
 {
-    auto ret = notApplicatable_;
-    return ret;
+    return ring_.GetNumSlots();
 }
 
-uint64_t MultiThreadCaptureController::GetTimeAsUs(void)
+FrameFormat MultiThreadCaptureController::GetFormat(void)
 {
-    return static_cast<uint64_t>(
-            std::chrono::duration_cast<std::chrono::nanoseconds>(
-                std::chrono::steady_clock::now().time_since_epoch()
-            ).count()
-        );
+    return pool_->GetFormat();
+}
+
+uint64_t MultiThreadCaptureController::GetBytesHeld(void)
+{
+    return pool_->GetBytesHeld();
+}
+
+uint64_t MultiThreadCaptureController::GetNumProcessed(void)
+{
+    return (pipeline_ != nullptr) ? pipeline_->GetProcessed() : 0;
+}
+
+uint64_t MultiThreadCaptureController::GetNumDropped(void)
+{
+    return (pipeline_ != nullptr) ? pipeline_->GetDropped() : 0;
+}
+
+CaptureStats MultiThreadCaptureController::GetStats(bool reset)
+{
+    auto stats = stats_.Snapshot(reset);
+    stats.Overwritten = ring_.GetNumOverwritten(reset);
+    stats.QueueDepth = isLossless_ ? ring_.GetPublishedSequence() - queueHead_.load(std::memory_order_acquire) : 0;
+    stats.IsPinned = isPinned_.load(std::memory_order_relaxed);
+    stats.SchedPolicy = appliedPolicy_.load(std::memory_order_relaxed);
+    stats.SchedPriority = appliedPriority_.load(std::memory_order_relaxed);
+    stats.NumaNode = (pool_->GetBytesOnNode() != 0) ? pool_->GetNumaNode() : -1;
+    stats.BytesOnNumaNode = pool_->GetBytesOnNode();
+    return stats;
 }
 
-void MultiThreadCaptureController::__logMessage(int line, const char* str, const char* fmt, ...)
+void MultiThreadCaptureController::ResetStats(void)
 {
-    if (isDebug_)
+    GetStats(true);
+}
+
+std::unique_ptr<FrameConsumer> MultiThreadCaptureController::RegisterConsumer(void)
+{
+    std::lock_guard<std::mutex> lk(mtxToConsumers_);
+
+    auto consumer = std::unique_ptr<FrameConsumer>(new FrameConsumer(this, &ring_, nextConsumerId_++, ring_.GetPublishedSequence()));
+    consumers_.push_back(consumer.get());
+
+    logMessage("D", "register consumer %d", consumer->GetId());
+
+    return consumer;
+}
+
+std::vector<FrameConsumerStats> MultiThreadCaptureController::GetConsumerStats(void)
+{
+    std::lock_guard<std::mutex> lk(mtxToConsumers_);
+
+    auto stats = std::vector<FrameConsumerStats>{};
+    for (auto consumer : consumers_)
+    {
+        stats.push_back(consumer->GetStats());
+    }
+    return stats;
+}
+
+
+/* ----- Private ----- */
+
+void MultiThreadCaptureController::Main(void)
+{
+    auto ret = true;
+    ret &= Initialize();
+
+    while (ret)
     {
-        char buf[1024]; // 1023bytes + '\0'
-        va_list ap;
+        ret &= Action();
+    }
+
+    Finalize();
+}
 
-        va_start(ap, fmt);
-        vsprintf(buf, fmt, ap);
-        va_end(ap);
+uint64_t MultiThreadCaptureController::Step(void)
+{
+    // yields back to the executor where the capture thread would block, so that a worker serves other streams
+    constexpr uint64_t backOffDelay = 50 * 1000;  // [ns]
 
-        auto thread_id = (captureThreadId_ == std::this_thread::get_id()) ? 1 : 0;
+    auto state = state_.load(std::memory_order_acquire);
+    if (state == CaptureState::Quit)
+    {
+        Finalize();
+        return CaptureExecutor::Finished;
+    }
 
-        std::printf("[%d][%s] %s (Line:%d @%s)\n", thread_id, str, buf, line, __FILE__);
+    if (state == CaptureState::Idle)
+    {
+        return CaptureExecutor::Park;
     }
+
+    if (isYielding_ || (isLossless_ && isQueueBlocking_ && IsQueueFull()))
+    {
+        // every slot held by readers, or the queue full: AdmitToQueue would wait on the worker
+        isYielding_ = false;
+        return backOffDelay;
+    }
+
+    auto timeToReady = cap_->GetTimeToReady();
+    if (timeToReady != 0)
+    {
+        return timeToReady;
+    }
+
+    if (!Action())
+    {
+        Finalize();
+        return CaptureExecutor::Finished;
+    }
+
+    return 0;
+}
+
+bool MultiThreadCaptureController::Initialize(void)
+{
+    logMessage("D", "entry to Initialize");
+
+    captureThreadId_ = std::this_thread::get_id();
+
+    ApplySchedulingOptions();
+
+    logMessage("D", "exit from Initialize");
+
+    return true;
+}
+
+bool MultiThreadCaptureController::Action(void)
+{
+    auto ret = true;
+    auto state = state_.load(std::memory_order_acquire);
+
+    if (state == CaptureState::Quit)
+    {
+        // upon recieving a termination request
+        return false;
+    }
+
+    if (state == CaptureState::Idle)
+    {
+        if (stream_ != nullptr)
+        {
+            // StopCapture came after Step looked at the state: park on the next step, not on a shared worker
+            return true;
+        }
+
+        // sleep without spinning until StartCapture or FinishCapture
+        WaitForActive();
+        return true;
+    }
+
+    if (pipeline_ != nullptr)
+    {
+        return CaptureToPipeline();
+    }
+
+    if (cap_->IsZeroCopy())
+    {
+        return BorrowFromSource();
+    }
+
+    if (isLazy_)
+    {
+        return GrabFromSource();
+    }
+
+    auto idx_update = GetUpdateIndex();
+    RecordProducerWait(idx_update);
+    if (idx_update == notApplicatable_)
+    {
+        // every slot is held by readers
+        YieldToReaders();
+        return true;
+    }
+
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+    auto capturedData = ring_.GetData(idx_update);
+    ret &= cap_->Capture(capturedData.get());
+    if (!ret)
+    {
+        // end of capture by loading all the videos, or fail to capture from camera
+        ChangeState(CaptureState::Quit);
+        return false;
+    }
+
+    auto time = GetTimeAsUs();
+    if (collectStats_)
+    {
+        stats_.OnCaptured(time - begin);
+        stats_.OnRunOn(sched_getcpu());
+    }
+
+    if (IsStill(capturedData.get(), time))
+    {
+        // the slot stays free for the next frame
+        return true;
+    }
+
+    if (isLossless_ && !AdmitToQueue())
+    {
+        return true;
+    }
+
+    PackFrame(capturedData.get());
+
+    // hand the captured slot over to the readers together with its time stamp
+    ring_.Publish(time);
+
+    if (collectStats_)
+    {
+        stats_.OnPublished(time);
+    }
+
+    OnCaptureReady();
+
+    return ret;
+}
+
+void MultiThreadCaptureController::Finalize(void)
+{
+    logMessage("D", "entry to Finalize");
+
+    mtxToSyncThread_.lock();
+    {
+        if (disposeCaptureObejct_)
+        {
+            delete cap_;
+            cap_ = nullptr;
+            disposeCaptureObejct_ = false;
+        }
+    }
+    mtxToSyncThread_.unlock();
+
+    logMessage("D", "exit from Finalize");
+}
+
+bool MultiThreadCaptureController::IsEnd(void)
+{
+    return state_.load(std::memory_order_acquire) == CaptureState::Quit;
+}
+
+void MultiThreadCaptureController::ChangeState(CaptureState state)
+{
+    mtxToSyncThread_.lock();
+    {
+        state_.store(state, std::memory_order_release);
+    }
+    mtxToSyncThread_.unlock();
+
+    cvarToWakeThread_.notify_one();
+    if (stream_ != nullptr)
+    {
+        executor_->Wake(stream_);
+    }
+
+    // wake the capture thread waiting for a slot held by readers
+    ring_.WakeProducer();
+
+    if (isLazy_ && (state != CaptureState::Quit))
+    {
+        // the readers in WaitForNewestGrab stop waiting once the capture is stopped (OnCaptureReady wakes them on Quit)
+        mtxToConditionalWait_.lock();
+        mtxToConditionalWait_.unlock();
+        cvarToWaitThread_.notify_all();
+    }
+
+    if ((state == CaptureState::Quit) && isLossless_)
+    {
+        // wake the producer waiting for room in the queue
+        mtxToQueue_.lock();
+        mtxToQueue_.unlock();
+        cvarToWaitQueue_.notify_all();
+    }
+
+    if ((state == CaptureState::Quit) && (pipeline_ != nullptr))
+    {
+        // wake the capture thread waiting for a free lane; after the producer wake-ups above, as a commit
+        // waiting for the queue or a slot holds the pipeline's lock
+        pipeline_->Cancel();
+    }
+
+    if (state == CaptureState::Quit)
+    {
+        // release the readers waiting for a frame that will never come
+        OnCaptureReady();
+    }
+}
+
+void MultiThreadCaptureController::WaitForActive(void)
+{
+    logMessage("D", "entry to WaitForActive");
+
+    auto lk = std::unique_lock<std::mutex>(mtxToSyncThread_);
+    cvarToWakeThread_.wait(lk, [this]{ return state_.load(std::memory_order_relaxed) != CaptureState::Idle; });
+
+    logMessage("D", "exit from WaitForActive");
+}
+    
+bool MultiThreadCaptureController::IsFirstCaptured(void)
+{
+    return ring_.GetPublishedSequence() != 0;
+}
+    
+void MultiThreadCaptureController::WaitForReady(void)
+{
+    logMessage("D", "entry to WaitForReady");
+
+    WaitForSequence(0, InfiniteTimeout);
+
+    logMessage("D", "exit from WaitForReady");
+}
+
+bool MultiThreadCaptureController::WaitForSequence(uint64_t lastSequence, uint64_t timeout)
+{
+    if (ring_.GetPublishedSequence() > lastSequence)
+    {
+        return true;
+    }
+
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+
+    // register before testing the predicate, so that OnCaptureReady cannot miss this reader
+    numWaiters_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        auto isPublished = [this, lastSequence]{ return (ring_.GetPublishedSequence() > lastSequence) || IsEnd(); };
+        auto lk = std::unique_lock<std::mutex>(mtxToConditionalWait_);
+        if (timeout == InfiniteTimeout)
+        {
+            cvarToWaitThread_.wait(lk, isPublished);
+        }
+        else
+        {
+            cvarToWaitThread_.wait_for(lk, std::chrono::nanoseconds(timeout), isPublished);
+        }
+    }
+    numWaiters_.fetch_sub(1, std::memory_order_relaxed);
+
+    if (collectStats_)
+    {
+        stats_.OnReaderWaited(GetTimeAsUs() - begin);
+    }
+
+    return ring_.GetPublishedSequence() > lastSequence;
+}
+
+void MultiThreadCaptureController::OnCaptureReady(void)
+{
+    DeliverToCallbacks();
+
+    // pairs with the registration in WaitForSequence and Suspend: either we see the waiter or it sees the new frame
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numWaiters_.load(std::memory_order_seq_cst) == 0)
+    {
+        return;
+    }
+
+    logMessage("D", "entry to OnCaptureReady");
+
+    ResumeAwaiters();
+
+    // taking the lock orders this notification after the waiter's predicate test
+    mtxToConditionalWait_.lock();
+    mtxToConditionalWait_.unlock();
+    cvarToWaitThread_.notify_all();
+
+    logMessage("D", "exit from OnCaptureReady");
+}
+
+bool MultiThreadCaptureController::Suspend(FrameAwaiter* awaiter)
+{
+    // registered as a waiter first, as in WaitForSequence, so that the lazy mode retrieves the frame it waits for
+    numWaiters_.fetch_add(1, std::memory_order_seq_cst);
+
+    std::lock_guard<std::mutex> lk(mtxToAwaiters_);
+    if ((ring_.GetPublishedSequence() > awaiter->lastSequence_) || IsEnd())
+    {
+        numWaiters_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    awaiters_.push_back(awaiter);
+    return true;
+}
+
+void MultiThreadCaptureController::ResumeAwaiters(void)
+{
+    auto ready = std::vector<FrameAwaiter*>{};
+    {
+        std::lock_guard<std::mutex> lk(mtxToAwaiters_);
+        if (awaiters_.empty())
+        {
+            return;
+        }
+
+        auto published = ring_.GetPublishedSequence();
+        auto isEnd = IsEnd();
+        auto it = std::partition(awaiters_.begin(), awaiters_.end(),
+                [published, isEnd](FrameAwaiter* awaiter){ return (published <= awaiter->lastSequence_) && !isEnd; });
+        ready.assign(it, awaiters_.end());
+        awaiters_.erase(it, awaiters_.end());
+    }
+
+    // resumed outside the lock: a coroutine resumed here may co_await again
+    for (auto awaiter : ready)
+    {
+        numWaiters_.fetch_sub(1, std::memory_order_relaxed);
+        awaiter->Resume();
+    }
+}
+
+void MultiThreadCaptureController::DeliverToCallbacks(void)
+{
+    if (numCallbacks_.load(std::memory_order_acquire) == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk(mtxToCallbacks_);
+    for (auto& callback : callbacks_)
+    {
+        uint64_t sequence = 0;
+        auto idx = ring_.PinLatest(&sequence);
+        if (idx == notApplicatable_)
+        {
+            return;
+        }
+
+        auto lease = FrameLease(&ring_, idx, sequence);
+        if ((sequence <= callback->LastSequence) || callback->IsBusy.exchange(true, std::memory_order_acquire))
+        {
+            // already delivered, or the callback is still busy with an earlier frame
+            continue;
+        }
+
+        OnFrameRead(lease.GetCapturedTime(), sequence - callback->LastSequence - 1);
+        callback->LastSequence = sequence;
+
+        if (callback->Executor == nullptr)
+        {
+            callback->Function(lease);
+            lease.Release();
+            EndCallback(callback.get());
+            continue;
+        }
+
+        // std::function needs a copyable task, the lease moves into a shared one
+        auto shared = std::make_shared<FrameLease>(std::move(lease));
+        callback->Executor([callback, shared]{
+            callback->Function(*shared);
+            shared->Release();
+            EndCallback(callback.get());
+        });
+    }
+}
+
+void MultiThreadCaptureController::EndCallback(FrameCallbackEntry* callback)
+{
+    {
+        std::lock_guard<std::mutex> lk(callback->MtxToWaitIdle);
+        callback->IsBusy.store(false, std::memory_order_release);
+    }
+    callback->CvarToWaitIdle.notify_all();
+}
+
+void MultiThreadCaptureController::WaitForCallback(FrameCallbackEntry* callback)
+{
+    // the call in flight on an executor still holds a lease on the ring
+    auto lk = std::unique_lock<std::mutex>(callback->MtxToWaitIdle);
+    callback->CvarToWaitIdle.wait(lk, [callback]{ return !callback->IsBusy.load(std::memory_order_acquire); });
+}
+    
+int MultiThreadCaptureController::GetRingDepth(const CaptureControllerConfig& config)
+{
+    // the queued frames, one slot to write into and one for a reader holding a frame
+    auto isLossless = (config.Buffering == BufferingPolicy::Lossless);
+    return isLossless ? std::max(config.NumCaptureData, config.QueueDepth + 2) : config.NumCaptureData;
+}
+
+int MultiThreadCaptureController::GetRingCapacity(const CaptureControllerConfig& config)
+{
+    auto depth = GetRingDepth(config);
+    if (config.MaxNumCaptureData == 0)
+    {
+        return depth;
+    }
+    return (config.Buffering == BufferingPolicy::Lossless) ? std::max(config.MaxNumCaptureData, depth) : config.MaxNumCaptureData;
+}
+
+int MultiThreadCaptureController::GetUpdateIndex(void)
+{
+    // in lossless mode the frames queued are not written over, however long they wait
+    auto keepAfter = isLossless_ ? queueHead_.load(std::memory_order_acquire) : UINT64_MAX;
+    auto ret = ring_.AcquireForWrite(keepAfter);
+    if ((ret == notApplicatable_) && (ring_.GetNumSlots() < ring_.GetMaxNumSlots()))
+    {
+        // every slot is leased, grow the pool by one buffer
+        auto captureData = AllocateCaptureData();
+        if (captureData != nullptr)
+        {
+            ring_.Append(captureData);
+            ret = ring_.AcquireForWrite(keepAfter);
+        }
+
+        logTrace("GetUpdateIndex", "grow to %d slots", ring_.GetNumSlots());
+    }
+
+    logTrace("GetUpdateIndex", "update=%d", ret);
+
+    return ret;
+}
+
+bool MultiThreadCaptureController::IsQueueFull(void)
+{
+    return ring_.GetPublishedSequence() - queueHead_.load(std::memory_order_seq_cst) >= queueDepth_;
+}
+
+bool MultiThreadCaptureController::AdmitToQueue(void)
+{
+    if (IsQueueFull())
+    {
+        if (!isQueueBlocking_)
+        {
+            stats_.OnQueueOverflowed();
+            return false;
+        }
+
+        stats_.OnQueueBlocked();
+        logTrace("AdmitToQueue", "wait for Dequeue, %d frames queued", static_cast<int>(queueDepth_));
+
+        // pairs with Dequeue: either it sees this producer waiting or the producer sees the frame dequeued
+        auto lk = std::unique_lock<std::mutex>(mtxToQueue_);
+        isQueueWaited_.store(true, std::memory_order_seq_cst);
+        cvarToWaitQueue_.wait(lk, [this]{ return !IsQueueFull() || IsEnd(); });
+        isQueueWaited_.store(false, std::memory_order_relaxed);
+
+        if (IsQueueFull())
+        {
+            // FinishCapture while the queue was full
+            return false;
+        }
+    }
+
+    stats_.OnQueued(ring_.GetPublishedSequence() + 1 - queueHead_.load(std::memory_order_relaxed));
+
+    return true;
+}
+
+int MultiThreadCaptureController::GetLatestIndex(void)
+{
+    uint64_t sequence = 0;
+    auto ret = ring_.PinLatest(&sequence);
+    LockIndex(ret);
+
+    logTrace("GetLatestIndex", "locked=%d, sequence=%lu", ret, sequence);
+
+    return ret;
+}
+
+int MultiThreadCaptureController::GetNearestIndex(uint64_t sync_time)
+{
+    uint64_t sequence = 0;
+    auto ret = ring_.PinNearest(sync_time, &sequence);
+    LockIndex(ret);
+
+    logTrace("GetNearestIndex", "locked=%d, sequence=%lu, sync_time=%lu", ret, sequence, sync_time);
+
+    return ret;
+}
+
+std::shared_ptr<CaptureDataObject> MultiThreadCaptureController::AllocateCaptureData(void)
+{
+    return pool_->Allocate();
+}
+
+void MultiThreadCaptureController::PackFrame(const CaptureDataObject* captureData)
+{
+    if (window_ != nullptr)
+    {
+        // before Publish, so that a window never sees the newest frame in the ring but not in the buffer;
+        // the frame about to be published gets the next sequence number
+        window_->Write(captureData, ring_.GetPublishedSequence() + 1);
+    }
+}
+
+bool MultiThreadCaptureController::IsStill(const CaptureDataObject* captureData, uint64_t time)
+{
+    if ((gate_ == nullptr) || !IsFirstCaptured())
+    {
+        return false;
+    }
+
+    // compared with the newest frame published, so that a slow drift adds up until it passes the threshold
+    auto idx_latest = ring_.GetPublishedIndex();
+    if ((keepAlive_ != 0) && (time >= ring_.GetCapturedTime(idx_latest) + keepAlive_))
+    {
+        return false;
+    }
+
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+    auto isStill = gate_->IsStill(captureData, ring_.GetData(idx_latest).get());
+    if (collectStats_)
+    {
+        stats_.OnMotionChecked(GetTimeAsUs() - begin, isStill);
+    }
+
+    logTrace("IsStill", "still=%d", isStill ? 1 : 0);
+
+    return isStill;
+}
+
+void MultiThreadCaptureController::UnregisterConsumer(FrameConsumer* consumer)
+{
+    std::lock_guard<std::mutex> lk(mtxToConsumers_);
+
+    consumers_.erase(std::remove(consumers_.begin(), consumers_.end(), consumer), consumers_.end());
+}
+
+bool MultiThreadCaptureController::CaptureToPipeline(void)
+{
+    // blocks while every lane is in the stages, which paces the camera to the slowest stage
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+    auto lane = pipeline_->AcquireLane();
+    if (lane == FramePipeline::NotApplicatable)
+    {
+        return false;
+    }
+
+    auto acquired = collectStats_ ? GetTimeAsUs() : 0;
+    if (!cap_->Capture(pipeline_->GetInput(lane).get()))
+    {
+        // the frames still in the stages are published before the end, as readers are still being served
+        pipeline_->ReleaseLane(lane);
+        pipeline_->Drain();
+        ChangeState(CaptureState::Quit);
+        return false;
+    }
+
+    auto time = GetTimeAsUs();
+    if (collectStats_)
+    {
+        stats_.OnProducerWaited(acquired - begin);
+        stats_.OnCaptured(time - acquired);
+        stats_.OnRunOn(sched_getcpu());
+    }
+
+    pipeline_->Submit(lane, time);
+
+    return true;
+}
+
+bool MultiThreadCaptureController::PublishProcessed(std::shared_ptr<CaptureDataObject>& output, uint64_t capturedTime)
+{
+    // called by the pipeline in capture order, one frame at a time, so the commit is the producer of the ring
+    if (IsStill(output.get(), capturedTime))
+    {
+        return true;
+    }
+
+    // room in the queue first, so that no slot is held while the queue is full
+    if (isLossless_ && !AdmitToQueue())
+    {
+        return false;
+    }
+
+    // the frame has been processed already and cannot be captured again: wait for a slot, as the capture thread does
+    // (YieldToReaders is not for this thread, which is not the executor's)
+    auto idx_update = GetUpdateIndex();
+    RecordProducerWait(idx_update);
+    while (idx_update == notApplicatable_)
+    {
+        if (IsEnd())
+        {
+            return false;
+        }
+
+        ring_.WaitForUnpin(isLossless_ ? queueHead_.load(std::memory_order_acquire) : UINT64_MAX);
+        idx_update = GetUpdateIndex();
+        RecordProducerWait(idx_update);
+    }
+
+    ring_.Exchange(idx_update, output);
+    PackFrame(ring_.GetData(idx_update).get());
+    ring_.Publish(capturedTime);
+
+    if (collectStats_)
+    {
+        stats_.OnPublished(capturedTime);
+    }
+
+    OnCaptureReady();
+
+    return true;
+}
+
+bool MultiThreadCaptureController::BorrowFromSource(void)
+{
+    auto idx_update = GetUpdateIndex();
+    RecordProducerWait(idx_update);
+    if (idx_update == notApplicatable_)
+    {
+        // every slot is held by readers
+        YieldToReaders();
+        return true;
+    }
+
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+    auto borrowed = cap_->Borrow();
+    if (borrowed == nullptr)
+    {
+        // end of the source
+        ChangeState(CaptureState::Quit);
+        return false;
+    }
+
+    auto time = GetTimeAsUs();
+    if (collectStats_)
+    {
+        stats_.OnCaptured(time - begin);
+        stats_.OnRunOn(sched_getcpu());
+    }
+
+    if (IsStill(borrowed.get(), time))
+    {
+        return true;
+    }
+
+    if (isLossless_ && !AdmitToQueue())
+    {
+        return true;
+    }
+
+    // the slot now refers to the source's memory; the buffer it held before is dropped with borrowed
+    ring_.Exchange(idx_update, borrowed);
+    PackFrame(ring_.GetData(idx_update).get());
+    ring_.Publish(time);
+
+    if (collectStats_)
+    {
+        stats_.OnPublished(time);
+    }
+
+    OnCaptureReady();
+
+    return true;
+}
+
+bool MultiThreadCaptureController::GrabFromSource(void)
+{
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+    if (!cap_->Grab())
+    {
+        // end of the source
+        ChangeState(CaptureState::Quit);
+        return false;
+    }
+
+    // the frame is stamped when grabbed, however late it is decoded
+    auto time = GetTimeAsUs();
+    auto grabbed = grabbed_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // pairs with the registration in WaitForSequence, as in OnCaptureReady
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (IsFirstCaptured() && (numWaiters_.load(std::memory_order_seq_cst) == 0))
+    {
+        // nobody is waiting: the next grab replaces this frame undecoded
+        if (collectStats_)
+        {
+            stats_.OnNotRetrieved();
+        }
+        return true;
+    }
+
+    auto idx_update = GetUpdateIndex();
+    RecordProducerWait(idx_update);
+    if (idx_update == notApplicatable_)
+    {
+        // every slot is held by readers, and a grabbed frame cannot wait for one
+        if (collectStats_)
+        {
+            stats_.OnNotRetrieved();
+        }
+        YieldToReaders();
+        return true;
+    }
+
+    auto capturedData = ring_.GetData(idx_update);
+    if (!cap_->Retrieve(capturedData.get()))
+    {
+        ChangeState(CaptureState::Quit);
+        return false;
+    }
+
+    if (collectStats_)
+    {
+        stats_.OnCaptured(GetTimeAsUs() - begin);
+        stats_.OnRunOn(sched_getcpu());
+    }
+
+    if (IsStill(capturedData.get(), time))
+    {
+        // the newest frame published stands for this grab, so the readers in WaitForNewestGrab may go on with it
+        retrievedGrab_.store(grabbed, std::memory_order_release);
+        mtxToConditionalWait_.lock();
+        mtxToConditionalWait_.unlock();
+        cvarToWaitThread_.notify_all();
+        return true;
+    }
+
+    PackFrame(capturedData.get());
+    ring_.Publish(time);
+    retrievedGrab_.store(grabbed, std::memory_order_release);
+
+    if (collectStats_)
+    {
+        stats_.OnPublished(time);
+    }
+
+    OnCaptureReady();
+
+    return true;
+}
+
+void MultiThreadCaptureController::WaitForNewestGrab(void)
+{
+    if (!isLazy_)
+    {
+        return;
+    }
+
+    // the newest frame published is stale once a later grab was left undecoded: wait until the capture thread
+    // has dealt with the grabs up to now, which it does as this reader is waiting; a grab found still publishes
+    // nothing, so the wait is for the grab number rather than for a new frame
+    auto grabbed = grabbed_.load(std::memory_order_acquire);
+    auto isRetrieved = [this, grabbed]{
+        return (retrievedGrab_.load(std::memory_order_acquire) >= grabbed)
+            || (state_.load(std::memory_order_acquire) != CaptureState::Active);
+    };
+    if (isRetrieved())
+    {
+        return;
+    }
+
+    auto begin = collectStats_ ? GetTimeAsUs() : 0;
+
+    // register before testing the predicate, so that the capture thread retrieves the next grab
+    numWaiters_.fetch_add(1, std::memory_order_seq_cst);
+    {
+        auto lk = std::unique_lock<std::mutex>(mtxToConditionalWait_);
+        cvarToWaitThread_.wait(lk, isRetrieved);
+    }
+    numWaiters_.fetch_sub(1, std::memory_order_relaxed);
+
+    if (collectStats_)
+    {
+        stats_.OnReaderWaited(GetTimeAsUs() - begin);
+    }
+}
+
+void MultiThreadCaptureController::OnFrameRead(uint64_t capturedTime, uint64_t skipped)
+{
+    if (collectStats_)
+    {
+        auto now = GetTimeAsUs();
+        stats_.OnRead((now > capturedTime) ? now - capturedTime : 0, skipped);
+    }
+}
+
+void MultiThreadCaptureController::RecordProducerWait(int idx_update)
+{
+    if (!collectStats_)
+    {
+        return;
+    }
+
+    if (idx_update == notApplicatable_)
+    {
+        // count a stall once, however many times the capture thread retries
+        if (stallBegin_ == 0)
+        {
+            stallBegin_ = GetTimeAsUs();
+            stats_.OnStalled();
+        }
+        return;
+    }
+
+    stats_.OnProducerWaited((stallBegin_ != 0) ? GetTimeAsUs() - stallBegin_ : 0);
+    stallBegin_ = 0;
+}
+
+void MultiThreadCaptureController::ApplySchedulingOptions(void)
+{
+    if (!cpuAffinity_.empty())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto cpu : cpuAffinity_)
+        {
+            CPU_SET(cpu, &cpus);
+        }
+
+        auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        isPinned_.store(ret == 0, std::memory_order_relaxed);
+        logMessage("D", "pin the capture thread to %d CPUs (%d)", static_cast<int>(cpuAffinity_.size()), ret);
+    }
+
+    if ((schedPolicy_ == SCHED_FIFO) || (schedPolicy_ == SCHED_RR))
+    {
+        // without CAP_SYS_NICE or RLIMIT_RTPRIO this fails with EPERM and the thread keeps the default policy
+        auto param = sched_param{};
+        param.sched_priority = schedPriority_;
+        auto ret = pthread_setschedparam(pthread_self(), schedPolicy_, &param);
+        if (ret == 0)
+        {
+            appliedPolicy_.store(schedPolicy_, std::memory_order_relaxed);
+            appliedPriority_.store(schedPriority_, std::memory_order_relaxed);
+        }
+        logMessage("D", "set the capture thread's policy to %d, priority %d (%d)", schedPolicy_, schedPriority_, ret);
+    }
+}
+
+void MultiThreadCaptureController::YieldToReaders(void)
+{
+    if (stream_ != nullptr)
+    {
+        // Step gives the worker to the other streams for a while
+        isYielding_ = true;
+        return;
+    }
+
+    // sleep until a reader gives a slot back, or the state changes
+    ring_.WaitForUnpin(isLossless_ ? queueHead_.load(std::memory_order_acquire) : UINT64_MAX);
+}
+
+void MultiThreadCaptureController::LockIndex(int idx)
+{
+    // the slot handed out by the previous read may be overwritten from now on
+    if (idx_locked_ != notApplicatable_)
+    {
+        ring_.Unpin(idx_locked_);
+    }
+    idx_locked_ = idx;
+}
+
+uint64_t MultiThreadCaptureController::GetTimeAsUs(void)
+{
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
 }
 
 
 /* ----- Debug Method ----- */
 
-std::tuple<int, int, int, int> MultiThreadCaptureController::__dbg_getindicies(void)
+std::tuple<int, int, int> MultiThreadCaptureController::__dbg_getindicies(void)
 {
-    return std::tuple<int, int, int, int>(idx_latest_, idx_previous_, idx_update_, idx_locked_);
+    auto [idx_latest, idx_update] = ring_.GetIndicies();
+    return std::tuple<int, int, int>(idx_latest, idx_update, idx_locked_);
 }
 
@@ -2,42 +2,125 @@
 #define  H__MULTI_THREAD_CAPTURE_CONTROLLER__H
 
 #include  <thread>
+#include  <atomic>
 #include  <mutex>
 #include  <condition_variable>
 #include  <chrono>
 #include  <cstdio>
+#include  <vector>
+#include  <memory>
+#include  <functional>
 #include  <cstdint>
+#include  <pthread.h>
+#include  <sched.h>
 #include  "ICapturable.hpp"
+#include  "FrameRing.hpp"
+#include  "FrameLease.hpp"
+#include  "FrameBufferPool.hpp"
+#include  "FrameConsumer.hpp"
+#include  "FrameAwaiter.hpp"
+#include  "FrameWindow.hpp"
+#include  "FrameWindowBuffer.hpp"
+#include  "FramePipeline.hpp"
+#include  "CaptureControllerConfig.hpp"
+#include  "CaptureStats.hpp"
+#include  "MotionGate.hpp"
+#include  "CaptureExecutor.hpp"
 
 class MultiThreadCaptureController
 {
+    friend class FrameConsumer;
+    friend class FrameAwaiter;
+    friend class MultiThreadCaptureGroup;
+
+    public:
+        enum class CaptureState : int
+        {
+            Idle,  // capture thread is parked until StartCapture
+            Active,  // capture thread is capturing
+            Quit,  // finished by FinishCapture or by the end of the source
+        };
+
+        static constexpr uint64_t InfiniteTimeout = UINT64_MAX;
+
+        using FrameCallback = std::function<void(const FrameLease&)>;
+
     private:
-        static constexpr int maxNumCaptureData_ = 4;
-        static constexpr int notApplicatable_ = -1;
+        struct FrameCallbackEntry
+        {
+            int Id;
+            FrameCallback Function;
+            FrameExecutor Executor;
+            uint64_t LastSequence;  // newest frame handed to the callback
+            std::atomic<bool> IsBusy;  // a call is running, frames published meanwhile are skipped
+            std::mutex MtxToWaitIdle;
+            std::condition_variable CvarToWaitIdle;  // signalled when a call finishes
+        };
 
-        bool isReady_;  // This will become true when initialization is success
-        bool isActive_;  // This will become true when getting the order to start capture
-        bool isQuit_;  // This will become true when getting the order to finish capture
+        static constexpr int notApplicatable_ = FrameRing::NotApplicatable;
+
+        std::atomic<CaptureState> state_;  // changed under mtxToSyncThread_, read lock-free by the capture thread
 
         std::mutex mtxToSyncThread_;
+        std::condition_variable cvarToWakeThread_;  // parks the capture thread while idle
         std::mutex mtxToConditionalWait_;
         std::condition_variable cvarToWaitThread_;  // conditional variable for thread waiting
+        std::atomic<int> numWaiters_;  // readers blocked on cvarToWaitThread_
 
         std::thread thread_;  // sub thread
         std::thread::id ownerThreadId_;  // main thread's ID 
         std::thread::id captureThreadId_;  // sub thread's ID
 
-        std::shared_ptr<CaptureDataObject> captureData_[maxNumCaptureData_];
-        uint64_t capturedTimes_[maxNumCaptureData_];
-        int idx_latest_;
-        int idx_previous_;
-        int idx_update_;
-        int idx_locked_;
+        CaptureExecutor* executor_;  // shared workers running the capture in place of thread_ (nullptr: none)
+        std::shared_ptr<CaptureExecutor::Stream> stream_;  // this controller on executor_, from Setup to FinishCapture
+        bool isYielding_;  // the last step found every slot held by readers, owned by the step
 
-        struct timespec ts_;
+        std::unique_ptr<FrameBufferPool> pool_;  // allocates the memory of the slots, which each slot keeps mapped
+        FrameRing ring_;  // history of captured frames with their time stamps and sequence numbers
+        int idx_locked_;  // slot pinned by the reader until the next Read
+        std::unique_ptr<FrameWindowBuffer> window_;  // packed copy of the last frames (nullptr: none)
+
+        std::mutex mtxToConsumers_;
+        std::vector<FrameConsumer*> consumers_;  // registered broadcast readers
+        int nextConsumerId_;
+
+        std::mutex mtxToAwaiters_;
+        std::vector<FrameAwaiter*> awaiters_;  // suspended coroutines, counted in numWaiters_ as well
+
+        std::mutex mtxToCallbacks_;
+        std::vector<std::shared_ptr<FrameCallbackEntry>> callbacks_;
+        std::atomic<int> numCallbacks_;
+        int nextCallbackId_;
+
+        std::unique_ptr<FramePipeline> pipeline_;  // post-capture stages (nullptr: none), destroyed before the ring it publishes to
+
+        CaptureStatsCollector stats_;
+        bool collectStats_;
+        uint64_t stallBegin_;  // [ns] since when every slot is held by readers (0: not stalled), owned by the capture thread (by the pipeline's commit with stages)
+
+        std::vector<int> cpuAffinity_;  // requested placement of the capture thread
+        int schedPolicy_;
+        int schedPriority_;
+        std::atomic<bool> isPinned_;  // placement applied by the capture thread
+        std::atomic<int> appliedPolicy_;
+        std::atomic<int> appliedPriority_;
+
+        std::unique_ptr<MotionGate> gate_;  // nullptr: every frame is published
+        uint64_t keepAlive_;
+
+        const bool isLossless_;  // the frames not dequeued yet are kept from being overwritten
+        const bool isQueueBlocking_;
+        const uint64_t queueDepth_;
+        alignas(64) std::atomic<uint64_t> queueHead_;  // sequence number of the frame dequeued last
+        std::atomic<bool> isQueueWaited_;  // the producer waits in AdmitToQueue
+        std::mutex mtxToQueue_;
+        std::condition_variable cvarToWaitQueue_;
+
+        bool isLazy_;  // grab every frame, retrieve only those readers wait for
+        std::atomic<uint64_t> grabbed_;  // frames grabbed in lazy mode
+        std::atomic<uint64_t> retrievedGrab_;  // grab number of the newest frame retrieved and published
 
-        int Length_;
-        int numBytesPerChannel_;
+        struct timespec ts_;
 
         ICapturable* cap_;  // User selected capture object
         bool disposeCaptureObejct_;
@@ -54,6 +137,9 @@ class MultiThreadCaptureController
 
         void Main(void);
 
+        // one turn of Main on a worker of executor_: returns when to run again (see CaptureExecutor)
+        uint64_t Step(void);
+
         bool Initialize(void);
 
         bool Action(void);
@@ -62,25 +148,72 @@ class MultiThreadCaptureController
 
         bool IsEnd(void);
 
-        bool IsReady(void);
+        void ChangeState(CaptureState state);
+
+        void WaitForActive(void);
 
         bool IsFirstCaptured(void);
 
-        void UpdateStateIndicies(void);
+        static int GetRingDepth(const CaptureControllerConfig& config);
+
+        static int GetRingCapacity(const CaptureControllerConfig& config);
 
         int GetUpdateIndex(void);
 
+        bool IsQueueFull(void);
+
+        // Lossless mode: room for the frame about to be published, waited for or not (false: drop the frame)
+        bool AdmitToQueue(void);
+
         int GetLatestIndex(void);
 
         int GetNearestIndex(uint64_t sync_time);
 
+        void LockIndex(int idx);
+
+        std::shared_ptr<CaptureDataObject> AllocateCaptureData(void);
+
+        void PackFrame(const CaptureDataObject* captureData);
+
+        bool IsStill(const CaptureDataObject* captureData, uint64_t time);
+
+        void UnregisterConsumer(FrameConsumer* consumer);
+
+        bool CaptureToPipeline(void);
+
+        bool PublishProcessed(std::shared_ptr<CaptureDataObject>& output, uint64_t capturedTime);
+
+        bool BorrowFromSource(void);
+
+        bool GrabFromSource(void);
+
+        void WaitForNewestGrab(void);
+
+        void OnFrameRead(uint64_t capturedTime, uint64_t skipped);
+
+        void RecordProducerWait(int idx_update);
+
+        void ApplySchedulingOptions(void);
+
+        void YieldToReaders(void);
+
         void WaitForReady(void);
 
+        bool WaitForSequence(uint64_t lastSequence, uint64_t timeout);
+
         void OnCaptureReady(void);
 
-        uint64_t GetTimeAsUs(void);
+        bool Suspend(FrameAwaiter* awaiter);
+
+        void ResumeAwaiters(void);
 
-        void __logMessage(int line, const char* str, const char* fmt, ...);
+        void DeliverToCallbacks(void);
+
+        static void EndCallback(FrameCallbackEntry* callback);
+
+        static void WaitForCallback(FrameCallbackEntry* callback);
+
+        uint64_t GetTimeAsUs(void);
 
     public:
 
@@ -90,6 +223,13 @@ class MultiThreadCaptureController
             bool isDebug = false
         );
 
+        MultiThreadCaptureController(
+            ICapturable* cap,
+            bool disposeCaptureObejct,
+            const CaptureControllerConfig& config,
+            bool isDebug = false
+        );
+
         ~MultiThreadCaptureController();
 
         bool Setup(void);
@@ -100,11 +240,66 @@ class MultiThreadCaptureController
 
         bool FinishCapture(void);
 
+        CaptureState GetState(void);
+
+        // the newest frame, written over once the next Read releases it; the memory stays valid while the object
+        // is held, even after the controller is destroyed
         std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t> Read(void);
 
         std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t> ReadWithSync(uint64_t sync_time);   
 
-        std::tuple<int, int, int, int> __dbg_getindicies(void);
+        // (data, time stamp, sequence, frames skipped since lastSequence); data is nullptr on timeout [ns] or end of capture
+        std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t, uint64_t, uint64_t> ReadNext(uint64_t lastSequence, uint64_t timeout = InfiniteTimeout);
+
+        uint64_t GetReadSequence(void);
+
+        // leases keep their frame from being overwritten until released, from any number of threads
+        FrameLease Lease(void);
+
+        FrameLease LeaseNext(uint64_t lastSequence, uint64_t timeout = InfiniteTimeout);
+
+        FrameLease LeaseWithSync(uint64_t sync_time);
+
+        // Lossless mode: the oldest frame not dequeued yet, for one reader thread; frames queued before the end of
+        // capture are still handed out. Invalid lease on timeout [ns], at the end of the queue or in LatestOnly mode
+        FrameLease Dequeue(uint64_t timeout = InfiniteTimeout);
+
+        // the length newest consecutive frames, pinned together (length below the ring depth); packed, they are also
+        // handed out back to back from the buffer of PackedWindowCapacity frames if none of them was missed there
+        FrameWindow ReadWindow(int length, bool isPacked = false);
+
+        // co_await controller.NextFrame(lastSequence) gives what LeaseNext(lastSequence) would, without blocking a thread
+        FrameAwaiter NextFrame(uint64_t lastSequence, FrameExecutor executor = nullptr);
+
+        // calls callback with each new frame on the publishing thread, or on executor; a callback still running when
+        // the next frame comes skips that frame. Callbacks must not add or remove callbacks themselves
+        int OnFrame(FrameCallback callback, FrameExecutor executor = nullptr);
+
+        // returns after a call in flight has finished
+        bool RemoveFrameCallback(int id);
+
+        int GetNumCaptureData(void);
+
+        FrameFormat GetFormat(void);
+
+        uint64_t GetBytesHeld(void);
+
+        // frames processed by the stages and frames dropped because a stage failed or every slot was leased
+        uint64_t GetNumProcessed(void);
+
+        uint64_t GetNumDropped(void);
+
+        // broadcast reader with its own cursor, receiving the frames published from now on
+        std::unique_ptr<FrameConsumer> RegisterConsumer(void);
+
+        std::vector<FrameConsumerStats> GetConsumerStats(void);
+
+        // counters and histograms since construction or the last reset; with reset, they restart from zero
+        CaptureStats GetStats(bool reset = false);
+
+        void ResetStats(void);
+
+        std::tuple<int, int, int> __dbg_getindicies(void);
 };
 
 #endif  /* H__MULTI_THREAD_CAPTURE_CONTROLLER__H */
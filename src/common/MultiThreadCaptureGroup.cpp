@@ -0,0 +1,189 @@
+#include  "MultiThreadCaptureGroup.hpp"
+#include  <algorithm>
+#include  <chrono>
+#include  "Ensuring.hpp"
+
+
+/* ----- Public ----- */
+
+MultiThreadCaptureGroup::MultiThreadCaptureGroup(
+    const std::vector<ICapturable*>& caps,
+    bool disposeCaptureObejct,
+    const CaptureGroupConfig& config,
+    bool isDebug
+) :
+    skewTolerance_(config.SkewTolerance), timeout_(config.Timeout), rejected_(0)
+{
+    ThrowExceptionIfZero(caps.size());
+
+    for (auto cap : caps)
+    {
+        controllers_.emplace_back(new MultiThreadCaptureController(cap, disposeCaptureObejct, config.Controller, isDebug));
+    }
+
+    stats_.resize(controllers_.size());
+    lastSequences_.resize(controllers_.size(), 0);
+}
+
+MultiThreadCaptureGroup::~MultiThreadCaptureGroup()
+{
+}
+
+bool MultiThreadCaptureGroup::Setup(void)
+{
+    auto ret = true;
+    for (auto& controller : controllers_)
+    {
+        ret &= controller->Setup();
+    }
+    return ret;
+}
+
+bool MultiThreadCaptureGroup::StartCapture(void)
+{
+    auto ret = true;
+    for (auto& controller : controllers_)
+    {
+        ret &= controller->StartCapture();
+    }
+    return ret;
+}
+
+bool MultiThreadCaptureGroup::StopCapture(void)
+{
+    auto ret = true;
+    for (auto& controller : controllers_)
+    {
+        ret &= controller->StopCapture();
+    }
+    return ret;
+}
+
+bool MultiThreadCaptureGroup::FinishCapture(void)
+{
+    auto ret = true;
+    for (auto& controller : controllers_)
+    {
+        ret &= controller->FinishCapture();
+    }
+    return ret;
+}
+
+std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>> MultiThreadCaptureGroup::Read(void)
+{
+    auto frameSet = std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>>(controllers_.size());
+    auto begin = std::chrono::steady_clock::now();
+    auto getRemaining = [this, begin]{
+        if (timeout_ == MultiThreadCaptureController::InfiniteTimeout) { return timeout_; }
+        auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+        return (elapsed < timeout_) ? timeout_ - elapsed : 0;
+    };
+
+    while (true)
+    {
+        // newest frame of every source; the oldest of them becomes the reference time
+        auto referenceTime = UINT64_MAX;
+        size_t idx_reference = 0;
+        for (size_t idx = 0; idx < controllers_.size(); ++idx)
+        {
+            // Read blocks until the source's first frame, which a source that never starts would never bring
+            if (!controllers_[idx]->WaitForSequence(0, getRemaining())) { return {}; }
+
+            frameSet[idx] = controllers_[idx]->Read();
+            if (std::get<0>(frameSet[idx]) == nullptr) { return {}; }
+
+            if (std::get<1>(frameSet[idx]) < referenceTime)
+            {
+                referenceTime = std::get<1>(frameSet[idx]);
+                idx_reference = idx;
+            }
+        }
+
+        auto isEnd = false;
+        if (TryAlign(frameSet, referenceTime, &isEnd))
+        {
+            UpdateStats(frameSet, referenceTime);
+            return frameSet;
+        }
+
+        if (isEnd) { return {}; }
+
+        // a source has no frame close enough yet, sleep until the slowest source moves the reference time on
+        ++rejected_;
+        auto remaining = getRemaining();
+        if (remaining == 0) { return {}; }
+
+        auto& reference = controllers_[idx_reference];
+        if (!reference->WaitForSequence(reference->GetReadSequence(), remaining)) { return {}; }
+    }
+}
+
+std::vector<CaptureGroupSourceStats> MultiThreadCaptureGroup::GetStats(void) const
+{
+    return stats_;
+}
+
+uint64_t MultiThreadCaptureGroup::GetRejected(void) const
+{
+    return rejected_;
+}
+
+int MultiThreadCaptureGroup::GetNumSources(void) const
+{
+    return static_cast<int>(controllers_.size());
+}
+
+
+/* ----- Private ----- */
+
+bool MultiThreadCaptureGroup::TryAlign(std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>>& frameSet, uint64_t referenceTime, bool* isEnd)
+{
+    auto isAligned = true;
+
+    for (size_t idx = 0; idx < controllers_.size(); ++idx)
+    {
+        if (std::get<1>(frameSet[idx]) - referenceTime <= skewTolerance_) { continue; }
+
+        // look back in the history of the sources ahead of the reference
+        frameSet[idx] = controllers_[idx]->ReadWithSync(referenceTime);
+        if (std::get<0>(frameSet[idx]) == nullptr)
+        {
+            *isEnd = true;
+            return false;
+        }
+
+        auto time = std::get<1>(frameSet[idx]);
+        auto skew = (time < referenceTime) ? referenceTime - time : time - referenceTime;
+        isAligned &= (skew <= skewTolerance_);
+    }
+
+    return isAligned;
+}
+
+void MultiThreadCaptureGroup::UpdateStats(const std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>>& frameSet, uint64_t referenceTime)
+{
+    for (size_t idx = 0; idx < controllers_.size(); ++idx)
+    {
+        auto& stats = stats_[idx];
+        auto sequence = controllers_[idx]->GetReadSequence();
+        auto time = std::get<1>(frameSet[idx]);
+
+        if (sequence == lastSequences_[idx])
+        {
+            ++stats.Repeated;
+        }
+        else if ((lastSequences_[idx] != 0) && (sequence > lastSequences_[idx] + 1))
+        {
+            stats.Dropped += sequence - lastSequences_[idx] - 1;
+        }
+        lastSequences_[idx] = sequence;
+
+        auto skew = static_cast<int64_t>(time - referenceTime);
+        auto absSkew = static_cast<uint64_t>((skew < 0) ? -skew : skew);
+
+        ++stats.Delivered;
+        stats.LastSkew = skew;
+        stats.MaxSkew = std::max(stats.MaxSkew, absSkew);
+        stats.SumSkew += absSkew;
+    }
+}
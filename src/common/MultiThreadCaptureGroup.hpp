@@ -0,0 +1,85 @@
+#ifndef  H__MULTI_THREAD_CAPTURE_GROUP__H
+#define  H__MULTI_THREAD_CAPTURE_GROUP__H
+
+#include  <vector>
+#include  <memory>
+#include  <tuple>
+#include  <cstdint>
+#include  "ICapturable.hpp"
+#include  "MultiThreadCaptureController.hpp"
+
+// Options given to MultiThreadCaptureGroup at construction
+struct CaptureGroupConfig
+{
+    uint64_t SkewTolerance = 5000000;  // [ns] allowed distance of each frame from the reference time
+
+    uint64_t Timeout = 100000000;  // [ns] how long Read waits for an aligned set
+
+    CaptureControllerConfig Controller;  // applied to the controller of every source
+};
+
+// Alignment statistics of one source in the group
+struct CaptureGroupSourceStats
+{
+    uint64_t Delivered = 0;  // frames handed out in a frame set
+
+    uint64_t Dropped = 0;  // frames captured but skipped between two frame sets
+
+    uint64_t Repeated = 0;  // frame sets reusing the frame of the previous set
+
+    int64_t LastSkew = 0;  // [ns] captured time - reference time in the last frame set
+
+    uint64_t MaxSkew = 0;  // [ns]
+
+    uint64_t SumSkew = 0;  // [ns] sum of |skew|, divide by Delivered for the mean
+};
+
+// Runs one MultiThreadCaptureController per source and reads them as time-aligned frame sets.
+//
+// The reference time of a set is the newest frame of the slowest source,
+// and every other source contributes the frame nearest to it from its history ring.
+// Frames stay in (and pinned by) their controller's ring until the next Read, so no copy is made.
+class MultiThreadCaptureGroup
+{
+    private:
+        std::vector<std::unique_ptr<MultiThreadCaptureController>> controllers_;
+        std::vector<CaptureGroupSourceStats> stats_;
+        std::vector<uint64_t> lastSequences_;
+
+        uint64_t skewTolerance_;
+        uint64_t timeout_;
+        uint64_t rejected_;  // attempts discarded because a source was out of tolerance
+
+        bool TryAlign(std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>>& frameSet, uint64_t referenceTime, bool* isEnd);
+
+        void UpdateStats(const std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>>& frameSet, uint64_t referenceTime);
+
+    public:
+        MultiThreadCaptureGroup(
+            const std::vector<ICapturable*>& caps,
+            bool disposeCaptureObejct,
+            const CaptureGroupConfig& config = CaptureGroupConfig{},
+            bool isDebug = false
+        );
+
+        ~MultiThreadCaptureGroup();
+
+        bool Setup(void);
+
+        bool StartCapture(void);
+
+        bool StopCapture(void);
+
+        bool FinishCapture(void);
+
+        // one frame per source in the order given at construction; empty on end of capture or timeout
+        std::vector<std::tuple<std::shared_ptr<CaptureDataObject>, uint64_t>> Read(void);
+
+        std::vector<CaptureGroupSourceStats> GetStats(void) const;
+
+        uint64_t GetRejected(void) const;
+
+        int GetNumSources(void) const;
+};
+
+#endif  /* H__MULTI_THREAD_CAPTURE_GROUP__H */
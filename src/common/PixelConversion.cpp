@@ -0,0 +1,214 @@
+#include  "PixelConversion.hpp"
+#include  <atomic>
+#include  "PixelKernels.hpp"
+
+
+static const PixelKernels* GetKernelsOf(PixelIsa isa)
+{
+    switch (isa)
+    {
+        case PixelIsa::Avx2: return Avx2PixelKernels;
+        case PixelIsa::Sse41: return Sse41PixelKernels;
+        case PixelIsa::Neon: return NeonPixelKernels;
+        default: return &ScalarPixelKernels;
+    }
+}
+
+static std::atomic<PixelIsa>& GetSelectedIsa(void)
+{
+    static std::atomic<PixelIsa> isa(PixelConversion::GetBestIsa());
+    return isa;
+}
+
+static bool IsSameShape(const FrameFormat& a, const FrameFormat& b)
+{
+    return (a.Width == b.Width) && (a.Height == b.Height) && (a.NumChannels == b.NumChannels)
+        && (a.NumBytesPerChannel == b.NumBytesPerChannel) && (a.IsPlanar == b.IsPlanar);
+}
+
+
+/* ----- Public ----- */
+
+FrameFormat PixelConversion::GetOutputFormat(PixelConversionType type, const FrameFormat& input)
+{
+    if (!IsConvertible(type, input))
+    {
+        throw new std::exception();
+    }
+
+    auto output = input;
+    output.Stride = 0;
+
+    switch (type)
+    {
+        case PixelConversionType::BgrToGray:
+            output.NumChannels = 1;
+            break;
+        case PixelConversionType::BgrToPlanar:
+            output.IsPlanar = true;
+            break;
+        case PixelConversionType::YuyvToBgr:
+            output.NumChannels = 3;
+            break;
+        case PixelConversionType::U8ToF32:
+            output.NumBytesPerChannel = sizeof(float);
+            break;
+        case PixelConversionType::BgrToRgbPlanarF32:
+            output.NumBytesPerChannel = sizeof(float);
+            output.IsPlanar = true;
+            break;
+        default:
+            break;
+    }
+
+    return output;
+}
+
+bool PixelConversion::IsConvertible(PixelConversionType type, const FrameFormat& input)
+{
+    if ((input.NumBytesPerChannel != 1) || input.IsPlanar || (input.Width == 0) || (input.Height == 0))
+    {
+        return false;
+    }
+
+    switch (type)
+    {
+        case PixelConversionType::YuyvToBgr:
+            return (input.NumChannels == 2) && (input.Width % 2 == 0);
+        case PixelConversionType::U8ToF32:
+            return (input.NumChannels >= 1) && (input.NumChannels <= MaxNumChannels);
+        default:
+            return input.NumChannels == 3;
+    }
+}
+
+bool PixelConversion::Convert(
+    PixelConversionType type,
+    const CaptureDataObject* input,
+    const CaptureDataObject* output,
+    const float* mean,
+    const float* scale
+)
+{
+    static_assert(MaxNumChannels == 4, "the SIMD kernels keep one vector of means per channel");
+
+    if ((input == nullptr) || (output == nullptr) || !IsConvertible(type, input->Format))
+    {
+        return false;
+    }
+
+    auto& in = input->Format;
+    auto& out = output->Format;
+    if (!IsSameShape(out, GetOutputFormat(type, in)))
+    {
+        return false;
+    }
+
+    static constexpr float zeros[MaxNumChannels] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    static constexpr float ones[MaxNumChannels] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    mean = (mean != nullptr) ? mean : zeros;
+    scale = (scale != nullptr) ? scale : ones;
+
+    auto kernels = GetKernelsOf(GetIsa());
+    auto src = static_cast<const uint8_t*>(input->Data);
+    auto dst = static_cast<uint8_t*>(const_cast<void*>(output->Data));
+    auto srcStride = in.GetStride();
+    auto dstStride = out.GetStride();
+    auto sizeOfPlane = dstStride * out.Height;
+    auto width = in.Width;
+
+    // one pass per row, so padded rows never reach the kernels
+    for (uint32_t y = 0; y < in.Height; ++y, src += srcStride, dst += dstStride)
+    {
+        switch (type)
+        {
+            case PixelConversionType::BgrToRgb:
+                kernels->BgrToRgb(src, dst, width);
+                break;
+            case PixelConversionType::BgrToGray:
+                kernels->BgrToGray(src, dst, width);
+                break;
+            case PixelConversionType::BgrToPlanar:
+                kernels->BgrToPlanar(src, dst, dst + sizeOfPlane, dst + 2 * sizeOfPlane, width);
+                break;
+            case PixelConversionType::YuyvToBgr:
+                kernels->YuyvToBgr(src, dst, width);
+                break;
+            case PixelConversionType::U8ToF32:
+                kernels->U8ToF32(src, reinterpret_cast<float*>(dst), width, in.NumChannels, mean, scale);
+                break;
+            case PixelConversionType::BgrToRgbPlanarF32:
+                kernels->BgrToRgbPlanarF32(
+                    src,
+                    reinterpret_cast<float*>(dst),
+                    reinterpret_cast<float*>(dst + sizeOfPlane),
+                    reinterpret_cast<float*>(dst + 2 * sizeOfPlane),
+                    width, mean, scale
+                );
+                break;
+        }
+    }
+
+    return true;
+}
+
+uint64_t PixelConversion::SumOfAbsDiff(const uint8_t* a, const uint8_t* b, size_t numBytes)
+{
+    return GetKernelsOf(GetIsa())->SumOfAbsDiff(a, b, numBytes);
+}
+
+PixelIsa PixelConversion::GetIsa(void)
+{
+    return GetSelectedIsa().load(std::memory_order_relaxed);
+}
+
+PixelIsa PixelConversion::GetBestIsa(void)
+{
+    if (IsSupported(PixelIsa::Avx2)) { return PixelIsa::Avx2; }
+    if (IsSupported(PixelIsa::Sse41)) { return PixelIsa::Sse41; }
+    if (IsSupported(PixelIsa::Neon)) { return PixelIsa::Neon; }
+    return PixelIsa::Scalar;
+}
+
+bool PixelConversion::IsSupported(PixelIsa isa)
+{
+    if (GetKernelsOf(isa) == nullptr)
+    {
+        // not built for this architecture
+        return false;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    switch (isa)
+    {
+        case PixelIsa::Avx2: return __builtin_cpu_supports("avx2");
+        case PixelIsa::Sse41: return __builtin_cpu_supports("sse4.1");
+        default: return true;
+    }
+#else
+    // NEON is part of every AArch64 core
+    return true;
+#endif
+}
+
+bool PixelConversion::SetIsa(PixelIsa isa)
+{
+    if (!IsSupported(isa))
+    {
+        return false;
+    }
+
+    GetSelectedIsa().store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+const char* PixelConversion::GetIsaName(PixelIsa isa)
+{
+    switch (isa)
+    {
+        case PixelIsa::Avx2: return "AVX2";
+        case PixelIsa::Sse41: return "SSE4.1";
+        case PixelIsa::Neon: return "NEON";
+        default: return "Scalar";
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef  H__PIXEL_CONVERSION__H
+#define  H__PIXEL_CONVERSION__H
+
+#include  <cstddef>
+#include  <cstdint>
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+
+enum class PixelConversionType : int
+{
+    BgrToRgb,  // 8-bit BGR -> 8-bit RGB
+    BgrToGray,  // 8-bit BGR -> 8-bit gray (BT.601, same rounding as cv::cvtColor)
+    BgrToPlanar,  // 8-bit packed BGR -> 8-bit planar B, G, R
+    YuyvToBgr,  // YUYV 4:2:2 (2 channels per pixel) -> 8-bit BGR (BT.601 limited range)
+    U8ToF32,  // 8-bit -> float, (x - mean[c]) * scale[c] per channel
+    BgrToRgbPlanarF32,  // 8-bit packed BGR -> float planar R, G, B normalized in one pass
+};
+
+enum class PixelIsa : int
+{
+    Scalar,
+    Sse41,
+    Avx2,
+    Neon,
+};
+
+// Vectorized pixel format conversion working on CaptureDataObject buffers.
+//
+// The kernels are chosen at runtime from the instruction sets of the CPU (AVX2, SSE4.1, NEON or plain C++)
+// and give the same result whichever one runs. Rows may be padded (FrameFormat::Stride) on both sides.
+class PixelConversion
+{
+    public:
+        static constexpr uint32_t MaxNumChannels = 4;  // mean and scale hold one value per channel
+
+        // format of the output of the given conversion; throws if the input cannot be converted
+        static FrameFormat GetOutputFormat(PixelConversionType type, const FrameFormat& input);
+
+        static bool IsConvertible(PixelConversionType type, const FrameFormat& input);
+
+        // output must have the format given by GetOutputFormat (its stride may differ);
+        // mean and scale are used by the float conversions only, in the order of the output channels (nullptr: 0 and 1)
+        static bool Convert(
+            PixelConversionType type,
+            const CaptureDataObject* input,
+            const CaptureDataObject* output,
+            const float* mean = nullptr,
+            const float* scale = nullptr
+        );
+
+        // sum of |a - b| over numBytes bytes, with the same kernels as Convert
+        static uint64_t SumOfAbsDiff(const uint8_t* a, const uint8_t* b, size_t numBytes);
+
+        static PixelIsa GetIsa(void);
+
+        // best instruction set the CPU supports
+        static PixelIsa GetBestIsa(void);
+
+        static bool IsSupported(PixelIsa isa);
+
+        // select the kernels for every thread, e.g. to compare them; false if the CPU lacks isa
+        static bool SetIsa(PixelIsa isa);
+
+        static const char* GetIsaName(PixelIsa isa);
+};
+
+#endif  // H__PIXEL_CONVERSION__H
@@ -0,0 +1,40 @@
+#ifndef  H__PIXEL_CONVERSION_STAGE__H
+#define  H__PIXEL_CONVERSION_STAGE__H
+
+#include  <array>
+#include  "IFrameStage.hpp"
+#include  "PixelConversion.hpp"
+
+// IFrameStage running one PixelConversion, e.g. BgrToRgbPlanarF32 to feed a model straight from the capture
+class PixelConversionStage : public IFrameStage
+{
+    public:
+        using Channels = std::array<float, PixelConversion::MaxNumChannels>;
+
+    private:
+        const PixelConversionType type_;
+        const Channels mean_;
+        const Channels scale_;
+
+    public:
+        explicit PixelConversionStage(
+            PixelConversionType type,
+            const Channels& mean = Channels{ 0.0f, 0.0f, 0.0f, 0.0f },
+            const Channels& scale = Channels{ 1.0f, 1.0f, 1.0f, 1.0f }
+        )
+            : type_(type), mean_(mean), scale_(scale)
+        {
+        }
+
+        FrameFormat GetOutputFormat(const FrameFormat& input) override
+        {
+            return PixelConversion::GetOutputFormat(type_, input);
+        }
+
+        bool Process(const CaptureDataObject* input, const CaptureDataObject* output) override
+        {
+            return PixelConversion::Convert(type_, input, output, mean_.data(), scale_.data());
+        }
+};
+
+#endif  // H__PIXEL_CONVERSION_STAGE__H
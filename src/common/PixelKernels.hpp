@@ -0,0 +1,52 @@
+#ifndef  H__PIXEL_KERNELS__H
+#define  H__PIXEL_KERNELS__H
+
+#include  <cstddef>
+#include  <cstdint>
+
+// Row kernels behind PixelConversion, one table per instruction set.
+// Every kernel converts numPixels pixels of one row and handles the tail itself.
+struct PixelKernels
+{
+    void (*BgrToRgb)(const uint8_t* src, uint8_t* dst, size_t numPixels);
+
+    void (*BgrToGray)(const uint8_t* src, uint8_t* dst, size_t numPixels);
+
+    void (*BgrToPlanar)(const uint8_t* src, uint8_t* dst0, uint8_t* dst1, uint8_t* dst2, size_t numPixels);
+
+    // numPixels is even
+    void (*YuyvToBgr)(const uint8_t* src, uint8_t* dst, size_t numPixels);
+
+    // numChannels is at most PixelConversion::MaxNumChannels
+    void (*U8ToF32)(const uint8_t* src, float* dst, size_t numPixels, int numChannels, const float* mean, const float* scale);
+
+    void (*BgrToRgbPlanarF32)(const uint8_t* src, float* dstR, float* dstG, float* dstB, size_t numPixels, const float* mean, const float* scale);
+
+    // sum of |a - b| over numBytes bytes
+    uint64_t (*SumOfAbsDiff)(const uint8_t* a, const uint8_t* b, size_t numBytes);
+};
+
+// fixed-point coefficients shared by every kernel, the ones cv::cvtColor uses for 8-bit images
+namespace PixelCoefficients
+{
+    constexpr int GrayShift = 14;
+    constexpr int GrayB = 1868;
+    constexpr int GrayG = 9617;
+    constexpr int GrayR = 4899;
+
+    constexpr int YuvShift = 20;
+    constexpr int YuvY = 1220542;
+    constexpr int YuvUB = 2116026;
+    constexpr int YuvUG = -409993;
+    constexpr int YuvVG = -852492;
+    constexpr int YuvVR = 1673527;
+}
+
+extern const PixelKernels ScalarPixelKernels;
+
+// nullptr when not built for this architecture
+extern const PixelKernels* const Sse41PixelKernels;
+extern const PixelKernels* const Avx2PixelKernels;
+extern const PixelKernels* const NeonPixelKernels;
+
+#endif  // H__PIXEL_KERNELS__H
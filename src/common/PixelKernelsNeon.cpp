@@ -0,0 +1,260 @@
+#include  "PixelKernels.hpp"
+
+#if defined(__ARM_NEON)
+
+#include  <arm_neon.h>
+
+using namespace PixelCoefficients;
+
+
+/* ----- Helpers ----- */
+
+// gray of 8 pixels
+static inline uint8x8_t GrayOf8(uint8x8_t b, uint8x8_t g, uint8x8_t r)
+{
+    auto b16 = vmovl_u8(b);
+    auto g16 = vmovl_u8(g);
+    auto r16 = vmovl_u8(r);
+
+    auto lo = vdupq_n_u32(1 << (GrayShift - 1));
+    lo = vmlal_n_u16(lo, vget_low_u16(b16), GrayB);
+    lo = vmlal_n_u16(lo, vget_low_u16(g16), GrayG);
+    lo = vmlal_n_u16(lo, vget_low_u16(r16), GrayR);
+
+    auto hi = vdupq_n_u32(1 << (GrayShift - 1));
+    hi = vmlal_n_u16(hi, vget_high_u16(b16), GrayB);
+    hi = vmlal_n_u16(hi, vget_high_u16(g16), GrayG);
+    hi = vmlal_n_u16(hi, vget_high_u16(r16), GrayR);
+
+    return vqmovn_u16(vcombine_u16(vshrn_n_u32(lo, GrayShift), vshrn_n_u32(hi, GrayShift)));
+}
+
+// BT.601 of 4 pixels held as int32, saturated to int16
+static inline void YuvToBgr4(int32x4_t y, int32x4_t u, int32x4_t v, int16x4_t* b, int16x4_t* g, int16x4_t* r)
+{
+    y = vmulq_n_s32(vmaxq_s32(vsubq_s32(y, vdupq_n_s32(16)), vdupq_n_s32(0)), YuvY);
+    y = vaddq_s32(y, vdupq_n_s32(1 << (YuvShift - 1)));
+    u = vsubq_s32(u, vdupq_n_s32(128));
+    v = vsubq_s32(v, vdupq_n_s32(128));
+
+    *b = vqmovn_s32(vshrq_n_s32(vmlaq_n_s32(y, u, YuvUB), YuvShift));
+    *g = vqmovn_s32(vshrq_n_s32(vmlaq_n_s32(vmlaq_n_s32(y, v, YuvVG), u, YuvUG), YuvShift));
+    *r = vqmovn_s32(vshrq_n_s32(vmlaq_n_s32(y, v, YuvVR), YuvShift));
+}
+
+static inline int32x4_t WidenLow(uint16x8_t value)
+{
+    return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(value)));
+}
+
+static inline int32x4_t WidenHigh(uint16x8_t value)
+{
+    return vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(value)));
+}
+
+// BGR of 8 pixels sharing the chroma of their pair
+static inline void YuvToBgr8(uint8x8_t y, uint8x8_t u, uint8x8_t v, uint8x8_t* b, uint8x8_t* g, uint8x8_t* r)
+{
+    auto y16 = vmovl_u8(y);
+    auto u16 = vmovl_u8(u);
+    auto v16 = vmovl_u8(v);
+
+    int16x4_t b0, g0, r0, b1, g1, r1;
+    YuvToBgr4(WidenLow(y16), WidenLow(u16), WidenLow(v16), &b0, &g0, &r0);
+    YuvToBgr4(WidenHigh(y16), WidenHigh(u16), WidenHigh(v16), &b1, &g1, &r1);
+
+    *b = vqmovun_s16(vcombine_s16(b0, b1));
+    *g = vqmovun_s16(vcombine_s16(g0, g1));
+    *r = vqmovun_s16(vcombine_s16(r0, r1));
+}
+
+static inline float32x4_t ToFloat(uint16x4_t value, float32x4_t mean, float32x4_t scale)
+{
+    return vmulq_f32(vsubq_f32(vcvtq_f32_u32(vmovl_u16(value)), mean), scale);
+}
+
+// 16 bytes into 16 floats with one mean and scale
+static inline void ConvertStore16(uint8x16_t value, float32x4_t mean, float32x4_t scale, float* dst)
+{
+    auto lo = vmovl_u8(vget_low_u8(value));
+    auto hi = vmovl_u8(vget_high_u8(value));
+
+    vst1q_f32(dst, ToFloat(vget_low_u16(lo), mean, scale));
+    vst1q_f32(dst + 4, ToFloat(vget_high_u16(lo), mean, scale));
+    vst1q_f32(dst + 8, ToFloat(vget_low_u16(hi), mean, scale));
+    vst1q_f32(dst + 12, ToFloat(vget_high_u16(hi), mean, scale));
+}
+
+
+/* ----- Kernels ----- */
+
+static void BgrToRgbNeon(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48, dst += 48)
+    {
+        auto bgr = vld3q_u8(src);
+        auto rgb = uint8x16x3_t{ { bgr.val[2], bgr.val[1], bgr.val[0] } };
+        vst3q_u8(dst, rgb);
+    }
+
+    ScalarPixelKernels.BgrToRgb(src, dst, numPixels - idx);
+}
+
+static void BgrToGrayNeon(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        auto bgr = vld3q_u8(src);
+
+        auto lo = GrayOf8(vget_low_u8(bgr.val[0]), vget_low_u8(bgr.val[1]), vget_low_u8(bgr.val[2]));
+        auto hi = GrayOf8(vget_high_u8(bgr.val[0]), vget_high_u8(bgr.val[1]), vget_high_u8(bgr.val[2]));
+        vst1q_u8(dst + idx, vcombine_u8(lo, hi));
+    }
+
+    ScalarPixelKernels.BgrToGray(src, dst + idx, numPixels - idx);
+}
+
+static void BgrToPlanarNeon(const uint8_t* src, uint8_t* dst0, uint8_t* dst1, uint8_t* dst2, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        auto bgr = vld3q_u8(src);
+        vst1q_u8(dst0 + idx, bgr.val[0]);
+        vst1q_u8(dst1 + idx, bgr.val[1]);
+        vst1q_u8(dst2 + idx, bgr.val[2]);
+    }
+
+    ScalarPixelKernels.BgrToPlanar(src, dst0 + idx, dst1 + idx, dst2 + idx, numPixels - idx);
+}
+
+static void YuyvToBgrNeon(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 32, dst += 48)
+    {
+        // Y0 U Y1 V of 8 pixel pairs
+        auto yuyv = vld4_u8(src);
+
+        uint8x8_t b0, g0, r0, b1, g1, r1;
+        YuvToBgr8(yuyv.val[0], yuyv.val[1], yuyv.val[3], &b0, &g0, &r0);
+        YuvToBgr8(yuyv.val[2], yuyv.val[1], yuyv.val[3], &b1, &g1, &r1);
+
+        // even and odd pixels back into order
+        auto b = vzip_u8(b0, b1);
+        auto g = vzip_u8(g0, g1);
+        auto r = vzip_u8(r0, r1);
+        auto bgr = uint8x16x3_t{ {
+            vcombine_u8(b.val[0], b.val[1]),
+            vcombine_u8(g.val[0], g.val[1]),
+            vcombine_u8(r.val[0], r.val[1]),
+        } };
+        vst3q_u8(dst, bgr);
+    }
+
+    ScalarPixelKernels.YuyvToBgr(src, dst, numPixels - idx);
+}
+
+static void U8ToF32Neon(const uint8_t* src, float* dst, size_t numPixels, int numChannels, const float* mean, const float* scale)
+{
+    // lane j of vector k holds channel (4k + j) % numChannels, a pattern repeating every numChannels vectors
+    float32x4_t means[4], scales[4];
+    for (int k = 0; k < numChannels; ++k)
+    {
+        float m[4], s[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            m[j] = mean[(4 * k + j) % numChannels];
+            s[j] = scale[(4 * k + j) % numChannels];
+        }
+        means[k] = vld1q_f32(m);
+        scales[k] = vld1q_f32(s);
+    }
+
+    auto numValues = numPixels * numChannels;
+    auto sizeOfBlock = static_cast<size_t>(16 * numChannels);
+
+    size_t idx = 0;
+    for (; idx + sizeOfBlock <= numValues; idx += sizeOfBlock)
+    {
+        for (int m = 0; m < numChannels; ++m)
+        {
+            auto value = vld1q_u8(src + idx + 16 * m);
+            auto lo = vmovl_u8(vget_low_u8(value));
+            auto hi = vmovl_u8(vget_high_u8(value));
+            auto out = dst + idx + 16 * m;
+
+            auto k0 = (4 * m) % numChannels;
+            auto k1 = (4 * m + 1) % numChannels;
+            auto k2 = (4 * m + 2) % numChannels;
+            auto k3 = (4 * m + 3) % numChannels;
+
+            vst1q_f32(out, ToFloat(vget_low_u16(lo), means[k0], scales[k0]));
+            vst1q_f32(out + 4, ToFloat(vget_high_u16(lo), means[k1], scales[k1]));
+            vst1q_f32(out + 8, ToFloat(vget_low_u16(hi), means[k2], scales[k2]));
+            vst1q_f32(out + 12, ToFloat(vget_high_u16(hi), means[k3], scales[k3]));
+        }
+    }
+
+    ScalarPixelKernels.U8ToF32(src + idx, dst + idx, numPixels - idx / numChannels, numChannels, mean, scale);
+}
+
+static void BgrToRgbPlanarF32Neon(const uint8_t* src, float* dstR, float* dstG, float* dstB, size_t numPixels, const float* mean, const float* scale)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        auto bgr = vld3q_u8(src);
+
+        ConvertStore16(bgr.val[2], vdupq_n_f32(mean[0]), vdupq_n_f32(scale[0]), dstR + idx);
+        ConvertStore16(bgr.val[1], vdupq_n_f32(mean[1]), vdupq_n_f32(scale[1]), dstG + idx);
+        ConvertStore16(bgr.val[0], vdupq_n_f32(mean[2]), vdupq_n_f32(scale[2]), dstB + idx);
+    }
+
+    ScalarPixelKernels.BgrToRgbPlanarF32(src, dstR + idx, dstG + idx, dstB + idx, numPixels - idx, mean, scale);
+}
+
+static uint64_t SumOfAbsDiffNeon(const uint8_t* a, const uint8_t* b, size_t numBytes)
+{
+    // the 16-bit partial sums take up to 128 blocks (2 x 255 per lane each) before they are widened
+    constexpr size_t blocksPerFlush = 128;
+
+    auto sum = vdupq_n_u64(0);
+
+    size_t idx = 0;
+    while (idx + 16 <= numBytes)
+    {
+        auto partial = vdupq_n_u16(0);
+        for (size_t n = 0; (n < blocksPerFlush) && (idx + 16 <= numBytes); ++n, idx += 16)
+        {
+            partial = vpadalq_u8(partial, vabdq_u8(vld1q_u8(a + idx), vld1q_u8(b + idx)));
+        }
+        sum = vpadalq_u32(sum, vpaddlq_u16(partial));
+    }
+
+    auto total = vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+    return total + ScalarPixelKernels.SumOfAbsDiff(a + idx, b + idx, numBytes - idx);
+}
+
+
+/* ----- Table ----- */
+
+static const PixelKernels neonKernels_ = {
+    BgrToRgbNeon,
+    BgrToGrayNeon,
+    BgrToPlanarNeon,
+    YuyvToBgrNeon,
+    U8ToF32Neon,
+    BgrToRgbPlanarF32Neon,
+    SumOfAbsDiffNeon,
+};
+
+const PixelKernels* const NeonPixelKernels = &neonKernels_;
+
+#else
+
+const PixelKernels* const NeonPixelKernels = nullptr;
+
+#endif
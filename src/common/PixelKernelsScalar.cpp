@@ -0,0 +1,105 @@
+#include  "PixelKernels.hpp"
+#include  <algorithm>
+#include  <cstdlib>
+
+using namespace PixelCoefficients;
+
+
+static inline uint8_t SaturateToU8(int value)
+{
+    return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+}
+
+static void BgrToRgb(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    for (size_t idx = 0; idx < numPixels; ++idx, src += 3, dst += 3)
+    {
+        auto b = src[0];
+        dst[1] = src[1];
+        dst[0] = src[2];
+        dst[2] = b;
+    }
+}
+
+static void BgrToGray(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    for (size_t idx = 0; idx < numPixels; ++idx, src += 3)
+    {
+        dst[idx] = static_cast<uint8_t>((src[0] * GrayB + src[1] * GrayG + src[2] * GrayR + (1 << (GrayShift - 1))) >> GrayShift);
+    }
+}
+
+static void BgrToPlanar(const uint8_t* src, uint8_t* dst0, uint8_t* dst1, uint8_t* dst2, size_t numPixels)
+{
+    for (size_t idx = 0; idx < numPixels; ++idx, src += 3)
+    {
+        dst0[idx] = src[0];
+        dst1[idx] = src[1];
+        dst2[idx] = src[2];
+    }
+}
+
+static void YuyvToBgr(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    constexpr int half = 1 << (YuvShift - 1);
+
+    for (size_t idx = 0; idx < numPixels; idx += 2, src += 4, dst += 6)
+    {
+        auto u = src[1] - 128;
+        auto v = src[3] - 128;
+        auto ruv = half + YuvVR * v;
+        auto guv = half + YuvVG * v + YuvUG * u;
+        auto buv = half + YuvUB * u;
+
+        auto y0 = std::max(0, src[0] - 16) * YuvY;
+        dst[0] = SaturateToU8((y0 + buv) >> YuvShift);
+        dst[1] = SaturateToU8((y0 + guv) >> YuvShift);
+        dst[2] = SaturateToU8((y0 + ruv) >> YuvShift);
+
+        auto y1 = std::max(0, src[2] - 16) * YuvY;
+        dst[3] = SaturateToU8((y1 + buv) >> YuvShift);
+        dst[4] = SaturateToU8((y1 + guv) >> YuvShift);
+        dst[5] = SaturateToU8((y1 + ruv) >> YuvShift);
+    }
+}
+
+static void U8ToF32(const uint8_t* src, float* dst, size_t numPixels, int numChannels, const float* mean, const float* scale)
+{
+    for (size_t idx = 0; idx < numPixels; ++idx)
+    {
+        for (int ch = 0; ch < numChannels; ++ch, ++src, ++dst)
+        {
+            *dst = (static_cast<float>(*src) - mean[ch]) * scale[ch];
+        }
+    }
+}
+
+static void BgrToRgbPlanarF32(const uint8_t* src, float* dstR, float* dstG, float* dstB, size_t numPixels, const float* mean, const float* scale)
+{
+    for (size_t idx = 0; idx < numPixels; ++idx, src += 3)
+    {
+        dstR[idx] = (static_cast<float>(src[2]) - mean[0]) * scale[0];
+        dstG[idx] = (static_cast<float>(src[1]) - mean[1]) * scale[1];
+        dstB[idx] = (static_cast<float>(src[0]) - mean[2]) * scale[2];
+    }
+}
+
+static uint64_t SumOfAbsDiff(const uint8_t* a, const uint8_t* b, size_t numBytes)
+{
+    uint64_t sum = 0;
+    for (size_t idx = 0; idx < numBytes; ++idx)
+    {
+        sum += static_cast<uint64_t>(std::abs(static_cast<int>(a[idx]) - static_cast<int>(b[idx])));
+    }
+    return sum;
+}
+
+const PixelKernels ScalarPixelKernels = {
+    BgrToRgb,
+    BgrToGray,
+    BgrToPlanar,
+    YuyvToBgr,
+    U8ToF32,
+    BgrToRgbPlanarF32,
+    SumOfAbsDiff,
+};
@@ -0,0 +1,537 @@
+#include  "PixelKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include  <immintrin.h>
+#include  <array>
+
+using namespace PixelCoefficients;
+
+// the library is built for the baseline ISA, the kernels enable SSE4.1/AVX2 per function
+#define SSE41_INLINE  static inline __attribute__((target("sse4.1"), always_inline))
+#define SSE41_KERNEL  static __attribute__((target("sse4.1")))
+#define AVX2_INLINE  static inline __attribute__((target("avx2"), always_inline))
+#define AVX2_KERNEL  static __attribute__((target("avx2")))
+
+using ShuffleMask = std::array<int8_t, 16>;
+using ShuffleTable = std::array<std::array<ShuffleMask, 3>, 3>;
+
+static constexpr int8_t zeroing_ = -128;
+
+
+/* ----- Shuffle masks ----- */
+
+// channel ch of 16 packed 3-channel pixels, the part found in the 16-byte block `block`
+static constexpr ShuffleMask MakeGatherMask(int ch, int block)
+{
+    auto mask = ShuffleMask{};
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto pos = 3 * idx + ch;
+        mask[idx] = (pos / 16 == block) ? static_cast<int8_t>(pos % 16) : zeroing_;
+    }
+    return mask;
+}
+
+// inverse of MakeGatherMask: bytes of channel ch that land in the output block `block`
+static constexpr ShuffleMask MakeScatterMask(int ch, int block)
+{
+    auto mask = ShuffleMask{};
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto pos = 16 * block + idx;
+        mask[idx] = (pos % 3 == ch) ? static_cast<int8_t>(pos / 3) : zeroing_;
+    }
+    return mask;
+}
+
+// output block `block` of the packed pixels with the first and the third channel swapped, the part taken from source block `from`
+static constexpr ShuffleMask MakeSwapMask(int block, int from)
+{
+    auto mask = ShuffleMask{};
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto pos = 16 * block + idx;
+        auto srcPos = 3 * (pos / 3) + (2 - pos % 3);
+        mask[idx] = (srcPos / 16 == from) ? static_cast<int8_t>(srcPos % 16) : zeroing_;
+    }
+    return mask;
+}
+
+// 8 pixels of BGR out of a register holding B in bytes 0-7 and R in bytes 8-15 (isGreen: out of G in bytes 0-7)
+static constexpr ShuffleMask MakeBgr8Mask(bool isGreen, int block)
+{
+    auto mask = ShuffleMask{};
+    for (int idx = 0; idx < 16; ++idx)
+    {
+        auto pos = 16 * block + idx;
+        auto pixel = pos / 3;
+        auto ch = pos % 3;
+
+        mask[idx] = zeroing_;
+        if (pos >= 24) { continue; }
+
+        if (isGreen && (ch == 1)) { mask[idx] = static_cast<int8_t>(pixel); }
+        if (!isGreen && (ch == 0)) { mask[idx] = static_cast<int8_t>(pixel); }
+        if (!isGreen && (ch == 2)) { mask[idx] = static_cast<int8_t>(8 + pixel); }
+    }
+    return mask;
+}
+
+static constexpr ShuffleTable MakeTable(ShuffleMask (*make)(int, int))
+{
+    auto table = ShuffleTable{};
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            table[i][j] = make(i, j);
+        }
+    }
+    return table;
+}
+
+static constexpr ShuffleTable gatherMasks_ = MakeTable(MakeGatherMask);  // [ch][block]
+static constexpr ShuffleTable scatterMasks_ = MakeTable(MakeScatterMask);  // [ch][block]
+static constexpr ShuffleTable swapMasks_ = MakeTable(MakeSwapMask);  // [block][from]
+
+static constexpr std::array<ShuffleMask, 2> bgr8BrMasks_ = { MakeBgr8Mask(false, 0), MakeBgr8Mask(false, 1) };
+static constexpr std::array<ShuffleMask, 2> bgr8GMasks_ = { MakeBgr8Mask(true, 0), MakeBgr8Mask(true, 1) };
+
+static constexpr ShuffleMask yuyvYMask_ = { 0, 2, 4, 6, 8, 10, 12, 14, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_ };
+static constexpr ShuffleMask yuyvUMask_ = { 1, 1, 5, 5, 9, 9, 13, 13, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_ };
+static constexpr ShuffleMask yuyvVMask_ = { 3, 3, 7, 7, 11, 11, 15, 15, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_, zeroing_ };
+
+
+/* ----- SSE4.1 helpers ----- */
+
+SSE41_INLINE __m128i LoadMask(const ShuffleMask& mask)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data()));
+}
+
+// also on 32-bit x86, which has no 64-bit lane extract
+SSE41_INLINE uint64_t SumOf64x2(__m128i value)
+{
+    uint64_t sum;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&sum), _mm_add_epi64(value, _mm_unpackhi_epi64(value, value)));
+    return sum;
+}
+
+SSE41_INLINE __m128i Load128(const uint8_t* src)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+SSE41_INLINE void Store128(uint8_t* dst, __m128i value)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+}
+
+// 16 packed 3-channel pixels (48 bytes) into one register per channel
+SSE41_INLINE void Deinterleave3(const uint8_t* src, __m128i* c0, __m128i* c1, __m128i* c2)
+{
+    __m128i blocks[3] = { Load128(src), Load128(src + 16), Load128(src + 32) };
+    __m128i* channels[3] = { c0, c1, c2 };
+
+    for (int ch = 0; ch < 3; ++ch)
+    {
+        *channels[ch] = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_shuffle_epi8(blocks[0], LoadMask(gatherMasks_[ch][0])),
+                    _mm_shuffle_epi8(blocks[1], LoadMask(gatherMasks_[ch][1]))
+                ),
+                _mm_shuffle_epi8(blocks[2], LoadMask(gatherMasks_[ch][2]))
+            );
+    }
+}
+
+// 8 pixels of BGR (24 bytes) out of three registers of 8 x int16, saturated to 8 bits
+SSE41_INLINE void StoreBgr8(__m128i b, __m128i g, __m128i r, uint8_t* dst)
+{
+    auto br = _mm_packus_epi16(b, r);
+    auto gg = _mm_packus_epi16(g, g);
+
+    auto out0 = _mm_or_si128(_mm_shuffle_epi8(br, LoadMask(bgr8BrMasks_[0])), _mm_shuffle_epi8(gg, LoadMask(bgr8GMasks_[0])));
+    auto out1 = _mm_or_si128(_mm_shuffle_epi8(br, LoadMask(bgr8BrMasks_[1])), _mm_shuffle_epi8(gg, LoadMask(bgr8GMasks_[1])));
+
+    Store128(dst, out0);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 16), out1);
+}
+
+// gray of the 8 pixels in the low bytes of b, g and r as 8 x int16
+SSE41_INLINE __m128i GrayOf8(__m128i b, __m128i g, __m128i r)
+{
+    auto coeffBG = _mm_set1_epi32((GrayG << 16) | GrayB);
+    auto coeffR = _mm_set1_epi32(((1 << (GrayShift - 1)) << 16) | GrayR);  // r * GrayR + 1 * round
+    auto one = _mm_set1_epi16(1);
+
+    auto b16 = _mm_cvtepu8_epi16(b);
+    auto g16 = _mm_cvtepu8_epi16(g);
+    auto r16 = _mm_cvtepu8_epi16(r);
+
+    auto lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b16, g16), coeffBG), _mm_madd_epi16(_mm_unpacklo_epi16(r16, one), coeffR));
+    auto hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b16, g16), coeffBG), _mm_madd_epi16(_mm_unpackhi_epi16(r16, one), coeffR));
+
+    return _mm_packs_epi32(_mm_srli_epi32(lo, GrayShift), _mm_srli_epi32(hi, GrayShift));
+}
+
+// BT.601 of 4 pixels held as int32
+SSE41_INLINE void YuvToBgr4(__m128i y, __m128i u, __m128i v, __m128i* b, __m128i* g, __m128i* r)
+{
+    auto half = _mm_set1_epi32(1 << (YuvShift - 1));
+
+    y = _mm_mullo_epi32(_mm_max_epi32(_mm_sub_epi32(y, _mm_set1_epi32(16)), _mm_setzero_si128()), _mm_set1_epi32(YuvY));
+    y = _mm_add_epi32(y, half);
+    u = _mm_sub_epi32(u, _mm_set1_epi32(128));
+    v = _mm_sub_epi32(v, _mm_set1_epi32(128));
+
+    *b = _mm_srai_epi32(_mm_add_epi32(y, _mm_mullo_epi32(u, _mm_set1_epi32(YuvUB))), YuvShift);
+    *g = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(y, _mm_mullo_epi32(v, _mm_set1_epi32(YuvVG))), _mm_mullo_epi32(u, _mm_set1_epi32(YuvUG))), YuvShift);
+    *r = _mm_srai_epi32(_mm_add_epi32(y, _mm_mullo_epi32(v, _mm_set1_epi32(YuvVR))), YuvShift);
+}
+
+SSE41_INLINE void ConvertStore4(__m128i value, __m128 mean, __m128 scale, float* dst)
+{
+    _mm_storeu_ps(dst, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(value)), mean), scale));
+}
+
+// 16 bytes into 16 floats with one mean and scale
+SSE41_INLINE void ConvertStore16(__m128i value, __m128 mean, __m128 scale, float* dst)
+{
+    ConvertStore4(value, mean, scale, dst);
+    ConvertStore4(_mm_srli_si128(value, 4), mean, scale, dst + 4);
+    ConvertStore4(_mm_srli_si128(value, 8), mean, scale, dst + 8);
+    ConvertStore4(_mm_srli_si128(value, 12), mean, scale, dst + 12);
+}
+
+
+/* ----- SSE4.1 kernels ----- */
+
+SSE41_KERNEL void BgrToRgbSse41(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48, dst += 48)
+    {
+        __m128i blocks[3] = { Load128(src), Load128(src + 16), Load128(src + 32) };
+
+        // a pixel never straddles more than two neighbouring blocks
+        for (int block = 0; block < 3; ++block)
+        {
+            auto out = _mm_shuffle_epi8(blocks[block], LoadMask(swapMasks_[block][block]));
+            if (block > 0) { out = _mm_or_si128(out, _mm_shuffle_epi8(blocks[block - 1], LoadMask(swapMasks_[block][block - 1]))); }
+            if (block < 2) { out = _mm_or_si128(out, _mm_shuffle_epi8(blocks[block + 1], LoadMask(swapMasks_[block][block + 1]))); }
+            Store128(dst + 16 * block, out);
+        }
+    }
+
+    ScalarPixelKernels.BgrToRgb(src, dst, numPixels - idx);
+}
+
+SSE41_KERNEL void BgrToGraySse41(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        __m128i b, g, r;
+        Deinterleave3(src, &b, &g, &r);
+
+        auto lo = GrayOf8(b, g, r);
+        auto hi = GrayOf8(_mm_srli_si128(b, 8), _mm_srli_si128(g, 8), _mm_srli_si128(r, 8));
+        Store128(dst + idx, _mm_packus_epi16(lo, hi));
+    }
+
+    ScalarPixelKernels.BgrToGray(src, dst + idx, numPixels - idx);
+}
+
+SSE41_KERNEL void BgrToPlanarSse41(const uint8_t* src, uint8_t* dst0, uint8_t* dst1, uint8_t* dst2, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        __m128i c0, c1, c2;
+        Deinterleave3(src, &c0, &c1, &c2);
+
+        Store128(dst0 + idx, c0);
+        Store128(dst1 + idx, c1);
+        Store128(dst2 + idx, c2);
+    }
+
+    ScalarPixelKernels.BgrToPlanar(src, dst0 + idx, dst1 + idx, dst2 + idx, numPixels - idx);
+}
+
+SSE41_KERNEL void YuyvToBgrSse41(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    size_t idx = 0;
+    for (; idx + 8 <= numPixels; idx += 8, src += 16, dst += 24)
+    {
+        auto s = Load128(src);
+        auto y = _mm_shuffle_epi8(s, LoadMask(yuyvYMask_));
+        auto u = _mm_shuffle_epi8(s, LoadMask(yuyvUMask_));
+        auto v = _mm_shuffle_epi8(s, LoadMask(yuyvVMask_));
+
+        __m128i b0, g0, r0, b1, g1, r1;
+        YuvToBgr4(_mm_cvtepu8_epi32(y), _mm_cvtepu8_epi32(u), _mm_cvtepu8_epi32(v), &b0, &g0, &r0);
+        YuvToBgr4(
+            _mm_cvtepu8_epi32(_mm_srli_si128(y, 4)), _mm_cvtepu8_epi32(_mm_srli_si128(u, 4)), _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)),
+            &b1, &g1, &r1
+        );
+
+        StoreBgr8(_mm_packs_epi32(b0, b1), _mm_packs_epi32(g0, g1), _mm_packs_epi32(r0, r1), dst);
+    }
+
+    ScalarPixelKernels.YuyvToBgr(src, dst, numPixels - idx);
+}
+
+SSE41_KERNEL void U8ToF32Sse41(const uint8_t* src, float* dst, size_t numPixels, int numChannels, const float* mean, const float* scale)
+{
+    // lane j of vector k holds channel (4k + j) % numChannels, a pattern repeating every numChannels vectors
+    __m128 means[4], scales[4];
+    for (int k = 0; k < numChannels; ++k)
+    {
+        float m[4], s[4];
+        for (int j = 0; j < 4; ++j)
+        {
+            m[j] = mean[(4 * k + j) % numChannels];
+            s[j] = scale[(4 * k + j) % numChannels];
+        }
+        means[k] = _mm_loadu_ps(m);
+        scales[k] = _mm_loadu_ps(s);
+    }
+
+    auto numValues = numPixels * numChannels;
+    auto sizeOfBlock = static_cast<size_t>(16 * numChannels);
+
+    size_t idx = 0;
+    for (; idx + sizeOfBlock <= numValues; idx += sizeOfBlock)
+    {
+        for (int m = 0; m < numChannels; ++m)
+        {
+            auto value = Load128(src + idx + 16 * m);
+            auto out = dst + idx + 16 * m;
+
+            ConvertStore4(value, means[(4 * m) % numChannels], scales[(4 * m) % numChannels], out);
+            ConvertStore4(_mm_srli_si128(value, 4), means[(4 * m + 1) % numChannels], scales[(4 * m + 1) % numChannels], out + 4);
+            ConvertStore4(_mm_srli_si128(value, 8), means[(4 * m + 2) % numChannels], scales[(4 * m + 2) % numChannels], out + 8);
+            ConvertStore4(_mm_srli_si128(value, 12), means[(4 * m + 3) % numChannels], scales[(4 * m + 3) % numChannels], out + 12);
+        }
+    }
+
+    ScalarPixelKernels.U8ToF32(src + idx, dst + idx, numPixels - idx / numChannels, numChannels, mean, scale);
+}
+
+SSE41_KERNEL void BgrToRgbPlanarF32Sse41(const uint8_t* src, float* dstR, float* dstG, float* dstB, size_t numPixels, const float* mean, const float* scale)
+{
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        __m128i b, g, r;
+        Deinterleave3(src, &b, &g, &r);
+
+        ConvertStore16(r, _mm_set1_ps(mean[0]), _mm_set1_ps(scale[0]), dstR + idx);
+        ConvertStore16(g, _mm_set1_ps(mean[1]), _mm_set1_ps(scale[1]), dstG + idx);
+        ConvertStore16(b, _mm_set1_ps(mean[2]), _mm_set1_ps(scale[2]), dstB + idx);
+    }
+
+    ScalarPixelKernels.BgrToRgbPlanarF32(src, dstR + idx, dstG + idx, dstB + idx, numPixels - idx, mean, scale);
+}
+
+// psadbw sums the absolute differences of 8 bytes into one 64-bit lane
+SSE41_KERNEL uint64_t SumOfAbsDiffSse41(const uint8_t* a, const uint8_t* b, size_t numBytes)
+{
+    auto sum = _mm_setzero_si128();
+
+    size_t idx = 0;
+    for (; idx + 16 <= numBytes; idx += 16)
+    {
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(Load128(a + idx), Load128(b + idx)));
+    }
+
+    return SumOf64x2(sum) + ScalarPixelKernels.SumOfAbsDiff(a + idx, b + idx, numBytes - idx);
+}
+
+
+/* ----- AVX2 helpers ----- */
+
+// 16 bytes into 16 floats with one mean and scale
+AVX2_INLINE void ConvertStore16Avx2(__m128i value, __m256 mean, __m256 scale, float* dst)
+{
+    auto lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(value));
+    auto hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(value, 8)));
+
+    _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_sub_ps(lo, mean), scale));
+    _mm256_storeu_ps(dst + 8, _mm256_mul_ps(_mm256_sub_ps(hi, mean), scale));
+}
+
+
+/* ----- AVX2 kernels ----- */
+
+AVX2_KERNEL void BgrToGrayAvx2(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    auto coeffBG = _mm256_set1_epi32((GrayG << 16) | GrayB);
+    auto coeffR = _mm256_set1_epi32(((1 << (GrayShift - 1)) << 16) | GrayR);
+    auto one = _mm256_set1_epi16(1);
+
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        __m128i b, g, r;
+        Deinterleave3(src, &b, &g, &r);
+
+        auto b16 = _mm256_cvtepu8_epi16(b);
+        auto g16 = _mm256_cvtepu8_epi16(g);
+        auto r16 = _mm256_cvtepu8_epi16(r);
+
+        // unpack and pack both work per 128-bit lane, so the pixel order survives
+        auto lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(b16, g16), coeffBG), _mm256_madd_epi16(_mm256_unpacklo_epi16(r16, one), coeffR));
+        auto hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(b16, g16), coeffBG), _mm256_madd_epi16(_mm256_unpackhi_epi16(r16, one), coeffR));
+        auto gray = _mm256_packs_epi32(_mm256_srli_epi32(lo, GrayShift), _mm256_srli_epi32(hi, GrayShift));
+
+        Store128(dst + idx, _mm_packus_epi16(_mm256_castsi256_si128(gray), _mm256_extracti128_si256(gray, 1)));
+    }
+
+    ScalarPixelKernels.BgrToGray(src, dst + idx, numPixels - idx);
+}
+
+AVX2_KERNEL void YuyvToBgrAvx2(const uint8_t* src, uint8_t* dst, size_t numPixels)
+{
+    auto half = _mm256_set1_epi32(1 << (YuvShift - 1));
+
+    size_t idx = 0;
+    for (; idx + 8 <= numPixels; idx += 8, src += 16, dst += 24)
+    {
+        auto s = Load128(src);
+        auto y = _mm256_cvtepu8_epi32(_mm_shuffle_epi8(s, LoadMask(yuyvYMask_)));
+        auto u = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_shuffle_epi8(s, LoadMask(yuyvUMask_))), _mm256_set1_epi32(128));
+        auto v = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_shuffle_epi8(s, LoadMask(yuyvVMask_))), _mm256_set1_epi32(128));
+
+        y = _mm256_mullo_epi32(_mm256_max_epi32(_mm256_sub_epi32(y, _mm256_set1_epi32(16)), _mm256_setzero_si256()), _mm256_set1_epi32(YuvY));
+        y = _mm256_add_epi32(y, half);
+
+        auto b = _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(u, _mm256_set1_epi32(YuvUB))), YuvShift);
+        auto g = _mm256_srai_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(v, _mm256_set1_epi32(YuvVG))), _mm256_mullo_epi32(u, _mm256_set1_epi32(YuvUG))),
+                YuvShift
+            );
+        auto r = _mm256_srai_epi32(_mm256_add_epi32(y, _mm256_mullo_epi32(v, _mm256_set1_epi32(YuvVR))), YuvShift);
+
+        StoreBgr8(
+            _mm_packs_epi32(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1)),
+            _mm_packs_epi32(_mm256_castsi256_si128(g), _mm256_extracti128_si256(g, 1)),
+            _mm_packs_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1)),
+            dst
+        );
+    }
+
+    ScalarPixelKernels.YuyvToBgr(src, dst, numPixels - idx);
+}
+
+AVX2_KERNEL void U8ToF32Avx2(const uint8_t* src, float* dst, size_t numPixels, int numChannels, const float* mean, const float* scale)
+{
+    // lane j of vector k holds channel (8k + j) % numChannels, a pattern repeating every numChannels vectors
+    __m256 means[4], scales[4];
+    for (int k = 0; k < numChannels; ++k)
+    {
+        float m[8], s[8];
+        for (int j = 0; j < 8; ++j)
+        {
+            m[j] = mean[(8 * k + j) % numChannels];
+            s[j] = scale[(8 * k + j) % numChannels];
+        }
+        means[k] = _mm256_loadu_ps(m);
+        scales[k] = _mm256_loadu_ps(s);
+    }
+
+    auto numValues = numPixels * numChannels;
+    auto sizeOfBlock = static_cast<size_t>(16 * numChannels);
+
+    size_t idx = 0;
+    for (; idx + sizeOfBlock <= numValues; idx += sizeOfBlock)
+    {
+        for (int m = 0; m < numChannels; ++m)
+        {
+            auto value = Load128(src + idx + 16 * m);
+            auto out = dst + idx + 16 * m;
+
+            auto lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(value));
+            auto hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(value, 8)));
+            auto k0 = (2 * m) % numChannels;
+            auto k1 = (2 * m + 1) % numChannels;
+
+            _mm256_storeu_ps(out, _mm256_mul_ps(_mm256_sub_ps(lo, means[k0]), scales[k0]));
+            _mm256_storeu_ps(out + 8, _mm256_mul_ps(_mm256_sub_ps(hi, means[k1]), scales[k1]));
+        }
+    }
+
+    ScalarPixelKernels.U8ToF32(src + idx, dst + idx, numPixels - idx / numChannels, numChannels, mean, scale);
+}
+
+AVX2_KERNEL void BgrToRgbPlanarF32Avx2(const uint8_t* src, float* dstR, float* dstG, float* dstB, size_t numPixels, const float* mean, const float* scale)
+{
+    auto meanR = _mm256_set1_ps(mean[0]), scaleR = _mm256_set1_ps(scale[0]);
+    auto meanG = _mm256_set1_ps(mean[1]), scaleG = _mm256_set1_ps(scale[1]);
+    auto meanB = _mm256_set1_ps(mean[2]), scaleB = _mm256_set1_ps(scale[2]);
+
+    size_t idx = 0;
+    for (; idx + 16 <= numPixels; idx += 16, src += 48)
+    {
+        __m128i b, g, r;
+        Deinterleave3(src, &b, &g, &r);
+
+        ConvertStore16Avx2(r, meanR, scaleR, dstR + idx);
+        ConvertStore16Avx2(g, meanG, scaleG, dstG + idx);
+        ConvertStore16Avx2(b, meanB, scaleB, dstB + idx);
+    }
+
+    ScalarPixelKernels.BgrToRgbPlanarF32(src, dstR + idx, dstG + idx, dstB + idx, numPixels - idx, mean, scale);
+}
+
+AVX2_KERNEL uint64_t SumOfAbsDiffAvx2(const uint8_t* a, const uint8_t* b, size_t numBytes)
+{
+    auto sum = _mm256_setzero_si256();
+
+    size_t idx = 0;
+    for (; idx + 32 <= numBytes; idx += 32)
+    {
+        auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + idx));
+        auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + idx));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(va, vb));
+    }
+
+    auto half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return SumOf64x2(half) + SumOfAbsDiffSse41(a + idx, b + idx, numBytes - idx);
+}
+
+
+/* ----- Tables ----- */
+
+static const PixelKernels sse41Kernels_ = {
+    BgrToRgbSse41,
+    BgrToGraySse41,
+    BgrToPlanarSse41,
+    YuyvToBgrSse41,
+    U8ToF32Sse41,
+    BgrToRgbPlanarF32Sse41,
+    SumOfAbsDiffSse41,
+};
+
+// pshufb does not cross the 128-bit lanes of AVX2, so the pure byte shuffles keep their SSE4.1 kernels
+static const PixelKernels avx2Kernels_ = {
+    BgrToRgbSse41,
+    BgrToGrayAvx2,
+    BgrToPlanarSse41,
+    YuyvToBgrAvx2,
+    U8ToF32Avx2,
+    BgrToRgbPlanarF32Avx2,
+    SumOfAbsDiffAvx2,
+};
+
+const PixelKernels* const Sse41PixelKernels = &sse41Kernels_;
+const PixelKernels* const Avx2PixelKernels = &avx2Kernels_;
+
+#else
+
+const PixelKernels* const Sse41PixelKernels = nullptr;
+const PixelKernels* const Avx2PixelKernels = nullptr;
+
+#endif
@@ -0,0 +1,145 @@
+#include  "RawRecorder.hpp"
+#include  <algorithm>
+#include  <fcntl.h>
+#include  <unistd.h>
+#include  <sys/mman.h>
+
+
+/* ----- Public ----- */
+
+RawRecorder::RawRecorder(const std::string& path, const FrameFormat& format, uint64_t capacity)
+    : fd_(-1), map_(nullptr), sizeOfMap_(0), header_(nullptr), index_(nullptr), format_(format),
+      dropped_(0)
+{
+    auto pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    auto sizeOfFrame = format_.GetSizeOfFrame();
+    auto sizeOfSlot = RawRecording::RoundUp(sizeOfFrame, pageSize);
+    auto indexOffset = RawRecording::RoundUp(sizeof(RawRecording::Header), pageSize);
+    auto dataOffset = indexOffset + RawRecording::RoundUp(sizeof(RawRecording::Entry) * capacity, pageSize);
+
+    if ((sizeOfFrame == 0) || (capacity == 0))
+    {
+        return;
+    }
+
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+    {
+        return;
+    }
+
+    // reserve the blocks up front, so that a full disk shows here and not as SIGBUS while recording
+    sizeOfMap_ = dataOffset + sizeOfSlot * capacity;
+    if (posix_fallocate(fd_, 0, sizeOfMap_) != 0)
+    {
+        Close();
+        return;
+    }
+
+    auto map = mmap(nullptr, sizeOfMap_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+    {
+        Close();
+        return;
+    }
+    map_ = static_cast<uint8_t*>(map);
+
+    header_ = reinterpret_cast<RawRecording::Header*>(map_);
+    index_ = reinterpret_cast<RawRecording::Entry*>(map_ + indexOffset);
+
+    std::memcpy(header_->Magic, RawRecording::Magic, sizeof(header_->Magic));
+    header_->Version = RawRecording::Version;
+    header_->PageSize = static_cast<uint32_t>(pageSize);
+    header_->Width = format_.Width;
+    header_->Height = format_.Height;
+    header_->NumChannels = format_.NumChannels;
+    header_->NumBytesPerChannel = format_.NumBytesPerChannel;
+    header_->Stride = format_.Stride;
+    header_->IsPlanar = format_.IsPlanar ? 1 : 0;
+    header_->SizeOfFrame = sizeOfFrame;
+    header_->SizeOfSlot = sizeOfSlot;
+    header_->Capacity = capacity;
+    header_->NumFrames = 0;
+    header_->IndexOffset = indexOffset;
+    header_->DataOffset = dataOffset;
+}
+
+RawRecorder::~RawRecorder()
+{
+    Close();
+}
+
+bool RawRecorder::Append(const CaptureDataObject* frame, uint64_t capturedTime, uint64_t sequence)
+{
+    if ((map_ == nullptr) || (frame == nullptr) || (GetNumFrames() == header_->Capacity)
+        || (frame->Format.GetSizeOfFrame() != header_->SizeOfFrame))
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto n = GetNumFrames();
+    std::memcpy(map_ + header_->DataOffset + header_->SizeOfSlot * n, frame->Data, header_->SizeOfFrame);
+    index_[n].Sequence = sequence;
+    index_[n].CapturedTime = capturedTime;
+
+    // the count goes last, so a reader of a file cut short never sees a frame that was not written;
+    // the count lives in the mapped header, which keeps its plain layout, so it is accessed through atomic_ref
+    std::atomic_ref<uint64_t>(header_->NumFrames).store(n + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool RawRecorder::Start(MultiThreadCaptureController* controller)
+{
+    if (map_ == nullptr)
+    {
+        return false;
+    }
+
+    return attachment_.Start(controller, [this](const FrameLease& lease){
+            Append(lease.Get(), lease.GetCapturedTime(), lease.GetSequence());
+        });
+}
+
+void RawRecorder::Stop(void)
+{
+    dropped_.fetch_add(attachment_.Stop(), std::memory_order_relaxed);
+}
+
+void RawRecorder::Close(void)
+{
+    Stop();
+
+    if (map_ != nullptr)
+    {
+        auto used = header_->DataOffset + header_->SizeOfSlot * GetNumFrames();
+        munmap(map_, sizeOfMap_);
+        map_ = nullptr;
+        header_ = nullptr;
+        index_ = nullptr;
+
+        // give back the slots never written
+        if (ftruncate(fd_, used) != 0)
+        {
+            // the file stays at its preallocated size, which is still a valid recording
+        }
+    }
+
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+uint64_t RawRecorder::GetNumFrames(void) const
+{
+    return (header_ != nullptr) ? std::atomic_ref<uint64_t>(header_->NumFrames).load(std::memory_order_acquire) : 0;
+}
+
+uint64_t RawRecorder::GetCapacity(void) const
+{
+    return (header_ != nullptr) ? header_->Capacity : 0;
+}
+
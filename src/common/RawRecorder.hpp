@@ -0,0 +1,59 @@
+#ifndef  H__RAW_RECORDER__H
+#define  H__RAW_RECORDER__H
+
+#include  <string>
+#include  <atomic>
+#include  <cstdint>
+#include  "AttachedConsumer.hpp"
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+#include  "RawRecording.hpp"
+
+class MultiThreadCaptureController;
+
+// Lossless recorder writing frames into a preallocated, memory-mapped RawRecording file.
+//
+// The file is sized for capacity frames when opened, so appending is a copy into the mapping and never grows the file;
+// Close truncates it to the frames written. Start records every frame the controller publishes through an AttachedConsumer.
+class RawRecorder
+{
+    private:
+        int fd_;
+        uint8_t* map_;
+        uint64_t sizeOfMap_;
+        RawRecording::Header* header_;
+        RawRecording::Entry* index_;
+        FrameFormat format_;
+
+        AttachedConsumer attachment_;
+        std::atomic<uint64_t> dropped_;  // frames not recorded: missed by the consumer or over capacity
+
+    public:
+        RawRecorder(const std::string& path, const FrameFormat& format, uint64_t capacity);
+
+        ~RawRecorder();
+
+        RawRecorder(const RawRecorder&) = delete;
+
+        RawRecorder& operator=(const RawRecorder&) = delete;
+
+        bool IsOpen(void) const { return map_ != nullptr; }
+
+        // false when the recording is full or the frame does not have the recorded format
+        bool Append(const CaptureDataObject* frame, uint64_t capturedTime, uint64_t sequence);
+
+        // records the frames published from now on until Stop; the controller must outlive the recording
+        bool Start(MultiThreadCaptureController* controller);
+
+        void Stop(void);
+
+        void Close(void);
+
+        uint64_t GetNumFrames(void) const;
+
+        uint64_t GetCapacity(void) const;
+
+        uint64_t GetNumDropped(void) const { return dropped_.load(std::memory_order_relaxed); }
+};
+
+#endif  // H__RAW_RECORDER__H
@@ -0,0 +1,76 @@
+#ifndef  H__RAW_RECORDING__H
+#define  H__RAW_RECORDING__H
+
+#include  <cstdint>
+#include  <cstring>
+#include  "FrameFormat.hpp"
+
+// On-disk layout shared by RawRecorder and RawReplayCapture.
+//
+//   [header page][index: Capacity x RawRecordingEntry, page aligned][frames: Capacity x SizeOfSlot]
+//
+// Every frame starts on a page boundary, so a mapping of the file can be handed out as frame buffers as is.
+// Frames keep the layout they were captured with (FrameFormat, including the row stride).
+namespace RawRecording
+{
+    constexpr char Magic[8] = { 'M', 'T', 'C', 'R', 'A', 'W', '\0', '\0' };
+    constexpr uint32_t Version = 1;
+
+    struct Header
+    {
+        char Magic[8];
+        uint32_t Version;
+        uint32_t PageSize;
+
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t NumChannels;
+        uint32_t NumBytesPerChannel;
+        uint64_t Stride;
+        uint32_t IsPlanar;
+        uint32_t Reserved;
+
+        uint64_t SizeOfFrame;  // bytes used in a slot
+        uint64_t SizeOfSlot;  // multiple of PageSize
+        uint64_t Capacity;  // slots preallocated
+        alignas(8) uint64_t NumFrames;  // slots written, updated after each frame (through std::atomic_ref while recording)
+
+        uint64_t IndexOffset;
+        uint64_t DataOffset;
+    };
+
+    struct Entry
+    {
+        uint64_t Sequence;  // sequence number given by the controller
+        uint64_t CapturedTime;  // [ns] time stamp given by the controller
+    };
+
+    inline uint64_t RoundUp(uint64_t value, uint64_t unit)
+    {
+        return (value + unit - 1) / unit * unit;
+    }
+
+    inline FrameFormat GetFormat(const Header& header)
+    {
+        auto format = FrameFormat{};
+        format.Width = header.Width;
+        format.Height = header.Height;
+        format.NumChannels = header.NumChannels;
+        format.NumBytesPerChannel = header.NumBytesPerChannel;
+        format.Stride = header.Stride;
+        format.IsPlanar = (header.IsPlanar != 0);
+        return format;
+    }
+
+    inline bool IsValid(const Header& header, uint64_t sizeOfFile)
+    {
+        return (std::memcmp(header.Magic, Magic, sizeof(Magic)) == 0)
+            && (header.Version == Version)
+            && (header.SizeOfFrame == GetFormat(header).GetSizeOfFrame())
+            && (header.SizeOfSlot >= header.SizeOfFrame)
+            && (header.NumFrames <= header.Capacity)
+            && (header.DataOffset + header.SizeOfSlot * header.NumFrames <= sizeOfFile);
+    }
+}
+
+#endif  // H__RAW_RECORDING__H
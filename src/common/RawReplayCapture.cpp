@@ -0,0 +1,156 @@
+#include  "RawReplayCapture.hpp"
+#include  <thread>
+#include  <chrono>
+#include  <fcntl.h>
+#include  <unistd.h>
+#include  <sys/mman.h>
+#include  <sys/stat.h>
+
+static uint64_t GetTimeAsNs(void)
+{
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+}
+
+
+/* ----- Public ----- */
+
+RawReplayCapture::RawReplayCapture(const std::string& path, bool isPaced)
+    : header_(nullptr), index_(nullptr), isPaced_(isPaced), position_(0), startTime_(0)
+{
+    auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (static_cast<uint64_t>(st.st_size) < sizeof(RawRecording::Header)))
+    {
+        close(fd);
+        return;
+    }
+
+    auto sizeOfFile = static_cast<uint64_t>(st.st_size);
+    auto map = mmap(nullptr, sizeOfFile, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping keeps the file open
+    if (map == MAP_FAILED)
+    {
+        return;
+    }
+
+    auto header = static_cast<const RawRecording::Header*>(map);
+    if (!RawRecording::IsValid(*header, sizeOfFile))
+    {
+        munmap(map, sizeOfFile);
+        return;
+    }
+
+    // frames are read front to back, let the kernel read ahead
+    madvise(map, sizeOfFile, MADV_SEQUENTIAL);
+
+    map_ = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(map), [sizeOfFile](uint8_t* p){ munmap(p, sizeOfFile); });
+    header_ = header;
+    index_ = reinterpret_cast<const RawRecording::Entry*>(map_.get() + header_->IndexOffset);
+    format_ = RawRecording::GetFormat(*header_);
+}
+
+uint64_t RawReplayCapture::GetNumFrames(void) const
+{
+    return (header_ != nullptr) ? header_->NumFrames : 0;
+}
+
+uint64_t RawReplayCapture::GetCapturedTime(uint64_t n) const
+{
+    return (n < GetNumFrames()) ? index_[n].CapturedTime : 0;
+}
+
+bool RawReplayCapture::Contains(const void* data) const
+{
+    if (map_ == nullptr)
+    {
+        return false;
+    }
+
+    auto p = static_cast<const uint8_t*>(data);
+    auto head = map_.get() + header_->DataOffset;
+    return (p >= head) && (p < head + header_->SizeOfSlot * header_->NumFrames);
+}
+
+bool RawReplayCapture::Capture(const CaptureDataObject* captureDataObject)
+{
+    if ((position_ >= GetNumFrames()) || (captureDataObject->Format.GetSizeOfFrame() < header_->SizeOfFrame))
+    {
+        return false;
+    }
+
+    WaitForCapturedTime(position_);
+    std::memcpy(const_cast<void*>(captureDataObject->Data), GetFrame(position_), header_->SizeOfFrame);
+    ++position_;
+
+    return true;
+}
+
+uint64_t RawReplayCapture::GetNBytes()
+{
+    return format_.NumBytesPerChannel;
+}
+
+uint64_t RawReplayCapture::GetLength()
+{
+    return (format_.NumBytesPerChannel != 0) ? format_.GetSizeOfFrame() / format_.NumBytesPerChannel : 0;
+}
+
+FrameFormat RawReplayCapture::GetFormat()
+{
+    return format_;
+}
+
+std::shared_ptr<CaptureDataObject> RawReplayCapture::Borrow()
+{
+    if (position_ >= GetNumFrames())
+    {
+        return nullptr;
+    }
+
+    WaitForCapturedTime(position_);
+    auto frame = std::shared_ptr<CaptureDataObject>(
+            new CaptureDataObject(GetFrame(position_), format_),
+            [map = map_](CaptureDataObject* p){ delete p; }
+        );
+    ++position_;
+
+    return frame;
+}
+
+
+/* ----- Private ----- */
+
+const uint8_t* RawReplayCapture::GetFrame(uint64_t n) const
+{
+    return map_.get() + header_->DataOffset + header_->SizeOfSlot * n;
+}
+
+void RawReplayCapture::WaitForCapturedTime(uint64_t n)
+{
+    if (!isPaced_)
+    {
+        return;
+    }
+
+    if (n == 0)
+    {
+        startTime_ = GetTimeAsNs();
+        return;
+    }
+
+    auto due = startTime_ + (index_[n].CapturedTime - index_[0].CapturedTime);
+    auto now = GetTimeAsNs();
+    if (due > now)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef  H__RAW_REPLAY_CAPTURE__H
+#define  H__RAW_REPLAY_CAPTURE__H
+
+#include  <string>
+#include  <memory>
+#include  <cstdint>
+#include  "ICapturable.hpp"
+#include  "RawRecording.hpp"
+
+// Capture source replaying a RawRecording file written by RawRecorder.
+//
+// The file is mapped read-only and the controller is handed frames pointing into the mapping (IsZeroCopy),
+// so replay costs no copy; the mapping lives on while any frame handed out is still referenced.
+// Paced replay keeps the original intervals between frames, otherwise frames come as fast as they are read.
+class RawReplayCapture : public ICapturable
+{
+    private:
+        std::shared_ptr<uint8_t> map_;  // whole file, unmapped with the last frame referencing it
+        const RawRecording::Header* header_;
+        const RawRecording::Entry* index_;
+        FrameFormat format_;
+
+        bool isPaced_;
+        uint64_t position_;  // next frame to hand out
+        uint64_t startTime_;  // [ns] time the first frame was handed out
+
+        const uint8_t* GetFrame(uint64_t n) const;
+
+        void WaitForCapturedTime(uint64_t n);
+
+    public:
+        explicit RawReplayCapture(const std::string& path, bool isPaced = false);
+
+        bool IsOpen(void) const { return map_ != nullptr; }
+
+        uint64_t GetNumFrames(void) const;
+
+        // [ns] time stamp of frame n when it was recorded
+        uint64_t GetCapturedTime(uint64_t n) const;
+
+        // true if data points into the mapping of this recording
+        bool Contains(const void* data) const;
+
+        bool Capture(const CaptureDataObject* captureDataObject) override;
+
+        uint64_t GetNBytes() override;
+
+        uint64_t GetLength() override;
+
+        FrameFormat GetFormat() override;
+
+        bool IsZeroCopy() override { return true; }
+
+        std::shared_ptr<CaptureDataObject> Borrow() override;
+};
+
+#endif  // H__RAW_REPLAY_CAPTURE__H
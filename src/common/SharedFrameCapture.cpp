@@ -0,0 +1,245 @@
+#include  "SharedFrameCapture.hpp"
+#include  <ctime>
+#include  <cerrno>
+#include  <csignal>
+#include  <fcntl.h>
+#include  <unistd.h>
+#include  <sys/mman.h>
+#include  <sys/stat.h>
+#include  <sys/syscall.h>
+#include  <linux/futex.h>
+#include  "SlotPinning.hpp"
+
+
+/* ----- Public ----- */
+
+SharedFrameCapture::SharedFrameCapture(const std::string& name, bool isZeroCopy)
+    : header_(nullptr), slots_(nullptr), isZeroCopy_(isZeroCopy), pinMask_(0), lastSequence_(0), lastCapturedTime_(0), missed_(0), polls_(0)
+{
+    auto fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (static_cast<uint64_t>(st.st_size) < sizeof(SharedFrameRing::Header)))
+    {
+        close(fd);
+        return;
+    }
+
+    // writable, as reading a frame pins its slot
+    auto sizeOfMap = static_cast<uint64_t>(st.st_size);
+    auto map = mmap(nullptr, sizeOfMap, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  // the mapping keeps the memory
+    if (map == MAP_FAILED)
+    {
+        return;
+    }
+
+    auto header = static_cast<SharedFrameRing::Header*>(map);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!SharedFrameRing::IsValid(*header, sizeOfMap))
+    {
+        munmap(map, sizeOfMap);
+        return;
+    }
+
+    // an entry of its own, so that the publisher can tell the pins of this process from the others
+    auto client = 0;
+    for (auto pid = static_cast<int32_t>(getpid()); client < SharedFrameRing::MaxNumClients; ++client)
+    {
+        auto expected = int32_t{0};
+        if (header->ClientPids[client].compare_exchange_strong(expected, pid, std::memory_order_acq_rel))
+        {
+            break;
+        }
+    }
+    if (client == SharedFrameRing::MaxNumClients)
+    {
+        munmap(map, sizeOfMap);
+        return;
+    }
+
+    // the entry is given back with the last frame referencing the memory, when no pin of this client is left
+    map_ = std::shared_ptr<uint8_t>(static_cast<uint8_t*>(map), [sizeOfMap, header, client](uint8_t* p){
+            header->ClientPids[client].store(0, std::memory_order_release);
+            munmap(p, sizeOfMap);
+        });
+    pinMask_ = 1ULL << client;
+    header_ = header;
+    slots_ = reinterpret_cast<SharedFrameRing::Slot*>(map_.get() + header_->SlotOffset);
+    format_ = SharedFrameRing::GetFormat(*header_);
+}
+
+bool SharedFrameCapture::Contains(const void* data) const
+{
+    if (map_ == nullptr)
+    {
+        return false;
+    }
+
+    auto p = static_cast<const uint8_t*>(data);
+    auto head = map_.get() + header_->DataOffset;
+    return (p >= head) && (p < head + header_->SizeOfSlot * header_->NumSlots);
+}
+
+bool SharedFrameCapture::Capture(const CaptureDataObject* captureDataObject)
+{
+    if ((map_ == nullptr) || (captureDataObject->Format.GetSizeOfFrame() < header_->SizeOfFrame))
+    {
+        return false;
+    }
+
+    auto idx = PinNext();
+    if (idx < 0)
+    {
+        return false;
+    }
+
+    std::memcpy(const_cast<void*>(captureDataObject->Data), map_.get() + header_->DataOffset + header_->SizeOfSlot * idx, header_->SizeOfFrame);
+    Unpin(idx);
+
+    return true;
+}
+
+uint64_t SharedFrameCapture::GetNBytes()
+{
+    return format_.NumBytesPerChannel;
+}
+
+uint64_t SharedFrameCapture::GetLength()
+{
+    return (format_.NumBytesPerChannel != 0) ? format_.GetSizeOfFrame() / format_.NumBytesPerChannel : 0;
+}
+
+FrameFormat SharedFrameCapture::GetFormat()
+{
+    return format_;
+}
+
+std::shared_ptr<CaptureDataObject> SharedFrameCapture::Borrow()
+{
+    if (map_ == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto idx = PinNext();
+    if (idx < 0)
+    {
+        return nullptr;
+    }
+
+    // the slot stays pinned, and the memory mapped, as long as the controller holds the frame
+    auto slot = &slots_[idx];
+    return std::shared_ptr<CaptureDataObject>(
+            new CaptureDataObject(map_.get() + header_->DataOffset + header_->SizeOfSlot * idx, format_),
+            [map = map_, slot, mask = pinMask_](CaptureDataObject* p){
+                slot->Pins.fetch_and(~mask, std::memory_order_release);
+                delete p;
+            }
+        );
+}
+
+uint64_t SharedFrameCapture::GetTimeToReady()
+{
+    constexpr uint64_t pollInterval = 250 * 1000;  // [ns]
+    constexpr uint32_t numPollsPerAliveCheck = 400;  // about as often as WaitForNotify checks
+
+    if ((map_ == nullptr) || (header_->IsClosed.load(std::memory_order_acquire) != 0))
+    {
+        return 0;
+    }
+
+    auto latest = header_->Latest.load(std::memory_order_acquire);
+    if (SharedFrameRing::SequenceOf(latest) > lastSequence_)
+    {
+        polls_ = 0;
+        return 0;
+    }
+
+    // a publisher gone without closing the ring: let Capture notice it
+    return ((++polls_ % numPollsPerAliveCheck != 0) || IsPublisherAlive()) ? pollInterval : 0;
+}
+
+
+/* ----- Private ----- */
+
+int SharedFrameCapture::PinNext(void)
+{
+    while (true)
+    {
+        auto notify = header_->Notify.load(std::memory_order_acquire);
+        auto latest = header_->Latest.load(std::memory_order_acquire);
+
+        if (SharedFrameRing::SequenceOf(latest) > lastSequence_)
+        {
+            // the first frame is the newest one; after that, the oldest one not handed out yet
+            auto idx = static_cast<int>(SharedFrameRing::SlotOf(latest));
+            auto sequence = SharedFrameRing::SequenceOf(latest);
+            if (lastSequence_ != 0)
+            {
+                for (uint32_t n = 0; n < header_->NumSlots; ++n)
+                {
+                    auto held = slots_[n].Sequence.load(std::memory_order_acquire);
+                    if ((held > lastSequence_) && (held < sequence))
+                    {
+                        idx = static_cast<int>(n);
+                        sequence = held;
+                    }
+                }
+            }
+
+            auto& slot = slots_[idx];
+            slot.Pins.fetch_or(pinMask_, std::memory_order_seq_cst);
+            if (!SlotPinning::IsStillHeld(slot.Sequence, sequence))
+            {
+                // written over while we were choosing, choose again
+                Unpin(idx);
+                continue;
+            }
+
+            if (lastSequence_ != 0)
+            {
+                missed_ += sequence - lastSequence_ - 1;
+            }
+            lastSequence_ = sequence;
+            lastCapturedTime_ = slot.CapturedTime.load(std::memory_order_relaxed);
+
+            return idx;
+        }
+
+        if ((header_->IsClosed.load(std::memory_order_acquire) != 0) || !WaitForNotify(notify))
+        {
+            return -1;
+        }
+    }
+}
+
+void SharedFrameCapture::Unpin(int idx)
+{
+    slots_[idx].Pins.fetch_and(~pinMask_, std::memory_order_release);
+}
+
+bool SharedFrameCapture::WaitForNotify(uint32_t notify)
+{
+    // wake up now and then to notice a publisher that died without closing the ring
+    constexpr auto timeout = timespec{ 0, 100 * 1000 * 1000 };
+
+    header_->Waiters.fetch_add(1, std::memory_order_seq_cst);
+    auto ret = 0L;
+    if (header_->Notify.load(std::memory_order_seq_cst) == notify)
+    {
+        ret = syscall(SYS_futex, &header_->Notify, FUTEX_WAIT, notify, &timeout, nullptr, 0);
+    }
+    header_->Waiters.fetch_sub(1, std::memory_order_relaxed);
+
+    return (ret == 0) || (errno != ETIMEDOUT) || IsPublisherAlive();
+}
+
+bool SharedFrameCapture::IsPublisherAlive(void) const
+{
+    return (kill(header_->PublisherPid, 0) == 0) || (errno != ESRCH);
+}
@@ -0,0 +1,75 @@
+#ifndef  H__SHARED_FRAME_CAPTURE__H
+#define  H__SHARED_FRAME_CAPTURE__H
+
+#include  <string>
+#include  <memory>
+#include  <cstdint>
+#include  "ICapturable.hpp"
+#include  "SharedFrameRing.hpp"
+
+// Capture source reading the frames of a SharedFramePublisher, possibly in another process.
+//
+// Frames come in order of their sequence numbers; a client that falls behind the ring skips to the oldest frame
+// still held and counts the frames missed. In zero-copy mode the controller is handed frames pointing into
+// the shared memory (IsZeroCopy), each pinned until the controller drops it; note that the controller keeps up to
+// NumCaptureData frames, so the publisher needs that many slots per zero-copy client and one more.
+// Otherwise Capture copies the frame and unpins it right away. The source ends when the publisher closes the ring
+// or its process is gone. A ring serves up to SharedFrameRing::MaxNumClients clients at once; the client keeps its
+// entry until the last frame it handed out is released.
+class SharedFrameCapture : public ICapturable
+{
+    private:
+        std::shared_ptr<uint8_t> map_;  // unmapped with the last frame referencing it
+        SharedFrameRing::Header* header_;
+        SharedFrameRing::Slot* slots_;
+        FrameFormat format_;
+
+        const bool isZeroCopy_;
+        uint64_t pinMask_;  // bit of this client in the pins of a slot
+        uint64_t lastSequence_;  // frame handed out last
+        uint64_t lastCapturedTime_;
+        uint64_t missed_;
+        uint32_t polls_;  // GetTimeToReady calls since the last frame
+
+        // pins the next frame after lastSequence_ and returns its slot, waiting for it (-1: end of the source)
+        int PinNext(void);
+
+        void Unpin(int idx);
+
+        bool WaitForNotify(uint32_t notify);
+
+        bool IsPublisherAlive(void) const;
+
+    public:
+        explicit SharedFrameCapture(const std::string& name, bool isZeroCopy = true);
+
+        bool IsOpen(void) const { return map_ != nullptr; }
+
+        uint64_t GetLastSequence(void) const { return lastSequence_; }
+
+        // [ns] time stamp given to the last frame by the publishing controller
+        uint64_t GetLastCapturedTime(void) const { return lastCapturedTime_; }
+
+        // frames published after the first one handed out that this client never got
+        uint64_t GetNumMissed(void) const { return missed_; }
+
+        // true if data points into the shared memory of this ring
+        bool Contains(const void* data) const;
+
+        bool Capture(const CaptureDataObject* captureDataObject) override;
+
+        uint64_t GetNBytes() override;
+
+        uint64_t GetLength() override;
+
+        FrameFormat GetFormat() override;
+
+        bool IsZeroCopy() override { return isZeroCopy_; }
+
+        std::shared_ptr<CaptureDataObject> Borrow() override;
+
+        // a shared executor polls the ring instead of waiting on it
+        uint64_t GetTimeToReady() override;
+};
+
+#endif  // H__SHARED_FRAME_CAPTURE__H
@@ -0,0 +1,224 @@
+#include  "SharedFramePublisher.hpp"
+#include  <new>
+#include  <climits>
+#include  <cerrno>
+#include  <csignal>
+#include  <fcntl.h>
+#include  <unistd.h>
+#include  <sys/mman.h>
+#include  <sys/syscall.h>
+#include  <linux/futex.h>
+#include  "Ensuring.hpp"
+#include  "SlotPinning.hpp"
+
+
+/* ----- Public ----- */
+
+SharedFramePublisher::SharedFramePublisher(const std::string& name, const FrameFormat& format, int numSlots)
+    : name_(name), map_(nullptr), sizeOfMap_(0), header_(nullptr), slots_(nullptr), format_(format), cursor_(0),
+      published_(0), skipped_(0), dropped_(0), reclaimed_(0)
+{
+    ThrowExceptionIfOutOfRange(numSlots, 2, 0xffff);
+
+    auto pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    auto sizeOfFrame = format_.GetSizeOfFrame();
+    auto sizeOfSlot = SharedFrameRing::RoundUp(sizeOfFrame, pageSize);
+    auto slotOffset = SharedFrameRing::RoundUp(sizeof(SharedFrameRing::Header), pageSize);
+    auto dataOffset = slotOffset + SharedFrameRing::RoundUp(sizeof(SharedFrameRing::Slot) * numSlots, pageSize);
+
+    if (sizeOfFrame == 0)
+    {
+        return;
+    }
+
+    // a ring of the same name is left over from a publisher that did not close it; its clients keep their mapping
+    shm_unlink(name_.c_str());
+    auto fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    sizeOfMap_ = dataOffset + sizeOfSlot * numSlots;
+    auto map = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(sizeOfMap_)) == 0)
+    {
+        map = mmap(nullptr, sizeOfMap_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);  // the mapping keeps the memory
+    if (map == MAP_FAILED)
+    {
+        shm_unlink(name_.c_str());
+        return;
+    }
+    map_ = static_cast<uint8_t*>(map);
+
+    header_ = new (map_) SharedFrameRing::Header();
+    header_->Version = SharedFrameRing::Version;
+    header_->PageSize = static_cast<uint32_t>(pageSize);
+    header_->Width = format_.Width;
+    header_->Height = format_.Height;
+    header_->NumChannels = format_.NumChannels;
+    header_->NumBytesPerChannel = format_.NumBytesPerChannel;
+    header_->Stride = format_.Stride;
+    header_->IsPlanar = format_.IsPlanar ? 1 : 0;
+    header_->NumSlots = static_cast<uint32_t>(numSlots);
+    header_->SizeOfFrame = sizeOfFrame;
+    header_->SizeOfSlot = sizeOfSlot;
+    header_->SlotOffset = slotOffset;
+    header_->DataOffset = dataOffset;
+    header_->SizeOfMap = sizeOfMap_;
+    header_->PublisherPid = static_cast<int32_t>(getpid());
+
+    slots_ = reinterpret_cast<SharedFrameRing::Slot*>(map_ + slotOffset);
+    for (int idx = 0; idx < numSlots; ++idx)
+    {
+        new (&slots_[idx]) SharedFrameRing::Slot();
+    }
+
+    // the magic goes last, so a client opening the ring now either fails or sees it complete
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->Magic, SharedFrameRing::Magic, sizeof(header_->Magic));
+}
+
+SharedFramePublisher::~SharedFramePublisher()
+{
+    Close();
+}
+
+bool SharedFramePublisher::Publish(const CaptureDataObject* frame, uint64_t capturedTime, uint64_t sequence)
+{
+    if ((map_ == nullptr) || (frame == nullptr) || (frame->Format.GetSizeOfFrame() != header_->SizeOfFrame))
+    {
+        return false;
+    }
+
+    auto numSlots = header_->NumSlots;
+    auto latest = SharedFrameRing::SlotOf(header_->Latest.load(std::memory_order_relaxed));
+    auto isFirst = (header_->Latest.load(std::memory_order_relaxed) == 0);
+
+    for (uint32_t n = 0; n < numSlots; ++n)
+    {
+        auto idx = (cursor_ + n) % numSlots;
+        auto& slot = slots_[idx];
+
+        // the newest frame stays readable until the next one is announced
+        if (!isFirst && (idx == latest))
+        {
+            continue;
+        }
+
+        uint64_t held;
+        if (!SlotPinning::TryClaim(slot.Sequence, slot.Pins, &held))
+        {
+            continue;
+        }
+
+        std::memcpy(map_ + header_->DataOffset + header_->SizeOfSlot * idx, frame->Data, header_->SizeOfFrame);
+        slot.CapturedTime.store(capturedTime, std::memory_order_relaxed);
+        slot.Sequence.store(sequence, std::memory_order_release);
+        header_->Latest.store(SharedFrameRing::Pack(sequence, idx), std::memory_order_release);
+
+        cursor_ = (idx + 1) % numSlots;
+        published_.fetch_add(1, std::memory_order_relaxed);
+        Wake();
+
+        return true;
+    }
+
+    // a client that died holding frames would keep their slots forever
+    if (ReclaimPins() != 0)
+    {
+        return Publish(frame, capturedTime, sequence);
+    }
+
+    skipped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool SharedFramePublisher::Start(MultiThreadCaptureController* controller)
+{
+    if (map_ == nullptr)
+    {
+        return false;
+    }
+
+    return attachment_.Start(controller, [this](const FrameLease& lease){
+            Publish(lease.Get(), lease.GetCapturedTime(), lease.GetSequence());
+        });
+}
+
+void SharedFramePublisher::Stop(void)
+{
+    dropped_.fetch_add(attachment_.Stop(), std::memory_order_relaxed);
+}
+
+void SharedFramePublisher::Close(void)
+{
+    Stop();
+
+    if (map_ != nullptr)
+    {
+        header_->IsClosed.store(1, std::memory_order_release);
+        Wake();
+
+        munmap(map_, sizeOfMap_);
+        shm_unlink(name_.c_str());
+        map_ = nullptr;
+        header_ = nullptr;
+        slots_ = nullptr;
+    }
+}
+
+int SharedFramePublisher::GetNumSlots(void) const
+{
+    return (header_ != nullptr) ? static_cast<int>(header_->NumSlots) : 0;
+}
+
+int SharedFramePublisher::GetNumPinned(void) const
+{
+    auto numPinned = 0;
+    for (int idx = 0; idx < GetNumSlots(); ++idx)
+    {
+        numPinned += (slots_[idx].Pins.load(std::memory_order_relaxed) != 0) ? 1 : 0;
+    }
+    return numPinned;
+}
+
+
+/* ----- Private ----- */
+
+uint64_t SharedFramePublisher::ReclaimPins(void)
+{
+    // only the publisher frees the entry of a dead client, so no client can take it while its bits are cleared
+    uint64_t numReclaimed = 0;
+    for (int client = 0; client < SharedFrameRing::MaxNumClients; ++client)
+    {
+        auto pid = header_->ClientPids[client].load(std::memory_order_acquire);
+        if ((pid == 0) || (kill(pid, 0) == 0) || (errno != ESRCH))
+        {
+            continue;
+        }
+
+        auto mask = 1ULL << client;
+        for (uint32_t idx = 0; idx < header_->NumSlots; ++idx)
+        {
+            numReclaimed += ((slots_[idx].Pins.fetch_and(~mask, std::memory_order_acq_rel) & mask) != 0) ? 1 : 0;
+        }
+        header_->ClientPids[client].store(0, std::memory_order_release);
+    }
+
+    reclaimed_.fetch_add(numReclaimed, std::memory_order_relaxed);
+    return numReclaimed;
+}
+
+void SharedFramePublisher::Wake(void)
+{
+    // pairs with the client raising Waiters before it reads Notify: either we see the waiter or it sees the new count
+    header_->Notify.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->Waiters.load(std::memory_order_seq_cst) != 0)
+    {
+        // shared (not private) futex, as the waiters are in other processes
+        syscall(SYS_futex, &header_->Notify, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef  H__SHARED_FRAME_PUBLISHER__H
+#define  H__SHARED_FRAME_PUBLISHER__H
+
+#include  <string>
+#include  <atomic>
+#include  <cstdint>
+#include  "AttachedConsumer.hpp"
+#include  "CaptureDataObject.hpp"
+#include  "FrameFormat.hpp"
+#include  "SharedFrameRing.hpp"
+
+class MultiThreadCaptureController;
+
+// Publisher of frames to other processes through a POSIX shared memory ring (SharedFrameRing).
+//
+// The ring is created under name (e.g. "/camera0") with numSlots page-aligned slots, replacing a ring left behind
+// by a publisher that died; SharedFrameCapture opens it in any number of processes on the host. Each frame is
+// copied into the ring once, whatever the number of clients. A slot pinned by a client is passed over, never waited
+// for, so a stuck client costs the publisher slots but not time; when no slot is left, the pins of clients whose
+// process has died are taken back. Start publishes every frame of a controller
+// through an AttachedConsumer.
+class SharedFramePublisher
+{
+    private:
+        std::string name_;
+        uint8_t* map_;
+        uint64_t sizeOfMap_;
+        SharedFrameRing::Header* header_;
+        SharedFrameRing::Slot* slots_;
+        FrameFormat format_;
+        uint32_t cursor_;  // slot tried first for the next frame (owned by the publishing thread)
+
+        AttachedConsumer attachment_;
+
+        std::atomic<uint64_t> published_;
+        std::atomic<uint64_t> skipped_;  // frames not published as every free slot was pinned
+        std::atomic<uint64_t> dropped_;  // frames missed by the consumer
+        std::atomic<uint64_t> reclaimed_;  // pins taken back from clients that died
+
+        uint64_t ReclaimPins(void);
+
+        void Wake(void);
+
+    public:
+        SharedFramePublisher(const std::string& name, const FrameFormat& format, int numSlots = 16);
+
+        // closes the ring: clients get the end of the source after the frames they hold
+        ~SharedFramePublisher();
+
+        SharedFramePublisher(const SharedFramePublisher&) = delete;
+
+        SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+
+        bool IsOpen(void) const { return map_ != nullptr; }
+
+        // false if every slot but the newest is pinned or the frame does not have the published format
+        bool Publish(const CaptureDataObject* frame, uint64_t capturedTime, uint64_t sequence);
+
+        // publishes the frames of controller from now on until Stop; the controller must outlive the publishing
+        bool Start(MultiThreadCaptureController* controller);
+
+        void Stop(void);
+
+        // tells the clients that no frame will follow and removes the name; mapped clients keep the memory
+        void Close(void);
+
+        const std::string& GetName(void) const { return name_; }
+
+        int GetNumSlots(void) const;
+
+        // slots pinned by clients right now
+        int GetNumPinned(void) const;
+
+        uint64_t GetNumPublished(void) const { return published_.load(std::memory_order_relaxed); }
+
+        uint64_t GetNumSkipped(void) const { return skipped_.load(std::memory_order_relaxed); }
+
+        uint64_t GetNumDropped(void) const { return dropped_.load(std::memory_order_relaxed); }
+
+        uint64_t GetNumReclaimed(void) const { return reclaimed_.load(std::memory_order_relaxed); }
+};
+
+#endif  // H__SHARED_FRAME_PUBLISHER__H
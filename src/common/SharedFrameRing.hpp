@@ -0,0 +1,112 @@
+#ifndef  H__SHARED_FRAME_RING__H
+#define  H__SHARED_FRAME_RING__H
+
+#include  <atomic>
+#include  <cstdint>
+#include  <cstring>
+#include  "FrameFormat.hpp"
+
+// Shared memory layout between SharedFramePublisher and SharedFrameCapture.
+//
+//   [header page][slots: NumSlots x Slot, page aligned][frames: NumSlots x SizeOfSlot]
+//
+// The publisher copies each frame into a slot no client has pinned and then announces it in Latest; clients pin
+// a slot, check that it still holds the frame they chose and read it in place. Nobody ever waits on a lock:
+// the publisher passes over pinned slots, and a client that finds its slot reused picks again.
+// Everything shared is a lock-free atomic, so the layout works across processes.
+// Each client takes an entry of ClientPids and pins with its own bit, so that the publisher can take back
+// the pins of a client whose process died holding them.
+namespace SharedFrameRing
+{
+    constexpr char Magic[8] = { 'M', 'T', 'C', 'S', 'H', 'M', '\0', '\0' };
+    constexpr uint32_t Version = 2;
+    constexpr int MaxNumClients = 64;  // one bit of Slot::Pins each
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free
+                  && std::atomic<int32_t>::is_always_lock_free,
+                  "the shared header needs address-free atomics");
+
+    struct Header
+    {
+        char Magic[8];  // written last by the publisher, so a client never maps a half initialized ring
+        uint32_t Version;
+        uint32_t PageSize;
+
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t NumChannels;
+        uint32_t NumBytesPerChannel;
+        uint64_t Stride;
+        uint32_t IsPlanar;
+        uint32_t NumSlots;
+
+        uint64_t SizeOfFrame;  // bytes used in a slot
+        uint64_t SizeOfSlot;  // multiple of PageSize
+        uint64_t SlotOffset;
+        uint64_t DataOffset;
+        uint64_t SizeOfMap;
+
+        int32_t PublisherPid;  // lets clients notice a publisher that died without closing
+        uint32_t Reserved;
+
+        alignas(64) std::atomic<uint64_t> Latest;  // Pack(sequence, slot) of the newest frame (0: none yet)
+        std::atomic<uint32_t> Notify;  // futex word, counted up with every frame and on close
+        std::atomic<uint32_t> Waiters;  // clients sleeping on Notify
+        std::atomic<uint32_t> IsClosed;  // no frame will follow
+
+        std::atomic<int32_t> ClientPids[MaxNumClients];  // process of each client (0: entry free)
+    };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> Sequence;  // frame held (0 while empty or being written)
+        std::atomic<uint64_t> CapturedTime;  // [ns] time stamp given by the controller
+        std::atomic<uint64_t> Pins;  // clients reading the frame, bit n for the client of ClientPids[n]
+    };
+
+    inline uint64_t Pack(uint64_t sequence, uint32_t slot)
+    {
+        return (sequence << 16) | slot;
+    }
+
+    inline uint64_t SequenceOf(uint64_t latest)
+    {
+        return latest >> 16;
+    }
+
+    inline uint32_t SlotOf(uint64_t latest)
+    {
+        return static_cast<uint32_t>(latest & 0xffff);
+    }
+
+    inline uint64_t RoundUp(uint64_t value, uint64_t unit)
+    {
+        return (value + unit - 1) / unit * unit;
+    }
+
+    inline FrameFormat GetFormat(const Header& header)
+    {
+        auto format = FrameFormat{};
+        format.Width = header.Width;
+        format.Height = header.Height;
+        format.NumChannels = header.NumChannels;
+        format.NumBytesPerChannel = header.NumBytesPerChannel;
+        format.Stride = header.Stride;
+        format.IsPlanar = (header.IsPlanar != 0);
+        return format;
+    }
+
+    inline bool IsValid(const Header& header, uint64_t sizeOfMap)
+    {
+        return (std::memcmp(header.Magic, Magic, sizeof(Magic)) == 0)
+            && (header.Version == Version)
+            && (header.NumSlots != 0) && (header.NumSlots <= 0xffff)
+            && (header.SizeOfFrame == GetFormat(header).GetSizeOfFrame())
+            && (header.SizeOfSlot >= header.SizeOfFrame)
+            && (header.SlotOffset + sizeof(Slot) * header.NumSlots <= header.DataOffset)
+            && (header.DataOffset + header.SizeOfSlot * header.NumSlots <= sizeOfMap)
+            && (header.SizeOfMap == sizeOfMap);
+    }
+}
+
+#endif  // H__SHARED_FRAME_RING__H
@@ -0,0 +1,53 @@
+#ifndef  H__SLOT_PINNING__H
+#define  H__SLOT_PINNING__H
+
+#include  <atomic>
+#include  <cstdint>
+
+// Handshake between one producer writing slots in place and readers pinning them, shared by FrameRing,
+// FrameWindowBuffer and SharedFrameRing (whose slots live in shared memory, hence the free functions).
+//
+// A slot holds the sequence number of its frame (0 while empty or being written) and a pin word, non-zero while
+// readers hold it. The producer invalidates the sequence before it checks the pins, and a reader raises its pin
+// before it checks the sequence, both in seq_cst order, so either the producer sees the pin and leaves the slot
+// alone or the reader sees the slot change and lets it go. Writing the frame needs no fence of its own:
+// the release store of the new sequence publishes it, and a reader's unpin orders its reads before the next claim.
+namespace SlotPinning
+{
+    // Producer: takes a slot no reader holds for writing, *held is the sequence it held until now.
+    // False, with the slot left as it was, if a reader holds it or pins it meanwhile.
+    template <typename PinWord>
+    inline bool TryClaim(std::atomic<uint64_t>& sequence, const std::atomic<PinWord>& pins, uint64_t* held)
+    {
+        if (pins.load(std::memory_order_acquire) != 0)
+        {
+            return false;
+        }
+
+        *held = sequence.load(std::memory_order_relaxed);
+        sequence.store(0, std::memory_order_seq_cst);
+        if (pins.load(std::memory_order_seq_cst) != 0)
+        {
+            sequence.store(*held, std::memory_order_release);
+            return false;
+        }
+
+        return true;
+    }
+
+    // Reader, right after raising its pin with a seq_cst read-modify-write: true if the slot still holds expected.
+    // The pin is the caller's to drop in either case.
+    inline bool IsStillHeld(const std::atomic<uint64_t>& sequence, uint64_t expected)
+    {
+        return sequence.load(std::memory_order_seq_cst) == expected;
+    }
+
+    // Reader of a slot whose pin word is a count
+    inline bool PinIfHeld(const std::atomic<uint64_t>& sequence, std::atomic<uint32_t>& pins, uint64_t expected)
+    {
+        pins.fetch_add(1, std::memory_order_seq_cst);
+        return IsStillHeld(sequence, expected);
+    }
+}
+
+#endif  // H__SLOT_PINNING__H
@@ -0,0 +1,142 @@
+#include  "SyntheticCapture.hpp"
+#include  <thread>
+#include  <chrono>
+#include  <cstring>
+
+
+/* ----- Public ----- */
+
+SyntheticCapture::SyntheticCapture(
+    uint32_t width,
+    uint32_t height,
+    uint32_t numChannels,
+    double fps,
+    int jitter_us,
+    uint64_t numFrames,
+    uint64_t seed
+) :
+    format_{ width, height, numChannels, 1, 0 },
+    fps_(fps), jitter_us_(jitter_us), numFrames_(numFrames),
+    count_(0), retrieved_(0), grabbedTime_(0), startTime_(0), nextDue_(0), random_(seed)
+{
+    if (format_.GetSizeOfFrame() < sizeof(Stamp))
+    {
+        throw new std::exception();
+    }
+}
+
+bool SyntheticCapture::Capture(const CaptureDataObject* captureDataObject)
+{
+    return Grab() && Retrieve(captureDataObject);
+}
+
+bool SyntheticCapture::Grab()
+{
+    if ((numFrames_ != 0) && (count_ == numFrames_))
+    {
+        return false;
+    }
+
+    auto due = (nextDue_ != 0) ? nextDue_ : GetDueTime();
+    nextDue_ = 0;
+    auto now = GetTimeAsNs();
+    if (due > now)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+    }
+    ++count_;
+    grabbedTime_ = (fps_ > 0.0) ? due : GetTimeAsNs();
+
+    return true;
+}
+
+bool SyntheticCapture::Retrieve(const CaptureDataObject* captureDataObject)
+{
+    if (count_ == 0)
+    {
+        return false;
+    }
+    ++retrieved_;
+
+    // touch the whole frame as a camera driver or a decoder would
+    auto data = static_cast<uint8_t*>(const_cast<void*>(captureDataObject->Data));
+    std::memset(data, static_cast<int>(count_ & 0xff), captureDataObject->Format.GetSizeOfFrame());
+
+    auto stamp = Stamp{ static_cast<uint32_t>(count_), 0, grabbedTime_ };
+    std::memcpy(data, &stamp, sizeof(stamp));
+
+    return true;
+}
+
+uint64_t SyntheticCapture::GetTimeToReady()
+{
+    if ((fps_ <= 0.0) || ((numFrames_ != 0) && (count_ == numFrames_)))
+    {
+        return 0;
+    }
+
+    // draw the due time (and its jitter) once, so that Grab waits for the same time
+    if (nextDue_ == 0)
+    {
+        nextDue_ = GetDueTime();
+    }
+    auto now = GetTimeAsNs();
+    return (nextDue_ > now) ? nextDue_ - now : 0;
+}
+
+uint64_t SyntheticCapture::GetNBytes()
+{
+    return sizeof(uint8_t);
+}
+
+uint64_t SyntheticCapture::GetLength()
+{
+    return format_.GetSizeOfFrame();
+}
+
+FrameFormat SyntheticCapture::GetFormat()
+{
+    return format_;
+}
+
+SyntheticCapture::Stamp SyntheticCapture::StampOf(const CaptureDataObject* captureDataObject)
+{
+    auto stamp = Stamp{};
+    std::memcpy(&stamp, captureDataObject->Data, sizeof(stamp));
+    return stamp;
+}
+
+uint64_t SyntheticCapture::GetTimeAsNs(void)
+{
+    return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+}
+
+
+/* ----- Private ----- */
+
+uint64_t SyntheticCapture::GetDueTime(void)
+{
+    if (fps_ <= 0.0)
+    {
+        return 0;
+    }
+
+    if (count_ == 0)
+    {
+        startTime_ = GetTimeAsNs();
+    }
+
+    // the schedule does not drift: jitter moves one frame, not the ones after it
+    auto due = startTime_ + static_cast<uint64_t>(count_ * 1e9 / fps_);
+    if (jitter_us_ > 0)
+    {
+        auto jitter = std::uniform_int_distribution<int64_t>(-jitter_us_, jitter_us_)(random_) * 1000;
+        due = ((jitter < 0) && (static_cast<uint64_t>(-jitter) > due - startTime_)) ? startTime_ : due + jitter;
+    }
+
+    return due;
+}
@@ -0,0 +1,76 @@
+#ifndef  H__SYNTHETIC_CAPTURE__H
+#define  H__SYNTHETIC_CAPTURE__H
+
+#include  <random>
+#include  <cstdint>
+#include  "ICapturable.hpp"
+
+// Capture source generating frames on a schedule, for measuring the controller without a camera or a movie.
+//
+// Frame n is due at n / fps after the first Capture, shifted by a uniform jitter of up to +-jitter_us, and Capture
+// sleeps until it is due (fps 0: no pacing). The whole frame is filled with the low byte of its number, and
+// the head carries the frame number and the due time, so readers can check order and measure latency end to end.
+// Capture is split into Grab (the wait) and Retrieve (the fill) for the controller's lazy mode.
+class SyntheticCapture : public ICapturable
+{
+    public:
+        // what Capture writes at the head of each frame
+        struct Stamp
+        {
+            uint32_t Number;  // 1 for the first frame
+            uint32_t Reserved;
+            uint64_t Time;  // [ns] due time on the steady clock
+        };
+
+    private:
+        FrameFormat format_;
+        double fps_;
+        int jitter_us_;
+        uint64_t numFrames_;  // frames until the end of the source (0: endless)
+
+        uint64_t count_;
+        uint64_t retrieved_;
+        uint64_t grabbedTime_;  // [ns] time stamped on the frame grabbed last
+        uint64_t startTime_;  // [ns] due time of the first frame
+        uint64_t nextDue_;  // [ns] due time of the next frame once GetTimeToReady drew it (0: not drawn yet)
+        std::mt19937_64 random_;
+
+        uint64_t GetDueTime(void);
+
+    public:
+        SyntheticCapture(
+            uint32_t width,
+            uint32_t height,
+            uint32_t numChannels = 3,
+            double fps = 30.0,
+            int jitter_us = 0,
+            uint64_t numFrames = 0,
+            uint64_t seed = 0
+        );
+
+        bool Capture(const CaptureDataObject* captureDataObject) override;
+
+        bool IsGrabbable() override { return true; }
+
+        bool Grab() override;
+
+        bool Retrieve(const CaptureDataObject* captureDataObject) override;
+
+        uint64_t GetTimeToReady() override;
+
+        uint64_t GetNBytes() override;
+
+        uint64_t GetLength() override;
+
+        FrameFormat GetFormat() override;
+
+        uint64_t GetNumCaptured(void) const { return count_; }
+
+        uint64_t GetNumRetrieved(void) const { return retrieved_; }
+
+        static Stamp StampOf(const CaptureDataObject* captureDataObject);
+
+        static uint64_t GetTimeAsNs(void);
+};
+
+#endif  // H__SYNTHETIC_CAPTURE__H
@@ -0,0 +1,70 @@
+#include  "ThreadPool.hpp"
+#include  "Ensuring.hpp"
+
+
+/* ----- Public ----- */
+
+ThreadPool::ThreadPool(int numThreads)
+    : isQuit_(false)
+{
+    ThrowExceptionIfZero(numThreads);
+
+    for (int idx = 0; idx < numThreads; ++idx)
+    {
+        threads_.emplace_back(&ThreadPool::Main, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        isQuit_ = true;
+    }
+    cvar_.notify_all();
+
+    for (auto& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void(void)> task)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        tasks_.push_back(std::move(task));
+    }
+    cvar_.notify_one();
+}
+
+int ThreadPool::GetNumThreads(void) const
+{
+    return static_cast<int>(threads_.size());
+}
+
+
+/* ----- Private ----- */
+
+void ThreadPool::Main(void)
+{
+    while (true)
+    {
+        auto task = std::function<void(void)>{};
+        {
+            auto lk = std::unique_lock<std::mutex>(mtx_);
+            cvar_.wait(lk, [this]{ return isQuit_ || !tasks_.empty(); });
+
+            if (tasks_.empty())
+            {
+                // isQuit_ and nothing left to run
+                return;
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+    }
+}
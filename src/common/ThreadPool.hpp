@@ -0,0 +1,39 @@
+#ifndef  H__THREAD_POOL__H
+#define  H__THREAD_POOL__H
+
+#include  <thread>
+#include  <mutex>
+#include  <condition_variable>
+#include  <functional>
+#include  <deque>
+#include  <vector>
+
+// Fixed number of worker threads running submitted tasks in FIFO order
+class ThreadPool
+{
+    private:
+        std::vector<std::thread> threads_;
+
+        std::mutex mtx_;
+        std::condition_variable cvar_;
+        std::deque<std::function<void(void)>> tasks_;
+        bool isQuit_;
+
+        void Main(void);
+
+    public:
+        explicit ThreadPool(int numThreads);
+
+        // runs the tasks already submitted, then joins the workers
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void Submit(std::function<void(void)> task);
+
+        int GetNumThreads(void) const;
+};
+
+#endif  // H__THREAD_POOL__H
@@ -52,7 +52,34 @@ CvCapture::~CvCapture()
 bool CvCapture::Capture(const CaptureDataObject * captureDataObject)
 {
     auto data = (uint8_t*)(captureDataObject->Data);
-    return this->capture(data, width_, height_, nChannel_);
+    auto& format = captureDataObject->Format;
+
+    // buffers described only by their length are taken as packed rows
+    auto isImage = ((int)format.Width == width_) && ((int)format.Height == height_);
+    auto stride = isImage ? format.GetStride() : (uint64_t)cv::Mat::AUTO_STEP;
+
+    return this->capture(data, width_, height_, nChannel_, stride);
+}
+
+bool CvCapture::IsGrabbable()
+{
+    return cap_.isOpened();
+}
+
+bool CvCapture::Grab()
+{
+    return cap_.isOpened() && cap_.grab();
+}
+
+bool CvCapture::Retrieve(const CaptureDataObject * captureDataObject)
+{
+    auto data = (uint8_t*)(captureDataObject->Data);
+    auto& format = captureDataObject->Format;
+
+    auto isImage = ((int)format.Width == width_) && ((int)format.Height == height_);
+    auto stride = isImage ? format.GetStride() : (uint64_t)cv::Mat::AUTO_STEP;
+
+    return this->capture(data, width_, height_, nChannel_, stride, true);
 }
 
 uint64_t CvCapture::GetNBytes()
@@ -62,7 +89,18 @@ uint64_t CvCapture::GetNBytes()
 
 uint64_t CvCapture::GetLength()
 {
-    return width_ * height_;
+    return width_ * height_ * nChannel_;
+}
+
+FrameFormat CvCapture::GetFormat()
+{
+    auto format = FrameFormat{};
+    format.Width = width_;
+    format.Height = height_;
+    format.NumChannels = nChannel_;
+    format.NumBytesPerChannel = nBytesOfChannel_;
+    format.Stride = format.GetRowBytes();
+    return format;
 }
 
 /* ----- Private ----- */
@@ -119,7 +157,7 @@ bool CvCapture::init(const std::string& filename)
 	return isSuccess;
 }
 
-bool CvCapture::capture(uint8_t* const image, int width, int height, int nChannel)
+bool CvCapture::capture(uint8_t* const image, int width, int height, int nChannel, uint64_t stride, bool isGrabbed)
 {
 	assert(width == width_);
 	assert(height == height_);
@@ -130,8 +168,21 @@ bool CvCapture::capture(uint8_t* const image, int width, int height, int nChanne
 		return false;
 	}
 
-	auto mat = cv::Mat(height, width, CV_8UC3, (void *)image);
-	auto ret = cap_.read(mat);
+	auto depth = (nBytesOfChannel_ == sizeof(uint16_t)) ? CV_16U : CV_8U;
+	auto mat = cv::Mat(height, width, CV_MAKETYPE(depth, nChannel), (void *)image, stride);
+	auto ret = isGrabbed ? cap_.retrieve(mat) : cap_.read(mat);
+
+	if (ret && (mat.data != image))
+	{
+		// the decoder did not write into our buffer (e.g. its output differs from the configured format)
+		auto dst = cv::Mat(height, width, CV_MAKETYPE(depth, nChannel), (void *)image, stride);
+		if ((mat.size() != dst.size()) || (mat.type() != dst.type()))
+		{
+			if (isDebug_) std::cout << "unexpected frame format: " << mat.cols << "x" << mat.rows << " type=" << mat.type() << std::endl;
+			return false;
+		}
+		mat.copyTo(dst);
+	}
 
 	return ret;
 }
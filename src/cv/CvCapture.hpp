@@ -37,7 +37,7 @@ class CvCapture : public ICapturable
 			const std::string& filename
 		);
 
-		bool capture(uint8_t* const image, int image_width, int image_height, int num_channel);
+		bool capture(uint8_t* const image, int image_width, int image_height, int num_channel, uint64_t stride, bool isGrabbed = false);
 
 		std::tuple<int, int, int, int> get_size(void);
 
@@ -60,9 +60,18 @@ class CvCapture : public ICapturable
 
 		bool Capture(const CaptureDataObject *) override;
 
+		// grab() only dequeues the frame; retrieve() decodes and converts the one grabbed last
+		bool IsGrabbable() override;
+
+		bool Grab() override;
+
+		bool Retrieve(const CaptureDataObject *) override;
+
         uint64_t GetNBytes() override;
 
         uint64_t GetLength() override;
+
+        FrameFormat GetFormat() override;
 };
 
 #endif  /* H__CAPTURE_CV__H */
@@ -0,0 +1,62 @@
+#include  <algorithm>
+#include  <cctype>
+#include  "CvImageEncoder.hpp"
+
+
+/* ----- Public ----- */
+
+CvImageEncoder::CvImageEncoder(
+	const std::string& extension,
+	int quality
+)
+	: extension_(extension)
+{
+	auto lower = extension_;
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c){ return std::tolower(c); });
+
+	if (quality >= 0)
+	{
+		if ((lower == ".jpg") || (lower == ".jpeg"))
+		{
+			params_ = { cv::IMWRITE_JPEG_QUALITY, std::min(quality, 100) };
+		}
+		else if (lower == ".png")
+		{
+			params_ = { cv::IMWRITE_PNG_COMPRESSION, std::min(quality, 9) };
+		}
+	}
+}
+
+CvImageEncoder::~CvImageEncoder()
+{
+}
+
+std::string CvImageEncoder::GetExtension()
+{
+	return extension_;
+}
+
+bool CvImageEncoder::Encode(const CaptureDataObject * frame, std::vector<uint8_t>& encoded)
+{
+	auto& format = frame->Format;
+	if (format.IsPlanar || ((format.NumBytesPerChannel != 1) && (format.NumBytesPerChannel != 2)))
+	{
+		return false;
+	}
+
+	auto depth = (format.NumBytesPerChannel == 1) ? CV_8U : CV_16U;
+	auto image = cv::Mat(
+		(int)format.Height, (int)format.Width, CV_MAKETYPE(depth, (int)format.NumChannels),
+		const_cast<void*>(frame->Data), (size_t)format.GetStride()
+	);
+
+	try
+	{
+		return cv::imencode(extension_, image, encoded, params_);
+	}
+	catch (const cv::Exception&)
+	{
+		// format or channel count the codec does not take
+		return false;
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef  H__CV_IMAGE_ENCODER__H
+#define  H__CV_IMAGE_ENCODER__H
+
+#include  <string>
+#include  <vector>
+#include  <cstdint>
+#include  "opencv2/opencv.hpp"
+#include  "common/IFrameEncoder.hpp"
+
+// JPEG, PNG or any other format cv::imencode knows, chosen by the extension (".jpg", ".png", ...).
+//
+// quality is the JPEG quality (0 - 100) for JPEG and the compression level (0 - 9) for PNG; -1 keeps OpenCV's default.
+// Frames of 1 or 2 bytes per channel with interleaved channels are supported, planar frames are not.
+class CvImageEncoder : public IFrameEncoder
+{
+	private:
+		std::string extension_;
+		std::vector<int> params_;
+
+	public:
+		CvImageEncoder(
+			const std::string& extension,
+			int quality = -1
+		);
+
+		~CvImageEncoder();
+
+		std::string GetExtension() override;
+
+		bool Encode(const CaptureDataObject *, std::vector<uint8_t>& encoded) override;
+};
+
+#endif  /* H__CV_IMAGE_ENCODER__H */
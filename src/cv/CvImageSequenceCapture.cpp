@@ -0,0 +1,331 @@
+#include  <iostream>
+#include  <fstream>
+#include  <filesystem>
+#include  <algorithm>
+#include  <cstdio>
+#include  <cstring>
+#include  <cctype>
+#include  "CvImageSequenceCapture.hpp"
+
+static const std::string imageExtensions_ = " .png .jpg .jpeg .bmp .tif .tiff .webp .pgm .ppm ";
+
+// counts the conversions of a printf pattern given to snprintf with one int;
+// -1 if it has a directive other than %% and an int conversion (flags, width and precision but no '*' or length)
+static int countIndexConversions(const std::string& pattern)
+{
+	auto numConversions = 0;
+	for (size_t idx = 0; idx < pattern.size(); ++idx)
+	{
+		if (pattern[idx] != '%')
+		{
+			continue;
+		}
+
+		if ((++idx < pattern.size()) && (pattern[idx] == '%'))
+		{
+			continue;
+		}
+
+		while ((idx < pattern.size()) && (std::strchr("-+ #0", pattern[idx]) != nullptr))
+		{
+			++idx;
+		}
+		while ((idx < pattern.size()) && std::isdigit((unsigned char)pattern[idx]))
+		{
+			++idx;
+		}
+		if ((idx < pattern.size()) && (pattern[idx] == '.'))
+		{
+			do
+			{
+				++idx;
+			} while ((idx < pattern.size()) && std::isdigit((unsigned char)pattern[idx]));
+		}
+
+		if ((idx >= pattern.size()) || (std::strchr("diouxX", pattern[idx]) == nullptr))
+		{
+			return -1;
+		}
+		++numConversions;
+	}
+
+	return numConversions;
+}
+
+
+/* ----- Public ----- */
+
+CvImageSequenceCapture::CvImageSequenceCapture(
+	const std::string& path,
+	int numThreads,
+	int readAhead,
+	uint64_t memoryBudget,
+	int firstIndex,
+	bool isDebug
+)
+	: isDebug_(isDebug),
+	  width_(-1), height_(-1), nChannel_(-1), nBytesOfChannel_(-1),
+	  next_(0), isCancelled_(false), numFailed_(0)
+{
+	numThreads = std::max(numThreads, 1);
+
+	if (!init(path, firstIndex))
+	{
+		// Capture fails right away, as CvCapture does for a file it cannot open
+		files_.clear();
+		return;
+	}
+
+	auto numSlots = (readAhead > 0) ? readAhead : 2 * numThreads;
+	if (memoryBudget != 0)
+	{
+		auto sizeOfImage = GetFormat().GetSizeOfFrame();
+		numSlots = std::min<uint64_t>(numSlots, std::max<uint64_t>(memoryBudget / sizeOfImage, 1));
+	}
+
+	window_.resize(numSlots);
+	for (auto& slot : window_)
+	{
+		slot.Index = -1;
+		slot.State = SlotState::Empty;
+	}
+
+	decoders_ = std::unique_ptr<ThreadPool>(new ThreadPool(numThreads));
+	for (int idx = 0; idx < numSlots; ++idx)
+	{
+		prefetch(idx);
+	}
+}
+
+CvImageSequenceCapture::~CvImageSequenceCapture()
+{
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		isCancelled_ = true;
+	}
+
+	decoders_.reset();
+}
+
+bool CvImageSequenceCapture::Capture(const CaptureDataObject * captureDataObject)
+{
+	// an image that fails to decode is passed over, so that one broken file does not end the sequence
+	while (next_ < (int)files_.size())
+	{
+		auto index = next_++;
+		auto& slot = window_[index % window_.size()];
+		{
+			auto lk = std::unique_lock<std::mutex>(mtx_);
+			cvar_.wait(lk, [&slot]{ return (slot.State == SlotState::Ready) || (slot.State == SlotState::Failed); });
+		}
+
+		auto ret = (slot.State == SlotState::Ready);
+		if (ret)
+		{
+			// the slot is ours until it is handed back to the decoders below
+			auto& format = captureDataObject->Format;
+			auto isImage = ((int)format.Width == width_) && ((int)format.Height == height_);
+			auto stride = isImage ? format.GetStride() : (uint64_t)cv::Mat::AUTO_STEP;
+			auto dst = cv::Mat(height_, width_, CV_8UC3, const_cast<void*>(captureDataObject->Data), stride);
+			slot.Decoded.copyTo(dst);
+		}
+		else
+		{
+			numFailed_.fetch_add(1, std::memory_order_relaxed);
+			if (isDebug_)
+			{
+				std::cout << "fail to decode " << files_[index] << std::endl;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lk(mtx_);
+			slot.State = SlotState::Empty;
+		}
+
+		prefetch(index + (int)window_.size());
+
+		if (ret)
+		{
+			return true;
+		}
+	}
+
+	// end of the sequence
+	return false;
+}
+
+uint64_t CvImageSequenceCapture::GetNBytes()
+{
+	return sizeof(std::uint8_t);
+}
+
+uint64_t CvImageSequenceCapture::GetLength()
+{
+	return width_ * height_ * nChannel_;
+}
+
+FrameFormat CvImageSequenceCapture::GetFormat()
+{
+	auto format = FrameFormat{};
+	format.Width = width_;
+	format.Height = height_;
+	format.NumChannels = nChannel_;
+	format.NumBytesPerChannel = nBytesOfChannel_;
+	format.Stride = format.GetRowBytes();
+	return format;
+}
+
+int CvImageSequenceCapture::GetNumImages(void) const
+{
+	return (int)files_.size();
+}
+
+int CvImageSequenceCapture::GetReadAhead(void) const
+{
+	return (int)window_.size();
+}
+
+int CvImageSequenceCapture::GetNumFailed(void) const
+{
+	return numFailed_.load(std::memory_order_relaxed);
+}
+
+
+/* ----- Private ----- */
+
+bool CvImageSequenceCapture::init(const std::string& path, int firstIndex)
+{
+	namespace fs = std::filesystem;
+
+	auto ec = std::error_code{};
+	if (fs::is_directory(path, ec))
+	{
+		for (auto& entry : fs::directory_iterator(path, ec))
+		{
+			auto extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+			if (entry.is_regular_file() && (imageExtensions_.find(" " + extension + " ") != std::string::npos))
+			{
+				files_.push_back(entry.path().string());
+			}
+		}
+
+		// zero-padded numbers sort by name
+		std::sort(files_.begin(), files_.end());
+	}
+	else if (countIndexConversions(path) == 1)
+	{
+		char name[4096];
+		for (auto idx = firstIndex; ; ++idx)
+		{
+			std::snprintf(name, sizeof(name), path.c_str(), idx);
+			if (!fs::exists(name, ec) || (!files_.empty() && (files_.back() == name)))
+			{
+				// a missing number ends the sequence (as does a name cut short by the buffer)
+				break;
+			}
+			files_.push_back(name);
+		}
+	}
+	else if ((path.find('%') == std::string::npos) && fs::is_regular_file(path, ec))
+	{
+		// a plain file name is a sequence of one image
+		files_.push_back(path);
+	}
+	else if (isDebug_)
+	{
+		std::cout << path << ": neither a directory nor a pattern with one integer conversion" << std::endl;
+	}
+
+	if (files_.empty())
+	{
+		std::cout << "fail to open" << std::endl;
+		return false;
+	}
+
+	// the first image fixes the format of the sequence
+	auto first = cv::imread(files_.front(), cv::IMREAD_COLOR);
+	if (first.empty())
+	{
+		std::cout << "fail to open" << std::endl;
+		return false;
+	}
+
+	width_ = first.cols;
+	height_ = first.rows;
+	nChannel_ = 3;
+	nBytesOfChannel_ = sizeof(uint8_t);
+
+	if (isDebug_)
+	{
+		std::cout << path << ": " << files_.size() << " images of " << width_ << "x" << height_ << std::endl;
+	}
+
+	return true;
+}
+
+void CvImageSequenceCapture::prefetch(int index)
+{
+	if (index >= (int)files_.size())
+	{
+		return;
+	}
+
+	auto& slot = window_[index % window_.size()];
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		slot.Index = index;
+		slot.State = SlotState::Decoding;
+	}
+
+	decoders_->Submit([this, index]{ decode(index); });
+}
+
+void CvImageSequenceCapture::decode(int index)
+{
+	auto& slot = window_[index % window_.size()];
+
+	auto isSuccess = false;
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		if (isCancelled_)
+		{
+			return;
+		}
+	}
+
+	auto file = std::ifstream(files_[index], std::ios::binary | std::ios::ate);
+	if (file)
+	{
+		slot.Encoded.resize(file.tellg());
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(slot.Encoded.data()), slot.Encoded.size());
+	}
+
+	// imdecode leaves its destination as it was when it fails early, so the previous image of the slot
+	// would pass for this one: decode into a new Mat. It also throws on some broken files, which must not
+	// escape into the decoder thread
+	slot.Decoded.release();
+	if (file && !slot.Encoded.empty())
+	{
+		try
+		{
+			slot.Decoded = cv::imdecode(slot.Encoded, cv::IMREAD_COLOR);
+			isSuccess = !slot.Decoded.empty() && (slot.Decoded.cols == width_) && (slot.Decoded.rows == height_);
+		}
+		catch (const cv::Exception& e)
+		{
+			if (isDebug_)
+			{
+				std::cout << files_[index] << ": " << e.what() << std::endl;
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		slot.State = isSuccess ? SlotState::Ready : SlotState::Failed;
+	}
+	cvar_.notify_all();
+}
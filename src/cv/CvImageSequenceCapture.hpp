@@ -0,0 +1,92 @@
+#ifndef  H__CV_IMAGE_SEQUENCE_CAPTURE__H
+#define  H__CV_IMAGE_SEQUENCE_CAPTURE__H
+
+#include  <string>
+#include  <vector>
+#include  <memory>
+#include  <atomic>
+#include  <mutex>
+#include  <condition_variable>
+#include  <cstdint>
+#include  "opencv2/opencv.hpp"
+#include  "common/ICapturable.hpp"
+#include  "common/ThreadPool.hpp"
+
+// Numbered image files (PNG, JPEG, ...) as a capture source.
+//
+// path is either a directory, whose images are taken in file name order, or a printf pattern such as
+// "dump/frame_%06d.png" counted up from firstIndex until a file is missing. A pattern must hold exactly one
+// integer conversion and no other directive but %%; a path with no '%' at all names a single image.
+// Images that fail to decode are passed over and counted (GetNumFailed).
+// The next images are read (into reused buffers) and decoded ahead on a thread pool into a window of slots;
+// the window holds readAhead images at most and no more than memoryBudget bytes of decoded pixels.
+class CvImageSequenceCapture : public ICapturable
+{
+	private:
+		enum class SlotState : int
+		{
+			Empty,
+			Decoding,
+			Ready,
+			Failed,
+		};
+
+		struct Slot
+		{
+			int Index;  // image held or being decoded
+			SlotState State;
+			std::vector<uchar> Encoded;  // file contents, reused
+			cv::Mat Decoded;  // empty unless the last decode succeeded
+		};
+
+		bool isDebug_;
+
+		int width_;
+		int height_;
+		int nChannel_;
+		int nBytesOfChannel_;
+		std::vector<std::string> files_;
+
+		std::mutex mtx_;
+		std::condition_variable cvar_;
+		std::vector<Slot> window_;  // image n goes to window_[n % size]
+		int next_;  // image handed out by the next Capture
+		bool isCancelled_;
+		std::atomic<int> numFailed_;  // images passed over by Capture
+
+		std::unique_ptr<ThreadPool> decoders_;  // joined first, so that no decoder touches the members above
+
+		bool init(const std::string& path, int firstIndex);
+
+		void prefetch(int index);
+
+		void decode(int index);
+
+	public:
+		CvImageSequenceCapture(
+			const std::string& path,
+			int numThreads,
+			int readAhead = 0,  // 0: two images per thread
+			uint64_t memoryBudget = 0,  // [bytes] 0: no limit
+			int firstIndex = 0,
+			bool isDebug = false
+		);
+
+		~CvImageSequenceCapture();
+
+		bool Capture(const CaptureDataObject *) override;
+
+		uint64_t GetNBytes() override;
+
+		uint64_t GetLength() override;
+
+		FrameFormat GetFormat() override;
+
+		int GetNumImages(void) const;
+
+		int GetReadAhead(void) const;
+
+		int GetNumFailed(void) const;
+};
+
+#endif  /* H__CV_IMAGE_SEQUENCE_CAPTURE__H */
@@ -0,0 +1,311 @@
+#include  <iostream>
+#include  <algorithm>
+#include  <climits>
+#include  "CvSegmentedCapture.hpp"
+
+
+/* ----- Public ----- */
+
+CvSegmentedCapture::CvSegmentedCapture(
+	const std::string& filename,
+	int numThreads,
+	int maxBufferedFrames,
+	bool isDebug
+)
+	: isDebug_(isDebug),
+	  width_(-1), height_(-1), nChannel_(-1), nBytesOfChannel_(-1), fps_(-1), numFrames_(0),
+	  maxBufferedFrames_((maxBufferedFrames > 0) ? maxBufferedFrames : 8 * std::max(numThreads, 1)),
+	  filename_(filename),
+	  head_(0), numBuffered_(0), isCancelled_(false)
+{
+	numThreads = std::max(numThreads, 1);
+
+	if (!init(filename_, numThreads))
+	{
+		// Capture fails right away, as CvCapture does for a file it cannot open
+		segments_.clear();
+		return;
+	}
+
+	decoders_ = std::unique_ptr<ThreadPool>(new ThreadPool(numThreads));
+	for (int idx = 0; idx < (int)segments_.size(); ++idx)
+	{
+		// FIFO: the workers take the segments in file order
+		decoders_->Submit([this, idx]{ decode(idx); });
+	}
+}
+
+CvSegmentedCapture::~CvSegmentedCapture()
+{
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		isCancelled_ = true;
+	}
+	cvar_.notify_all();
+
+	decoders_.reset();
+}
+
+bool CvSegmentedCapture::Capture(const CaptureDataObject * captureDataObject)
+{
+	auto frame = cv::Mat();
+	{
+		auto lk = std::unique_lock<std::mutex>(mtx_);
+		while (head_ < (int)segments_.size())
+		{
+			auto& segment = segments_[head_];
+			cvar_.wait(lk, [&segment]{ return !segment.Frames.empty() || segment.IsDecoded; });
+			if (!segment.Frames.empty())
+			{
+				frame = std::move(segment.Frames.front());
+				segment.Frames.pop_front();
+				break;
+			}
+
+			// the decoders waiting for room may go on with the next segment
+			++head_;
+			numBuffered_ -= (head_ < (int)segments_.size()) ? (int)segments_[head_].Frames.size() : 0;
+			cvar_.notify_all();
+		}
+	}
+	cvar_.notify_all();
+
+	if (frame.empty())
+	{
+		// end of file
+		return false;
+	}
+
+	auto& format = captureDataObject->Format;
+	auto isImage = ((int)format.Width == width_) && ((int)format.Height == height_);
+	auto stride = isImage ? format.GetStride() : (uint64_t)cv::Mat::AUTO_STEP;
+	auto depth = (nBytesOfChannel_ == sizeof(uint16_t)) ? CV_16U : CV_8U;
+	auto dst = cv::Mat(height_, width_, CV_MAKETYPE(depth, nChannel_), const_cast<void*>(captureDataObject->Data), stride);
+
+	auto ret = (frame.size() == dst.size()) && (frame.type() == dst.type());
+	if (ret)
+	{
+		frame.copyTo(dst);
+	}
+	else if (isDebug_)
+	{
+		std::cout << "unexpected frame format: " << frame.cols << "x" << frame.rows << " type=" << frame.type() << std::endl;
+	}
+
+	std::lock_guard<std::mutex> lk(mtx_);
+	freeFrames_.push_back(std::move(frame));
+
+	return ret;
+}
+
+uint64_t CvSegmentedCapture::GetNBytes()
+{
+	return sizeof(std::uint8_t);
+}
+
+uint64_t CvSegmentedCapture::GetLength()
+{
+	return width_ * height_ * nChannel_;
+}
+
+FrameFormat CvSegmentedCapture::GetFormat()
+{
+	auto format = FrameFormat{};
+	format.Width = width_;
+	format.Height = height_;
+	format.NumChannels = nChannel_;
+	format.NumBytesPerChannel = nBytesOfChannel_;
+	format.Stride = format.GetRowBytes();
+	return format;
+}
+
+int CvSegmentedCapture::GetNumSegments(void) const
+{
+	return (int)segments_.size();
+}
+
+
+/* ----- Private ----- */
+
+bool CvSegmentedCapture::init(const std::string& filename, int numThreads)
+{
+	auto cap = cv::VideoCapture(filename);
+	if (!cap.isOpened())
+	{
+		std::cout << "fail to open" << std::endl;
+		return false;
+	}
+
+	auto isSuccess = true;
+
+	width_ = (int)cap.get(cv::CAP_PROP_FRAME_WIDTH);
+	isSuccess &= (width_ > 0);
+
+	height_ = (int)cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+	isSuccess &= (height_ > 0);
+
+	nChannel_ = 3;
+	nBytesOfChannel_ = sizeof(uint8_t);
+
+	fps_ = (int)cap.get(cv::CAP_PROP_FPS);
+	numFrames_ = (int)cap.get(cv::CAP_PROP_FRAME_COUNT);
+	cap.release();
+
+	split(find_keyframes(), numThreads);
+
+	if (isDebug_)
+	{
+		std::cout << filename << ": " << numFrames_ << " frames in " << segments_.size() << " segments" << std::endl;
+	}
+
+	return isSuccess;
+}
+
+std::vector<int> CvSegmentedCapture::find_keyframes(void)
+{
+	auto keyframes = std::vector<int>{};
+
+	// demux only: with CAP_PROP_FORMAT -1 the FFmpeg backend hands out the packets without decoding them
+	auto cap = cv::VideoCapture(filename_, cv::CAP_FFMPEG);
+	if (!cap.isOpened() || !cap.set(cv::CAP_PROP_FORMAT, -1))
+	{
+		return keyframes;
+	}
+
+	int idx = 0;
+	for (; cap.grab(); ++idx)
+	{
+		if (cap.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0)
+		{
+			keyframes.push_back(idx);
+		}
+	}
+
+	if (!keyframes.empty())
+	{
+		// the packet count is exact, the container's frame count is an estimate
+		numFrames_ = idx;
+	}
+
+	return keyframes;
+}
+
+void CvSegmentedCapture::split(const std::vector<int>& keyframes, int numThreads)
+{
+	segments_.clear();
+
+	// a seek by frame number lands on a keyframe with most backends, so the file is split only at known keyframes
+	if ((numFrames_ <= 0) || (numThreads == 1) || keyframes.empty() || (keyframes.front() != 0))
+	{
+		// unknown length, no keyframe index or nothing to parallelize: decode to the end in one piece
+		segments_.push_back(Segment{ 0, INT_MAX, {}, false });
+		return;
+	}
+
+	// a few segments per thread keeps the threads busy when the segments differ in cost
+	auto target = std::max(numFrames_ / (numThreads * 4), 1);
+
+	auto boundaries = std::vector<int>{ 0 };
+	for (auto keyframe : keyframes)
+	{
+		if (keyframe - boundaries.back() >= target)
+		{
+			boundaries.push_back(keyframe);
+		}
+	}
+	boundaries.push_back(numFrames_);
+
+	for (size_t idx = 0; idx + 1 < boundaries.size(); ++idx)
+	{
+		segments_.push_back(Segment{ boundaries[idx], boundaries[idx + 1] - boundaries[idx], {}, false });
+	}
+
+	// whatever follows the counted frames belongs to the last segment
+	segments_.back().Length = INT_MAX;
+}
+
+void CvSegmentedCapture::seek(cv::VideoCapture& cap, int frame)
+{
+	// the segment begins at a keyframe, where the seek is exact; a backend that lands elsewhere is caught by the
+	// position it reports and decoded forward from the start instead, so that no frame is repeated or missed
+	if (cap.set(cv::CAP_PROP_POS_FRAMES, frame) && ((int)cap.get(cv::CAP_PROP_POS_FRAMES) == frame))
+	{
+		return;
+	}
+
+	if (isDebug_)
+	{
+		std::cout << "inexact seek to " << frame << ", decode from the start" << std::endl;
+	}
+
+	cap.open(filename_);
+	for (int n = 0; cap.isOpened() && (n < frame); ++n)
+	{
+		if (!cap.grab())
+		{
+			cap.release();
+		}
+	}
+}
+
+void CvSegmentedCapture::decode(int segment)
+{
+	auto cap = cv::VideoCapture();
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		if (!isCancelled_)
+		{
+			cap.open(filename_);
+		}
+	}
+
+	auto& target = segments_[segment];
+	if (cap.isOpened() && (target.Begin > 0))
+	{
+		seek(cap, target.Begin);
+	}
+
+	for (int n = 0; cap.isOpened() && (n < target.Length); ++n)
+	{
+		auto frame = cv::Mat();
+		{
+			auto lk = std::unique_lock<std::mutex>(mtx_);
+
+			// the segment being read only waits for its own frames, so the reader can never starve behind the read-ahead
+			cvar_.wait(lk, [this, segment, &target]{
+				return isCancelled_
+					|| ((segment == head_) && ((int)target.Frames.size() < maxBufferedFrames_))
+					|| ((segment != head_) && (numBuffered_ < maxBufferedFrames_));
+			});
+			if (isCancelled_)
+			{
+				break;
+			}
+
+			if (!freeFrames_.empty())
+			{
+				frame = std::move(freeFrames_.back());
+				freeFrames_.pop_back();
+			}
+		}
+
+		// read reuses the buffer when the size matches
+		if (!cap.read(frame))
+		{
+			break;
+		}
+
+		{
+			std::lock_guard<std::mutex> lk(mtx_);
+			numBuffered_ += (segment != head_) ? 1 : 0;
+			target.Frames.push_back(std::move(frame));
+		}
+		cvar_.notify_all();
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(mtx_);
+		target.IsDecoded = true;
+	}
+	cvar_.notify_all();
+}
@@ -0,0 +1,85 @@
+#ifndef  H__CV_SEGMENTED_CAPTURE__H
+#define  H__CV_SEGMENTED_CAPTURE__H
+
+#include  <string>
+#include  <vector>
+#include  <deque>
+#include  <memory>
+#include  <mutex>
+#include  <condition_variable>
+#include  <cstdint>
+#include  "opencv2/opencv.hpp"
+#include  "opencv2/videoio.hpp"
+#include  "common/ICapturable.hpp"
+#include  "common/ThreadPool.hpp"
+
+// Video file source decoding segments of the file on several threads.
+//
+// The file is split at keyframes into segments, each decoded by its own cv::VideoCapture on a worker thread;
+// a file whose keyframes cannot be listed (FFmpeg demuxing) is decoded in one piece.
+// Capture hands the frames out in file order, so it replaces CvCapture(filename) for offline jobs.
+// Decoded frames wait in memory until read; maxBufferedFrames bounds the frames decoded ahead of the reader.
+class CvSegmentedCapture : public ICapturable
+{
+	private:
+		struct Segment
+		{
+			int Begin;  // index of the first frame, a keyframe
+			int Length;
+			std::deque<cv::Mat> Frames;  // decoded, not read yet
+			bool IsDecoded;  // no more frames will come
+		};
+
+		bool isDebug_;
+
+		int width_;
+		int height_;
+		int nChannel_;
+		int nBytesOfChannel_;
+		int fps_;
+		int numFrames_;
+		int maxBufferedFrames_;
+		std::string filename_;
+
+		std::mutex mtx_;
+		std::condition_variable cvar_;
+		std::vector<Segment> segments_;
+		int head_;  // segment Capture reads from
+		int numBuffered_;  // frames decoded (or being decoded) ahead of the reader, the head segment aside
+		std::vector<cv::Mat> freeFrames_;  // buffers handed back to the decoders
+		bool isCancelled_;
+
+		std::unique_ptr<ThreadPool> decoders_;  // joined first, so that no decoder touches the members above
+
+		bool init(const std::string& filename, int numThreads);
+
+		std::vector<int> find_keyframes(void);
+
+		void split(const std::vector<int>& keyframes, int numThreads);
+
+		void seek(cv::VideoCapture& cap, int frame);
+
+		void decode(int segment);
+
+	public:
+		CvSegmentedCapture(
+			const std::string& filename,
+			int numThreads,
+			int maxBufferedFrames = 0,  // 0: 8 frames per thread
+			bool isDebug = false
+		);
+
+		~CvSegmentedCapture();
+
+		bool Capture(const CaptureDataObject *) override;
+
+		uint64_t GetNBytes() override;
+
+		uint64_t GetLength() override;
+
+		FrameFormat GetFormat() override;
+
+		int GetNumSegments(void) const;
+};
+
+#endif  /* H__CV_SEGMENTED_CAPTURE__H */
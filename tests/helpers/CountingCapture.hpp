@@ -0,0 +1,48 @@
+#ifndef  H__COUNTING_CAPTURE__H
+#define  H__COUNTING_CAPTURE__H
+
+#include  <thread>
+#include  <chrono>
+#include  <memory>
+#include  <cstdint>
+#include  <cstring>
+#include  "common/ICapturable.hpp"
+
+// Capture source for headless tests: waits one frame interval and writes the frame number at the head of the buffer
+class CountingCapture : public ICapturable
+{
+    public:
+        static constexpr int DefaultIntervalUs = 2000;
+        static constexpr int DefaultLength = 64;
+
+    private:
+        int interval_us_;
+        uint32_t count_;
+
+    public:
+        explicit CountingCapture(int interval_us = DefaultIntervalUs)
+            : interval_us_(interval_us), count_(0)
+        {
+        }
+
+        bool Capture(const CaptureDataObject* captureDataObject) override
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+            ++count_;
+            std::memcpy(const_cast<void*>(captureDataObject->Data), &count_, sizeof(count_));
+            return true;
+        }
+
+        uint64_t GetNBytes() override { return sizeof(uint8_t); }
+
+        uint64_t GetLength() override { return DefaultLength; }
+
+        static uint32_t FrameNumberOf(const CaptureDataObject* captureDataObject)
+        {
+            uint32_t number;
+            std::memcpy(&number, captureDataObject->Data, sizeof(number));
+            return number;
+        }
+};
+
+#endif  // H__COUNTING_CAPTURE__H
@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/AsyncLogger.hpp"
+
+static std::vector<std::string> ReadLines(FILE* file)
+{
+    auto lines = std::vector<std::string>{};
+    char buf[1024];
+
+    std::rewind(file);
+    while (std::fgets(buf, sizeof(buf), file) != nullptr)
+    {
+        lines.emplace_back(buf);
+    }
+    return lines;
+}
+
+
+// 書式と引数が後から背景スレッドで整形され、レベルで絞り込めること
+TEST(TS_Async_Logger, TC01)
+{
+    auto& logger = AsyncLogger::GetInstance();
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    logger.SetOutput(file);
+
+    uint64_t sequence = 12345678901234ULL;
+    CAPTURE_LOG(LogLevel::Info, "Tag", "int=%d, seq=%lu, hex=%04x, real=%.2f, str=%s, 100%%", -7, sequence, 0xab, 1.5, "text");
+    CAPTURE_LOG(LogLevel::Debug, "Tag", "no arguments");
+
+    logger.SetLevel(LogLevel::Info);
+    CAPTURE_LOG(LogLevel::Debug, "Tag", "filtered out");
+    logger.SetLevel(LogLevel::Trace);
+
+    logger.Flush();
+    auto lines = ReadLines(file);
+    logger.SetOutput(stdout);
+    std::fclose(file);
+
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_NE(lines[0].find("[I]"), std::string::npos);
+    EXPECT_NE(lines[0].find("[Tag] int=-7, seq=12345678901234, hex=00ab, real=1.50, str=text, 100%"), std::string::npos);
+    EXPECT_NE(lines[0].find("@test_async_logger.cpp)"), std::string::npos);
+    EXPECT_NE(lines[1].find("[D]"), std::string::npos);
+    EXPECT_NE(lines[1].find("no arguments (Line:"), std::string::npos);
+}
+
+// 複数スレッドから書いた記録が、書けたものは全て出力され、溢れたものは数えられること
+TEST(TS_Async_Logger, TC02)
+{
+    constexpr int numThreads = 4;
+    constexpr int numRecords = 5000;
+
+    auto& logger = AsyncLogger::GetInstance();
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    logger.SetOutput(file);
+    auto dropped = logger.GetNumDropped();
+
+    auto writers = std::vector<std::thread>{};
+    for (int t = 0; t < numThreads; ++t)
+    {
+        writers.emplace_back([t]{
+            for (int n = 0; n < numRecords; ++n)
+            {
+                CAPTURE_LOG(LogLevel::Trace, "Writer", "thread=%d, n=%d", t, n);
+            }
+        });
+    }
+    for (auto& writer : writers)
+    {
+        writer.join();
+    }
+
+    logger.Flush();
+    auto lines = ReadLines(file);
+    logger.SetOutput(stdout);
+    std::fclose(file);
+
+    EXPECT_EQ(lines.size() + (logger.GetNumDropped() - dropped), static_cast<size_t>(numThreads * numRecords));
+}
@@ -0,0 +1,266 @@
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "helpers/CountingCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int interval_us_ = CountingCapture::DefaultIntervalUs;
+
+
+// 読み出すフレームが新しくなり続けること
+TEST(TS_Capture_Controller, TC01)
+{
+    auto controller = MultiThreadCaptureController(new CountingCapture(), is_cap_delete_, is_dbg_);
+
+    controller.Setup();
+    controller.StartCapture();
+
+    uint32_t previous = 0;
+    uint64_t previous_time = 0;
+    for (int n = 0; n < 50; ++n)
+    {
+        auto [capDataObject, time_stamp] = controller.Read();
+        ASSERT_NE(capDataObject, nullptr);
+
+        auto number = CountingCapture::FrameNumberOf(capDataObject.get());
+        EXPECT_GE(number, previous);
+        EXPECT_GE(time_stamp, previous_time);
+        previous = number;
+        previous_time = time_stamp;
+
+        std::this_thread::sleep_for(std::chrono::microseconds(interval_us_ / 2));
+    }
+
+    controller.FinishCapture();
+}
+
+// 指定時刻に最も近いフレームを履歴から読み出せること
+TEST(TS_Capture_Controller, TC02)
+{
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 16;
+    auto controller = MultiThreadCaptureController(new CountingCapture(), is_cap_delete_, config, is_dbg_);
+
+    controller.Setup();
+    controller.StartCapture();
+
+    // fill the history
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_ * config.NumCaptureData * 2));
+
+    auto [latest, latest_time] = controller.Read();
+    ASSERT_NE(latest, nullptr);
+    auto latest_number = CountingCapture::FrameNumberOf(latest.get());
+
+    auto sync_time = latest_time - static_cast<uint64_t>(interval_us_) * 1000 * 4;
+    auto [nearest, nearest_time] = controller.ReadWithSync(sync_time);
+    ASSERT_NE(nearest, nullptr);
+
+    EXPECT_LT(CountingCapture::FrameNumberOf(nearest.get()), latest_number);
+    auto diff = (nearest_time < sync_time) ? sync_time - nearest_time : nearest_time - sync_time;
+    EXPECT_LE(diff, static_cast<uint64_t>(interval_us_) * 1000 * 2);
+
+    controller.FinishCapture();
+}
+
+// 履歴の段数が足りない設定を拒否すること
+TEST(TS_Capture_Controller, TC03)
+{
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = FrameRing::MinNumSlots - 1;
+
+    auto cap = CountingCapture();
+    EXPECT_ANY_THROW(MultiThreadCaptureController(&cap, false, config, is_dbg_));
+}
+
+// 開始前と停止中はキャプチャスレッドがCPUを使わずに待機すること
+TEST(TS_Capture_Controller, TC04)
+{
+    auto controller = MultiThreadCaptureController(new CountingCapture(), is_cap_delete_, is_dbg_);
+
+    controller.Setup();
+
+    auto clock_begin = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto cpu_ms = (std::clock() - clock_begin) * 1000 / CLOCKS_PER_SEC;
+    EXPECT_LT(cpu_ms, 10);
+    EXPECT_EQ(controller.GetState(), MultiThreadCaptureController::CaptureState::Idle);
+
+    controller.StartCapture();
+    EXPECT_EQ(controller.GetState(), MultiThreadCaptureController::CaptureState::Active);
+    ASSERT_NE(std::get<0>(controller.Read()), nullptr);
+
+    controller.StopCapture();
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_ * 2));
+    controller.Read();
+    auto stopped_sequence = controller.GetReadSequence();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_ * 5));
+    controller.Read();
+    EXPECT_EQ(controller.GetReadSequence(), stopped_sequence);
+
+    EXPECT_TRUE(controller.FinishCapture());
+    EXPECT_EQ(controller.GetState(), MultiThreadCaptureController::CaptureState::Quit);
+    EXPECT_FALSE(controller.StartCapture());
+}
+
+// ReadNextが新しいフレームだけを取りこぼし数と共に返すこと
+TEST(TS_Capture_Controller, TC05)
+{
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_ / 10), is_cap_delete_, is_dbg_);
+
+    controller.Setup();
+    controller.StartCapture();
+
+    uint64_t last_sequence = 0;
+    uint64_t num_read = 0;
+    uint64_t num_skipped = 0;
+    for (int n = 0; n < 200; ++n)
+    {
+        auto [capDataObject, time_stamp, sequence, skipped] = controller.ReadNext(last_sequence);
+        ASSERT_NE(capDataObject, nullptr);
+        EXPECT_GT(sequence, last_sequence);
+        EXPECT_EQ(CountingCapture::FrameNumberOf(capDataObject.get()), sequence);
+
+        ++num_read;
+        num_skipped += skipped;
+        last_sequence = sequence;
+    }
+    EXPECT_EQ(num_read + num_skipped, last_sequence);
+
+    // no new frame arrives while stopped
+    controller.StopCapture();
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+    auto [latest, latest_time, latest_sequence, latest_skipped] = controller.ReadNext(last_sequence, 0);
+    auto [timedout, timedout_time, timedout_sequence, timedout_skipped] = controller.ReadNext(latest_sequence, static_cast<uint64_t>(interval_us_) * 1000 * 5);
+    EXPECT_EQ(timedout, nullptr);
+    EXPECT_EQ(timedout_sequence, latest_sequence);
+
+    controller.FinishCapture();
+}
+
+// 終了時に待機中の読み出しが解放されること
+TEST(TS_Capture_Controller, TC06)
+{
+    auto controller = MultiThreadCaptureController(new CountingCapture(), is_cap_delete_, is_dbg_);
+
+    controller.Setup();
+
+    auto reader = std::thread([&controller]{
+        auto [capDataObject, time_stamp, sequence, skipped] = controller.ReadNext(0);
+        EXPECT_EQ(capDataObject, nullptr);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    controller.FinishCapture();
+    reader.join();
+}
+
+// リース中のフレームが上書きされず、不足分のバッファが上限まで追加されること
+TEST(TS_Capture_Controller, TC07)
+{
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 4;
+    config.MaxNumCaptureData = 8;
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_ / 4), is_cap_delete_, config, is_dbg_);
+
+    controller.Setup();
+    controller.StartCapture();
+
+    auto leases = std::vector<FrameLease>{};
+    uint64_t last_sequence = 0;
+    for (int n = 0; n < 6; ++n)
+    {
+        auto lease = controller.LeaseNext(last_sequence);
+        ASSERT_TRUE(lease.IsValid());
+        last_sequence = lease.GetSequence();
+        leases.push_back(std::move(lease));
+    }
+
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_ * 10));
+
+    for (auto& lease : leases)
+    {
+        EXPECT_EQ(CountingCapture::FrameNumberOf(lease.Get()), lease.GetSequence());
+    }
+    EXPECT_GT(controller.GetNumCaptureData(), config.NumCaptureData);
+    EXPECT_LE(controller.GetNumCaptureData(), config.MaxNumCaptureData);
+
+    // capture goes on once the leases are returned
+    leases.clear();
+    auto lease = controller.LeaseNext(last_sequence + 1);
+    EXPECT_TRUE(lease.IsValid());
+    lease.Release();
+
+    controller.FinishCapture();
+}
+
+// 全てのバッファがリースされている間はキャプチャスレッドがCPUを使わずに待ち、返却と終了で再開すること
+TEST(TS_Capture_Controller, TC08)
+{
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 4;
+    config.MaxNumCaptureData = 4;
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_ / 10), is_cap_delete_, config, is_dbg_);
+
+    controller.Setup();
+    controller.StartCapture();
+
+    // every slot but the latest one, which the producer never writes
+    auto leases = std::vector<FrameLease>{};
+    uint64_t last_sequence = 0;
+    for (int n = 0; n < config.MaxNumCaptureData - 1; ++n)
+    {
+        auto lease = controller.LeaseNext(last_sequence);
+        ASSERT_TRUE(lease.IsValid());
+        last_sequence = lease.GetSequence();
+        leases.push_back(std::move(lease));
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+    auto blocked_sequence = controller.Lease().GetSequence();
+
+    auto clock_begin = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto cpu_ms = (std::clock() - clock_begin) * 1000 / CLOCKS_PER_SEC;
+    EXPECT_LT(cpu_ms, 10);
+    EXPECT_EQ(controller.Lease().GetSequence(), blocked_sequence);
+
+    // a returned lease frees a slot for the next frame
+    leases.erase(leases.begin());
+    EXPECT_TRUE(controller.LeaseNext(blocked_sequence, 100 * 1000 * 1000).IsValid());
+
+    // the capture thread blocked again is released by FinishCapture
+    auto lease = controller.Lease();
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+    EXPECT_TRUE(controller.FinishCapture());
+}
+
+// 読み出したフレームは、制御器を破棄した後も手放すまで参照できること
+TEST(TS_Capture_Controller, TC09)
+{
+    auto controller = std::unique_ptr<MultiThreadCaptureController>(
+            new MultiThreadCaptureController(new CountingCapture(), is_cap_delete_, is_dbg_)
+        );
+    controller->Setup();
+    controller->StartCapture();
+
+    auto capDataObject = std::get<0>(controller->Read());
+    ASSERT_NE(capDataObject, nullptr);
+    auto number = CountingCapture::FrameNumberOf(capDataObject.get());
+
+    controller->FinishCapture();
+    controller.reset();
+
+    EXPECT_EQ(CountingCapture::FrameNumberOf(capDataObject.get()), number);
+}
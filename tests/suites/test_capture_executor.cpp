@@ -0,0 +1,155 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/CaptureExecutor.hpp"
+#include "common/SyntheticCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+// source that cannot tell when its frame comes, so it holds a worker while it waits
+class BlockingCapture : public SyntheticCapture
+{
+    public:
+        BlockingCapture() : SyntheticCapture(64, 16, 3, 0.0) {}
+
+        bool Capture(const CaptureDataObject* captureDataObject) override
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            return SyntheticCapture::Capture(captureDataObject);
+        }
+
+        uint64_t GetTimeToReady() override { return 0; }
+};
+
+
+// 多数の制御器が少数の作業スレッドを共有し、それぞれ順にフレームを遅延が抑えられたまま発行すること
+TEST(TS_Capture_Executor, TC01)
+{
+    constexpr int numStreams = 16;
+    constexpr int numReads = 20;
+    constexpr uint64_t maxLatency = 20 * 1000 * 1000;  // [ns] from the due time to the publication
+
+    auto executor = CaptureExecutor(2);
+    auto config = CaptureControllerConfig{};
+    config.Executor = &executor;
+
+    auto controllers = std::vector<std::unique_ptr<MultiThreadCaptureController>>{};
+    for (int n = 0; n < numStreams; ++n)
+    {
+        controllers.emplace_back(new MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 200.0), is_cap_delete_, config, is_dbg_));
+        EXPECT_TRUE(controllers.back()->Setup());
+        EXPECT_FALSE(controllers.back()->Setup());
+        controllers.back()->StartCapture();
+    }
+    EXPECT_EQ(executor.GetStats().NumStreams, numStreams);
+
+    auto lastSequences = std::vector<uint64_t>(numStreams, 0);
+    auto lastNumbers = std::vector<uint32_t>(numStreams, 0);
+    for (int round = 0; round < numReads; ++round)
+    {
+        for (int n = 0; n < numStreams; ++n)
+        {
+            auto lease = controllers[n]->LeaseNext(lastSequences[n]);
+            ASSERT_TRUE(lease.IsValid());
+            auto stamp = SyntheticCapture::StampOf(lease.Get());
+            EXPECT_GT(stamp.Number, lastNumbers[n]);
+            EXPECT_LT(lease.GetCapturedTime() - stamp.Time, maxLatency);
+            lastNumbers[n] = stamp.Number;
+            lastSequences[n] = lease.GetSequence();
+        }
+    }
+
+    for (auto& controller : controllers)
+    {
+        EXPECT_TRUE(controller->FinishCapture());
+    }
+
+    auto stats = executor.GetStats();
+    EXPECT_EQ(stats.NumWorkers, 2);
+    EXPECT_EQ(stats.NumStreams, 0);
+    EXPECT_GT(stats.Steps, static_cast<uint64_t>(numStreams * numReads));
+    EXPECT_GT(stats.Deferred, 0u);
+    EXPECT_GT(stats.ScheduleDelay.Count, 0u);
+}
+
+// 共有された作業スレッド上でも開始、停止、再開、終了と、映像の終わりによる終了が従来通りに働くこと
+TEST(TS_Capture_Executor, TC02)
+{
+    auto executor = CaptureExecutor(1);
+    auto config = CaptureControllerConfig{};
+    config.Executor = &executor;
+
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 500.0), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+
+    // parked until StartCapture
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(controller.LeaseNext(0, 1000 * 1000).IsValid());
+
+    controller.StartCapture();
+    auto lease = controller.LeaseNext(0);
+    ASSERT_TRUE(lease.IsValid());
+    lease = FrameLease{};
+
+    controller.StopCapture();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto lastSequence = controller.Lease().GetSequence();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(controller.Lease().GetSequence(), lastSequence);
+
+    controller.StartCapture();
+    EXPECT_TRUE(controller.LeaseNext(lastSequence).IsValid());
+    EXPECT_TRUE(controller.FinishCapture());
+    EXPECT_EQ(executor.GetStats().NumStreams, 0);
+
+    // the end of the source finishes the stream, and the readers are released
+    auto finite = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 0.0, 0, 5), is_cap_delete_, config, is_dbg_);
+    finite.Setup();
+    finite.StartCapture();
+    uint64_t sequence = 0;
+    while (auto next = finite.LeaseNext(sequence))
+    {
+        sequence = next.GetSequence();
+    }
+    EXPECT_EQ(finite.GetState(), MultiThreadCaptureController::CaptureState::Quit);
+}
+
+// 待ち時間を告げない源が作業スレッドを塞いでも、他の作業スレッドが残りの制御器を並行して進めること
+TEST(TS_Capture_Executor, TC03)
+{
+    constexpr int numStreams = 4;
+
+    auto executor = CaptureExecutor(numStreams);
+    auto config = CaptureControllerConfig{};
+    config.Executor = &executor;
+
+    auto controllers = std::vector<std::unique_ptr<MultiThreadCaptureController>>{};
+    for (int n = 0; n < numStreams; ++n)
+    {
+        controllers.emplace_back(new MultiThreadCaptureController(new BlockingCapture(), is_cap_delete_, config, is_dbg_));
+        controllers.back()->Setup();
+        controllers.back()->StartCapture();
+    }
+
+    // 5 ms a frame: about 40 frames each in 200 ms when served in parallel, about 10 when one after another
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    for (auto& controller : controllers)
+    {
+        EXPECT_GT(controller->Lease().GetSequence(), 20u);
+    }
+
+    for (auto& controller : controllers)
+    {
+        controller->FinishCapture();
+    }
+}
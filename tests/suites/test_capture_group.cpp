@@ -0,0 +1,90 @@
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureGroup.hpp"
+#include "helpers/CountingCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int numSources_ = 3;
+static constexpr uint64_t skewTolerance_ = 3000000;  // [ns]
+
+
+// 全ソースのフレームを許容ずれ以内の組として読み出せること
+TEST(TS_Capture_Group, TC01)
+{
+    auto config = CaptureGroupConfig{};
+    config.SkewTolerance = skewTolerance_;
+    config.Controller.NumCaptureData = 8;
+
+    // sources with different frame rates
+    auto caps = std::vector<ICapturable*>{};
+    for (int idx = 0; idx < numSources_; ++idx)
+    {
+        caps.push_back(new CountingCapture(CountingCapture::DefaultIntervalUs * (idx + 1)));
+    }
+
+    auto group = MultiThreadCaptureGroup(caps, is_cap_delete_, config, is_dbg_);
+
+    group.Setup();
+    group.StartCapture();
+
+    for (int n = 0; n < 20; ++n)
+    {
+        auto frameSet = group.Read();
+        ASSERT_EQ(frameSet.size(), static_cast<size_t>(numSources_));
+
+        auto [min_time, max_time] = std::minmax({ std::get<1>(frameSet[0]), std::get<1>(frameSet[1]), std::get<1>(frameSet[2]) });
+        EXPECT_LE(max_time - min_time, skewTolerance_ * 2);
+
+        for (auto& [capDataObject, time_stamp] : frameSet)
+        {
+            EXPECT_NE(capDataObject, nullptr);
+        }
+    }
+
+    group.FinishCapture();
+
+    auto stats = group.GetStats();
+    ASSERT_EQ(stats.size(), static_cast<size_t>(numSources_));
+    for (auto& source : stats)
+    {
+        EXPECT_EQ(source.Delivered, 20u);
+        EXPECT_LE(source.MaxSkew, skewTolerance_);
+    }
+
+    // the fastest source captures more frames than the sets consume
+    EXPECT_GT(stats[0].Dropped + stats[0].Repeated, 0u);
+}
+
+// 最初のフレームを出さないソースがあっても、読み出しは待ち時間の上限で空の組を返すこと
+TEST(TS_Capture_Group, TC02)
+{
+    auto config = CaptureGroupConfig{};
+    config.Timeout = 20 * 1000 * 1000;
+
+    auto caps = std::vector<ICapturable*>{};
+    for (int idx = 0; idx < numSources_; ++idx)
+    {
+        caps.push_back(new CountingCapture());
+    }
+
+    auto group = MultiThreadCaptureGroup(caps, is_cap_delete_, config, is_dbg_);
+    group.Setup();
+
+    // never started, so no source publishes a frame
+    auto begin = std::chrono::steady_clock::now();
+    EXPECT_TRUE(group.Read().empty());
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(20));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+
+    group.FinishCapture();
+}
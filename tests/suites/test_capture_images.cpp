@@ -0,0 +1,125 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <opencv2/opencv.hpp>
+#include <gtest/gtest.h>
+#include "common/CaptureDataObject.hpp"
+#include "common/MultiThreadCaptureController.hpp"
+#include "cv/CvImageSequenceCapture.hpp"
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int width_ = 64;
+static constexpr int height_ = 48;
+static constexpr int numImages_ = 40;
+
+// numbered images, image n filled with n (what tools/make_seqimages.py --synthetic writes)
+static std::string MakeSequence(void)
+{
+    auto dir = std::filesystem::temp_directory_path() / "TS_Capture_Images";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    char name[64];
+    for (int n = 0; n < numImages_; ++n)
+    {
+        std::snprintf(name, sizeof(name), "frame_%06d.png", n);
+        cv::imwrite((dir / name).string(), cv::Mat(height_, width_, CV_8UC3, cv::Scalar::all(n)));
+    }
+    return dir.string();
+}
+
+
+// 先読みしながら全画像を番号順に返し、最後にfalseを返すこと
+TEST(TS_Capture_Images, TC01)
+{
+    auto dir = MakeSequence();
+    auto cap = CvImageSequenceCapture(dir, 4, 6, 0, 0, is_dbg_);
+    ASSERT_EQ(cap.GetNumImages(), numImages_);
+    EXPECT_EQ(cap.GetReadAhead(), 6);
+
+    auto image = cv::Mat(height_, width_, CV_8UC3);
+    auto object = CaptureDataObject(image.data, cap.GetFormat());
+
+    for (int n = 0; n < numImages_; ++n)
+    {
+        ASSERT_TRUE(cap.Capture(&object));
+        EXPECT_EQ(image.at<cv::Vec3b>(height_ / 2, width_ / 2)[0], n);
+    }
+    EXPECT_FALSE(cap.Capture(&object));
+}
+
+// printf形式のパターンで開き、メモリ上限で先読み枚数が制限され、コントローラ経由で読めること
+TEST(TS_Capture_Images, TC02)
+{
+    auto dir = MakeSequence();
+    auto pattern = dir + "/frame_%06d.png";
+    auto sizeOfImage = static_cast<uint64_t>(width_ * height_ * 3);
+
+    auto cap = new CvImageSequenceCapture(pattern, 4, 16, sizeOfImage * 2, 10, is_dbg_);
+    EXPECT_EQ(cap->GetNumImages(), numImages_ - 10);
+    EXPECT_EQ(cap->GetReadAhead(), 2);
+
+    auto controller = MultiThreadCaptureController(cap, is_cap_delete_, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    uint64_t lastSequence = 0;
+    while (true)
+    {
+        auto [data, time, sequence, skipped] = controller.ReadNext(lastSequence);
+        if (data == nullptr)
+        {
+            break;
+        }
+
+        auto image = cv::Mat(height_, width_, CV_8UC3, const_cast<void*>(data->Data));
+        EXPECT_EQ(image.at<cv::Vec3b>(0, 0)[0], static_cast<int>(10 + sequence - 1));
+        lastSequence = sequence;
+    }
+
+    controller.FinishCapture();
+}
+
+// 壊れた画像は飛ばして数え、整数の変換がちょうど一つでないパターンは開かないこと
+TEST(TS_Capture_Images, TC03)
+{
+    auto dir = MakeSequence();
+
+    // not an image, an empty file and a PNG cut short, each decoded into a slot that held a good image before
+    std::ofstream(dir + "/frame_000005.png", std::ios::binary | std::ios::trunc) << "not an image";
+    std::ofstream(dir + "/frame_000007.png", std::ios::binary | std::ios::trunc);
+    auto encoded = std::vector<uchar>{};
+    cv::imencode(".png", cv::Mat(height_, width_, CV_8UC3, cv::Scalar::all(9)), encoded);
+    std::ofstream(dir + "/frame_000009.png", std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(encoded.data()), encoded.size() / 2);
+
+    auto cap = CvImageSequenceCapture(dir + "/frame_%06d.png", 2, 4, 0, 0, is_dbg_);
+    ASSERT_EQ(cap.GetNumImages(), numImages_);
+
+    auto image = cv::Mat(height_, width_, CV_8UC3);
+    auto object = CaptureDataObject(image.data, cap.GetFormat());
+    for (int n = 0; n < numImages_; ++n)
+    {
+        if ((n == 5) || (n == 7) || (n == 9))
+        {
+            continue;
+        }
+        ASSERT_TRUE(cap.Capture(&object));
+        EXPECT_EQ(image.at<cv::Vec3b>(height_ / 2, width_ / 2)[0], n);
+    }
+    EXPECT_FALSE(cap.Capture(&object));
+    EXPECT_EQ(cap.GetNumFailed(), 3);
+
+    for (auto pattern : { "/frame_%s.png", "/frame_%06d_%d.png", "/frame_%06ld.png", "/frame_%*d.png" })
+    {
+        EXPECT_EQ(CvImageSequenceCapture(dir + pattern, 1).GetNumImages(), 0);
+    }
+    EXPECT_EQ(CvImageSequenceCapture(dir + "/frame_000000.png", 1).GetNumImages(), 1);
+}
@@ -1,11 +1,13 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <filesystem>
 #include <opencv2/opencv.hpp>
 #include <gtest/gtest.h>
 #include "common/CaptureDataObject.hpp"
 #include "common/MultiThreadCaptureController.hpp"
 #include "cv/CvCapture.hpp"
+#include "cv/CvSegmentedCapture.hpp"
 
 #ifndef NDEBUG
 constexpr bool is_dbg_ = true;
@@ -82,3 +84,57 @@ TEST(TS_Capture_Movie, TC02)
     cv::destroyAllWindows();
 }
 
+
+// CvSegmentedCapture classのインスタンスが複数スレッドで復号しても、CvCaptureと同じフレームを同じ順序で返すこと
+TEST(TS_Capture_Movie, TC03)
+{
+    auto serial = CvCapture(pathToMovie_, is_dbg_);
+    auto segmented = CvSegmentedCapture(pathToMovie_, 4, 0, is_dbg_);
+
+    auto expected = cv::Mat(height_, width_, CV_8UC3);
+    auto actual = cv::Mat(height_, width_, CV_8UC3);
+    auto expectedObject = CaptureDataObject(expected.data, segmented.GetFormat());
+    auto actualObject = CaptureDataObject(actual.data, segmented.GetFormat());
+
+    int numFrames = 0;
+    while (serial.Capture(&expectedObject))
+    {
+        ASSERT_TRUE(segmented.Capture(&actualObject)) << "frame " << numFrames;
+        EXPECT_LT(cv::norm(expected, actual, cv::NORM_L1) / expected.total(), 1.0) << "frame " << numFrames;
+        ++numFrames;
+    }
+
+    EXPECT_FALSE(segmented.Capture(&actualObject));
+    EXPECT_GT(numFrames, 0);
+}
+
+// CvSegmentedCapture classのインスタンスが区切りの前後でフレームを重複も欠落もなく番号順に返すこと
+TEST(TS_Capture_Movie, TC04)
+{
+    constexpr int numFrames = 120;
+    constexpr int width = 64;
+    constexpr int height = 48;
+
+    // every frame of Motion JPEG is a keyframe, frame n filled with 2n
+    auto path = (std::filesystem::temp_directory_path() / "TS_Capture_Movie_TC04.avi").string();
+    {
+        auto writer = cv::VideoWriter(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 30.0, cv::Size(width, height));
+        ASSERT_TRUE(writer.isOpened());
+        for (int n = 0; n < numFrames; ++n)
+        {
+            writer.write(cv::Mat(height, width, CV_8UC3, cv::Scalar::all(2 * n)));
+        }
+    }
+
+    auto segmented = CvSegmentedCapture(path, 4, 0, is_dbg_);
+    EXPECT_GT(segmented.GetNumSegments(), 1);
+
+    auto image = cv::Mat(height, width, CV_8UC3);
+    auto object = CaptureDataObject(image.data, segmented.GetFormat());
+    for (int n = 0; n < numFrames; ++n)
+    {
+        ASSERT_TRUE(segmented.Capture(&object)) << "frame " << n;
+        EXPECT_NEAR(image.at<cv::Vec3b>(height / 2, width / 2)[0], 2 * n, 4) << "frame " << n;
+    }
+    EXPECT_FALSE(segmented.Capture(&object));
+}
@@ -0,0 +1,163 @@
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/LatencyHistogram.hpp"
+#include "helpers/CountingCapture.hpp"
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int interval_us_ = CountingCapture::DefaultIntervalUs / 2;
+static constexpr int numFrames_ = 50;
+
+
+// 百分位がバケットの上限として最大値を超えずに求まり、リセットで全て0に戻ること
+TEST(TS_Capture_Stats, TC01)
+{
+    auto histogram = LatencyHistogram();
+    for (uint64_t value = 1; value <= 1000; ++value)
+    {
+        histogram.Record(value * 1000);
+    }
+
+    auto snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.Count, 1000u);
+    EXPECT_EQ(snapshot.Max, 1000000u);
+    EXPECT_DOUBLE_EQ(snapshot.GetMean(), 500500.0);
+
+    // a bucket spans at most a quarter of its lower bound
+    EXPECT_GE(snapshot.GetPercentile(0.5), 500000u);
+    EXPECT_LE(snapshot.GetPercentile(0.5), 625000u);
+    EXPECT_GE(snapshot.GetPercentile(0.99), 990000u);
+    EXPECT_EQ(snapshot.GetPercentile(1.0), 1000000u);
+
+    for (int bucket = 1; bucket < HistogramSnapshot::NumBuckets; ++bucket)
+    {
+        ASSERT_EQ(HistogramSnapshot::GetBucket(HistogramSnapshot::GetLowerBound(bucket)), bucket);
+        ASSERT_EQ(HistogramSnapshot::GetBucket(HistogramSnapshot::GetLowerBound(bucket) - 1), bucket - 1);
+    }
+
+    histogram.Snapshot(true);
+    snapshot = histogram.Snapshot();
+    EXPECT_EQ(snapshot.Count, 0u);
+    EXPECT_EQ(snapshot.Sum, 0u);
+    EXPECT_EQ(snapshot.Max, 0u);
+}
+
+// 撮影時間・撮影間隔・読み出しまでの経過時間と、生成・消費したフレーム数が数えられること
+TEST(TS_Capture_Stats, TC02)
+{
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, is_dbg_);
+    controller.Setup();
+    auto consumer = controller.RegisterConsumer();
+    controller.StartCapture();
+
+    for (int n = 0; n < numFrames_; ++n)
+    {
+        ASSERT_TRUE(consumer->ReadNext().IsValid());
+    }
+    controller.StopCapture();
+
+    auto stats = controller.GetStats();
+    EXPECT_GE(stats.Produced, static_cast<uint64_t>(numFrames_));
+    EXPECT_EQ(stats.Consumed, static_cast<uint64_t>(numFrames_));
+    EXPECT_EQ(stats.Skipped, 0u);
+    EXPECT_NEAR(stats.CaptureDuration.Count, stats.Produced, 1);
+    EXPECT_NEAR(stats.FrameInterval.Count, stats.Produced - 1, 1);
+    EXPECT_EQ(stats.FrameAge.Count, stats.Consumed);
+    EXPECT_NEAR(stats.ProducerWait.Count, stats.Produced, 1);  // the next frame may be in Capture
+
+    // CountingCapture sleeps for one interval in Capture
+    EXPECT_GE(stats.CaptureDuration.GetPercentile(0.5), interval_us_ * 1000u * 3 / 4);
+    EXPECT_GE(stats.FrameInterval.GetMean(), interval_us_ * 1000.0);
+    EXPECT_GT(stats.ReaderWait.Count, 0u);
+
+    controller.ResetStats();
+    stats = controller.GetStats();
+    EXPECT_EQ(stats.Produced, 0u);
+    EXPECT_EQ(stats.Consumed, 0u);
+    EXPECT_EQ(stats.CaptureDuration.Count, 0u);
+
+    consumer.reset();
+    controller.FinishCapture();
+}
+
+// 誰にも読まれずに上書きされたフレームが数えられ、統計を無効にすると何も数えないこと
+TEST(TS_Capture_Stats, TC03)
+{
+    auto config = CaptureControllerConfig{};
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(interval_us_ * numFrames_));
+    controller.StopCapture();
+
+    auto stats = controller.GetStats();
+    EXPECT_GT(stats.Produced, static_cast<uint64_t>(config.NumCaptureData));
+    EXPECT_EQ(stats.Consumed, 0u);
+    EXPECT_GE(stats.Overwritten, stats.Produced - config.NumCaptureData);
+    controller.FinishCapture();
+
+    config.CollectStats = false;
+    auto quiet = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, config, is_dbg_);
+    quiet.Setup();
+    quiet.StartCapture();
+    quiet.Read();
+    quiet.FinishCapture();
+
+    stats = quiet.GetStats();
+    EXPECT_EQ(stats.Produced, 0u);
+    EXPECT_EQ(stats.Consumed, 0u);
+}
+
+// 撮影スレッドのCPU固定・スケジューリング・NUMAノードが、適用された値として統計に表れること
+TEST(TS_Capture_Stats, TC04)
+{
+    auto config = CaptureControllerConfig{};
+    config.CpuAffinity = { 0 };
+    config.SchedPolicy = SCHED_RR;
+    config.SchedPriority = 1;
+    config.NumaNode = 0;
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    for (int n = 0; n < 10; ++n)
+    {
+        ASSERT_NE(std::get<0>(controller.Read()), nullptr);
+        std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+    }
+    auto stats = controller.GetStats();
+    controller.FinishCapture();
+
+    EXPECT_TRUE(stats.IsPinned);
+    EXPECT_EQ(stats.Cpu, 0);
+    EXPECT_EQ(stats.Migrations, 0u);
+
+    // real-time priority needs privileges, the stats show what was actually applied
+    if (stats.SchedPolicy == SCHED_RR)
+    {
+        EXPECT_EQ(stats.SchedPriority, 1);
+    }
+    else
+    {
+        EXPECT_EQ(stats.SchedPolicy, SCHED_OTHER);
+        EXPECT_EQ(stats.SchedPriority, 0);
+    }
+
+    if (stats.NumaNode == 0)
+    {
+        EXPECT_EQ(stats.BytesOnNumaNode, controller.GetBytesHeld());
+    }
+    else
+    {
+        EXPECT_EQ(stats.NumaNode, -1);
+    }
+}
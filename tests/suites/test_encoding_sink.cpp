@@ -0,0 +1,209 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <map>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/EncodingSink.hpp"
+#include "common/SyntheticCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+constexpr bool is_enc_delete_ = true;
+
+// "encodes" a synthetic frame as its stamp, taking as long as an image codec would
+class StampEncoder : public IFrameEncoder
+{
+    private:
+        int delay_us_;
+
+    public:
+        explicit StampEncoder(int delay_us = 0)
+            : delay_us_(delay_us)
+        {
+        }
+
+        std::string GetExtension() override { return ".stamp"; }
+
+        bool Encode(const CaptureDataObject* frame, std::vector<uint8_t>& encoded) override
+        {
+            if (delay_us_ > 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(delay_us_));
+            }
+
+            auto stamp = SyntheticCapture::StampOf(frame);
+            encoded.resize(sizeof(stamp));
+            std::memcpy(encoded.data(), &stamp, sizeof(stamp));
+            return true;
+        }
+};
+
+static std::vector<uint8_t> MakeFrame(const FrameFormat& format, uint32_t number)
+{
+    auto data = std::vector<uint8_t>(format.GetSizeOfFrame(), 0);
+    auto stamp = SyntheticCapture::Stamp{ number, 0, number * 1000ull };
+    std::memcpy(data.data(), &stamp, sizeof(stamp));
+    return data;
+}
+
+
+// 投入したフレームがすべて符号化されて書き出され、入力は投入直後に手放せること
+TEST(TS_Encoding_Sink, TC01)
+{
+    constexpr int numFrames = 40;
+    auto format = FrameFormat{ 32, 8, 3, 1, 0 };
+
+    std::mutex mtx;
+    auto written = std::map<uint64_t, uint32_t>{};
+    auto writer = [&](uint64_t sequence, uint64_t, const uint8_t* data, uint64_t size){
+        auto stamp = SyntheticCapture::Stamp{};
+        EXPECT_EQ(size, sizeof(stamp));
+        std::memcpy(&stamp, data, sizeof(stamp));
+        std::lock_guard<std::mutex> lk(mtx);
+        written[sequence] = stamp.Number;
+        return true;
+    };
+
+    auto config = EncodingSinkConfig{};
+    config.NumWorkers = 3;
+    config.QueueCapacity = numFrames;
+    auto sink = EncodingSink(new StampEncoder(100), is_enc_delete_, writer, config);
+
+    for (uint32_t n = 1; n <= numFrames; ++n)
+    {
+        auto data = MakeFrame(format, n);
+        auto frame = CaptureDataObject(data.data(), format);
+        EXPECT_TRUE(sink.Submit(&frame, 0, n));
+        // the sink has its own copy
+        std::memset(data.data(), 0xff, data.size());
+    }
+    sink.Flush();
+
+    auto stats = sink.GetStats();
+    EXPECT_EQ(stats.Submitted, static_cast<uint64_t>(numFrames));
+    EXPECT_EQ(stats.Written, static_cast<uint64_t>(numFrames));
+    EXPECT_EQ(stats.BytesWritten, numFrames * sizeof(SyntheticCapture::Stamp));
+    EXPECT_EQ(stats.Dropped, 0u);
+    EXPECT_EQ(stats.Failed, 0u);
+    EXPECT_EQ(stats.QueueDepth, 0);
+    EXPECT_GT(stats.GetFramesPerSecond(), 0.0);
+    EXPECT_EQ(stats.EncodeDuration.Count, static_cast<uint64_t>(numFrames));
+
+    ASSERT_EQ(written.size(), static_cast<size_t>(numFrames));
+    for (auto& [sequence, number] : written)
+    {
+        EXPECT_EQ(sequence, number);
+    }
+
+    // a frame of another format is refused
+    auto other = FrameFormat{ 16, 8, 3, 1, 0 };
+    auto data = MakeFrame(other, 1);
+    auto frame = CaptureDataObject(data.data(), other);
+    EXPECT_FALSE(sink.Submit(&frame, 0, numFrames + 1));
+    EXPECT_EQ(sink.GetStats().Failed, 1u);
+}
+
+// 待ち行列が溢れたとき、破棄方針では呼び出し側を待たせずに捨て、阻止方針では一つも捨てずに待たせること
+TEST(TS_Encoding_Sink, TC02)
+{
+    constexpr int numFrames = 12;
+    constexpr int delay_us = 5000;
+    auto format = FrameFormat{ 32, 8, 3, 1, 0 };
+    auto writer = [](uint64_t, uint64_t, const uint8_t*, uint64_t){ return true; };
+
+    for (auto policy : { SinkOverflowPolicy::Drop, SinkOverflowPolicy::Block })
+    {
+        auto config = EncodingSinkConfig{};
+        config.NumWorkers = 1;
+        config.QueueCapacity = 2;
+        config.OverflowPolicy = policy;
+        auto sink = EncodingSink(new StampEncoder(delay_us), is_enc_delete_, writer, config);
+
+        auto begin = std::chrono::steady_clock::now();
+        for (uint32_t n = 1; n <= numFrames; ++n)
+        {
+            auto data = MakeFrame(format, n);
+            auto frame = CaptureDataObject(data.data(), format);
+            sink.Submit(&frame, 0, n);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+        sink.Flush();
+
+        auto stats = sink.GetStats();
+        EXPECT_LE(stats.MaxQueueDepth, config.QueueCapacity);
+        EXPECT_EQ(stats.Submitted + stats.Dropped, static_cast<uint64_t>(numFrames));
+        EXPECT_EQ(stats.Written, stats.Submitted);
+        if (policy == SinkOverflowPolicy::Drop)
+        {
+            EXPECT_GT(stats.Dropped, 0u);
+            EXPECT_EQ(stats.BlockedDuration.Count, 0u);
+            EXPECT_LT(elapsed, std::chrono::microseconds(delay_us * 2));
+        }
+        else
+        {
+            EXPECT_EQ(stats.Dropped, 0u);
+            EXPECT_GT(stats.BlockedDuration.Count, 0u);
+            EXPECT_GE(elapsed, std::chrono::microseconds(delay_us * (numFrames - config.QueueCapacity - 1)));
+        }
+    }
+}
+
+// 制御器に取り付けると公開されたフレームをファイルに書き出し、書きかけのファイルを残さないこと
+TEST(TS_Encoding_Sink, TC03)
+{
+    constexpr int numFrames = 30;
+
+    auto dir = std::filesystem::temp_directory_path() / "TS_Encoding_Sink";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, 300.0, 0, numFrames), is_cap_delete_, is_dbg_);
+    controller.Setup();
+
+    auto stats = EncodingSinkStats{};
+    {
+        auto config = EncodingSinkConfig{};
+        config.OverflowPolicy = SinkOverflowPolicy::Block;
+        auto sink = EncodingSink(new StampEncoder(), is_enc_delete_, dir.string(), config);
+        ASSERT_TRUE(sink.Start(&controller));
+        EXPECT_FALSE(sink.Start(&controller));
+
+        controller.StartCapture();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));  // numFrames at 300 fps
+        controller.FinishCapture();
+
+        sink.Stop();
+        sink.Flush();
+        stats = sink.GetStats();
+    }
+
+    EXPECT_GT(stats.Written, static_cast<uint64_t>(numFrames / 2));
+    EXPECT_LE(stats.Written + stats.Missed, static_cast<uint64_t>(numFrames));
+
+    auto numFiles = 0ull;
+    for (auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        ASSERT_EQ(entry.path().extension(), ".stamp");
+        ++numFiles;
+
+        auto stamp = SyntheticCapture::Stamp{};
+        auto file = std::ifstream(entry.path(), std::ios::binary);
+        file.read(reinterpret_cast<char*>(&stamp), sizeof(stamp));
+        EXPECT_EQ(std::stoull(entry.path().stem().string()), stamp.Number);
+    }
+    EXPECT_EQ(numFiles, stats.Written);
+
+    std::filesystem::remove_all(dir);
+}
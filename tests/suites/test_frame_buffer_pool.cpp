@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <gtest/gtest.h>
+#include "common/FrameBufferPool.hpp"
+
+
+static constexpr uint32_t width_ = 1280;
+static constexpr uint32_t height_ = 720;
+static constexpr uint32_t nChannel_ = 3;
+static constexpr uint32_t nBytesOfChannel_ = 1;
+
+static FrameFormat MakeFormat(void)
+{
+    auto format = FrameFormat{};
+    format.Width = width_;
+    format.Height = height_;
+    format.NumChannels = nChannel_;
+    format.NumBytesPerChannel = nBytesOfChannel_;
+    return format;
+}
+
+
+// フォーマット全体の大きさでアラインされたバッファを確保できること
+TEST(TS_Frame_Buffer_Pool, TC01)
+{
+    auto pool = FrameBufferPool(MakeFormat());
+
+    ASSERT_TRUE(pool.Reserve(4));
+    for (int n = 0; n < 6; ++n)
+    {
+        auto capDataObject = pool.Allocate();
+        ASSERT_NE(capDataObject, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(capDataObject->Data) % FrameBufferPool::Alignment, 0u);
+        EXPECT_EQ(capDataObject->Format.GetSizeOfFrame(), static_cast<uint64_t>(width_) * height_ * nChannel_ * nBytesOfChannel_);
+        EXPECT_EQ(capDataObject->Length * capDataObject->SizeOfData, capDataObject->Format.GetSizeOfFrame());
+
+        // the whole frame is writable
+        std::memset(const_cast<void*>(capDataObject->Data), 0xff, capDataObject->Format.GetSizeOfFrame());
+    }
+
+    EXPECT_GE(pool.GetBytesHeld(), pool.GetSizeOfBuffer() * 6);
+}
+
+// ヒュージページ指定でも確保でき、保持量が2MB単位になること
+TEST(TS_Frame_Buffer_Pool, TC02)
+{
+    auto pool = FrameBufferPool(MakeFormat(), true, true);
+
+    ASSERT_TRUE(pool.Reserve(2));
+    auto capDataObject = pool.Allocate();
+    ASSERT_NE(capDataObject, nullptr);
+    std::memset(const_cast<void*>(capDataObject->Data), 0xff, capDataObject->Format.GetSizeOfFrame());
+
+    EXPECT_EQ(pool.GetBytesHeld() % FrameBufferPool::HugePageSize, 0u);
+    EXPECT_LE(pool.GetBytesLocked(), pool.GetBytesHeld());
+}
+
+// NUMAノード指定で確保したバッファがそのノードに割り当てられ、存在しないノードでも確保はできること
+TEST(TS_Frame_Buffer_Pool, TC03)
+{
+    auto pool = FrameBufferPool(MakeFormat(), false, false, 0);
+    ASSERT_TRUE(pool.Reserve(2));
+    auto capDataObject = pool.Allocate();
+    ASSERT_NE(capDataObject, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(capDataObject->Data) % FrameBufferPool::Alignment, 0u);
+
+    // node 0 exists on every NUMA kernel; without NUMA support nothing is bound
+    EXPECT_TRUE((pool.GetBytesOnNode() == 0) || (pool.GetBytesOnNode() == pool.GetBytesHeld()));
+
+    auto nowhere = FrameBufferPool(MakeFormat(), false, false, 1000);
+    auto other = nowhere.Allocate();
+    ASSERT_NE(other, nullptr);
+    std::memset(const_cast<void*>(other->Data), 0xff, other->Format.GetSizeOfFrame());
+    EXPECT_EQ(nowhere.GetBytesOnNode(), 0u);
+}
+
+// 確保したバッファはプールを破棄した後も、手放すまで使えること
+TEST(TS_Frame_Buffer_Pool, TC04)
+{
+    auto pool = std::unique_ptr<FrameBufferPool>(new FrameBufferPool(MakeFormat(), true));
+    auto capDataObject = pool->Allocate();
+    ASSERT_NE(capDataObject, nullptr);
+    pool.reset();
+
+    auto size = capDataObject->Format.GetSizeOfFrame();
+    std::memset(const_cast<void*>(capDataObject->Data), 0x5a, size);
+    EXPECT_EQ(static_cast<const uint8_t*>(capDataObject->Data)[size - 1], 0x5a);
+}
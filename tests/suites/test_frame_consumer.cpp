@@ -0,0 +1,108 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/SyntheticCapture.hpp"
+#include "helpers/CountingCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int interval_us_ = CountingCapture::DefaultIntervalUs / 4;
+static constexpr int numFrames_ = 100;
+
+
+// 複数の読み手がそれぞれ全フレームを順番に受け取り、遅い読み手だけが取りこぼすこと
+TEST(TS_Frame_Consumer, TC01)
+{
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 16;
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, config, is_dbg_);
+
+    controller.Setup();
+
+    auto consumers = std::vector<std::unique_ptr<FrameConsumer>>{};
+    for (int idx = 0; idx < 3; ++idx)
+    {
+        consumers.push_back(controller.RegisterConsumer());
+    }
+
+    controller.StartCapture();
+
+    auto readers = std::vector<std::thread>{};
+    for (int idx = 0; idx < 3; ++idx)
+    {
+        // the last consumer is much slower than the camera
+        auto sleep_us = (idx == 2) ? interval_us_ * 4 : 0;
+        readers.emplace_back([&consumer = consumers[idx], sleep_us]{
+            uint64_t last_sequence = 0;
+            for (int n = 0; n < numFrames_; ++n)
+            {
+                auto lease = consumer->ReadNext();
+                ASSERT_TRUE(lease.IsValid());
+                EXPECT_GT(lease.GetSequence(), last_sequence);
+                EXPECT_EQ(CountingCapture::FrameNumberOf(lease.Get()), lease.GetSequence());
+                last_sequence = lease.GetSequence();
+
+                std::this_thread::sleep_for(std::chrono::microseconds(sleep_us));
+            }
+        });
+    }
+
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    auto stats = controller.GetConsumerStats();
+    ASSERT_EQ(stats.size(), 3u);
+    for (auto& consumer : stats)
+    {
+        EXPECT_EQ(consumer.Delivered, static_cast<uint64_t>(numFrames_));
+    }
+    EXPECT_EQ(stats[0].Dropped, 0u);
+    EXPECT_EQ(stats[1].Dropped, 0u);
+    EXPECT_GT(stats[2].Dropped, 0u);
+
+    controller.FinishCapture();
+
+    consumers.clear();
+    EXPECT_TRUE(controller.GetConsumerStats().empty());
+}
+
+// 映像が終わった後も、読み手はまだ読んでいない発行済みのフレームを最後まで受け取れること
+TEST(TS_Frame_Consumer, TC02)
+{
+    constexpr uint32_t numFrames = 10;
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 16;
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 0.0, 0, numFrames), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    auto consumer = controller.RegisterConsumer();
+    controller.StartCapture();
+
+    while (controller.GetState() != MultiThreadCaptureController::CaptureState::Quit)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    uint32_t number = 0;
+    while (auto lease = consumer->ReadNext(0))
+    {
+        EXPECT_EQ(SyntheticCapture::StampOf(lease.Get()).Number, number + 1);
+        number = SyntheticCapture::StampOf(lease.Get()).Number;
+    }
+    EXPECT_EQ(number, numFrames);
+    EXPECT_EQ(consumer->GetStats().Dropped, 0u);
+
+    consumer.reset();
+    controller.FinishCapture();
+}
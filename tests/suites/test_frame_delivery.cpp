@@ -0,0 +1,169 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <coroutine>
+#include <exception>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/SyntheticCapture.hpp"
+#include "common/ThreadPool.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr double fps_ = 500.0;
+static constexpr int numFrames_ = 50;
+
+// coroutine run to completion on whatever thread resumes it
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object() { return DetachedTask{}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+struct Received
+{
+    std::vector<uint32_t> Numbers;
+    std::vector<std::thread::id> Threads;
+    std::atomic<bool> IsDone{ false };
+};
+
+static DetachedTask ReceiveFrames(MultiThreadCaptureController* controller, FrameExecutor executor, Received* received)
+{
+    uint64_t lastSequence = 0;
+    while (true)
+    {
+        auto lease = co_await controller->NextFrame(lastSequence, executor);
+        if (!lease)
+        {
+            break;
+        }
+
+        received->Numbers.push_back(SyntheticCapture::StampOf(lease.Get()).Number);
+        received->Threads.push_back(std::this_thread::get_id());
+        lastSequence = lease.GetSequence();
+    }
+    received->IsDone.store(true);
+}
+
+static void WaitUntil(const std::atomic<bool>& flag)
+{
+    while (!flag.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+
+// コルーチンがスレッドを塞がずに新しいフレームを順に受け取り、撮影終了で無効なリースを受け取ること
+TEST(TS_Frame_Delivery, TC01)
+{
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, fps_, 0, numFrames_), is_cap_delete_, is_dbg_);
+    controller.Setup();
+
+    auto received = Received{};
+    ReceiveFrames(&controller, nullptr, &received);
+    EXPECT_FALSE(received.IsDone.load());
+
+    controller.StartCapture();
+    WaitUntil(received.IsDone);
+
+    ASSERT_FALSE(received.Numbers.empty());
+    for (size_t n = 1; n < received.Numbers.size(); ++n)
+    {
+        EXPECT_GT(received.Numbers[n], received.Numbers[n - 1]);
+    }
+    for (auto id : received.Threads)
+    {
+        EXPECT_NE(id, std::this_thread::get_id());
+    }
+
+    controller.FinishCapture();
+}
+
+// 実行器を指定したコルーチンは実行器のスレッドで再開されること
+TEST(TS_Frame_Delivery, TC02)
+{
+    auto pool = ThreadPool(1);
+    auto poolThread = std::thread::id{};
+    pool.Submit([&poolThread]{ poolThread = std::this_thread::get_id(); });
+    auto executor = [&pool](std::function<void(void)> task){ pool.Submit(std::move(task)); };
+
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, fps_, 0, numFrames_), is_cap_delete_, is_dbg_);
+    controller.Setup();
+
+    auto received = Received{};
+    ReceiveFrames(&controller, executor, &received);
+    controller.StartCapture();
+    WaitUntil(received.IsDone);
+
+    ASSERT_FALSE(received.Numbers.empty());
+    for (auto id : received.Threads)
+    {
+        EXPECT_EQ(id, poolThread);
+    }
+
+    controller.FinishCapture();
+}
+
+// コールバックが新しいフレームごとに一度だけ呼ばれ、解除した後は呼ばれないこと
+TEST(TS_Frame_Delivery, TC03)
+{
+    auto pool = ThreadPool(1);
+    auto executor = [&pool](std::function<void(void)> task){ pool.Submit(std::move(task)); };
+
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, fps_), is_cap_delete_, is_dbg_);
+    controller.Setup();
+
+    std::mutex mtx;
+    auto inlineSequences = std::vector<uint64_t>{};
+    auto pooledSequences = std::vector<uint64_t>{};
+    auto inlineId = controller.OnFrame([&](const FrameLease& lease){
+        std::lock_guard<std::mutex> lk(mtx);
+        EXPECT_TRUE(lease.IsValid());
+        inlineSequences.push_back(lease.GetSequence());
+    });
+    auto pooledId = controller.OnFrame([&](const FrameLease& lease){
+        std::lock_guard<std::mutex> lk(mtx);
+        pooledSequences.push_back(lease.GetSequence());
+    }, executor);
+
+    controller.StartCapture();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(controller.RemoveFrameCallback(inlineId));
+    EXPECT_TRUE(controller.RemoveFrameCallback(pooledId));
+    EXPECT_FALSE(controller.RemoveFrameCallback(pooledId));
+
+    std::lock_guard<std::mutex> lk(mtx);
+    auto numInline = inlineSequences.size();
+    auto numPooled = pooledSequences.size();
+    EXPECT_GT(numInline, 0u);
+    EXPECT_GT(numPooled, 0u);
+    for (auto sequences : { &inlineSequences, &pooledSequences })
+    {
+        for (size_t n = 1; n < sequences->size(); ++n)
+        {
+            EXPECT_GT((*sequences)[n], (*sequences)[n - 1]);
+        }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(inlineSequences.size(), numInline);
+    EXPECT_EQ(pooledSequences.size(), numPooled);
+
+    controller.FinishCapture();
+}
@@ -0,0 +1,126 @@
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/SyntheticCapture.hpp"
+#include "helpers/CountingCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int interval_us_ = CountingCapture::DefaultIntervalUs;
+static constexpr int numFrames_ = 50;
+
+
+// Stage slower than the camera that doubles the width and copies the frame number
+class WideningStage : public IFrameStage
+{
+    private:
+        int sleep_us_;
+
+    public:
+        explicit WideningStage(int sleep_us) : sleep_us_(sleep_us) {}
+
+        FrameFormat GetOutputFormat(const FrameFormat& input) override
+        {
+            auto output = input;
+            output.Width *= 2;
+            output.Stride = 0;
+            return output;
+        }
+
+        bool Process(const CaptureDataObject* input, const CaptureDataObject* output) override
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleep_us_));
+            std::memset(const_cast<void*>(output->Data), 0, output->Format.GetSizeOfFrame());
+            std::memcpy(const_cast<void*>(output->Data), input->Data, sizeof(uint32_t));
+            return true;
+        }
+};
+
+
+// 処理段がカメラより遅くても、ワーカーを増やせば全フレームが撮影順に取りこぼしなく公開されること
+TEST(TS_Frame_Pipeline, TC01)
+{
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 8;
+    config.NumStageWorkers = 4;
+    config.Stages.push_back(std::make_shared<WideningStage>(interval_us_ * 3));
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, config, is_dbg_);
+
+    EXPECT_EQ(controller.GetFormat().Width, static_cast<uint32_t>(CountingCapture::DefaultLength * 2));
+
+    auto consumer = controller.RegisterConsumer();
+
+    controller.Setup();
+    controller.StartCapture();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 1; n <= numFrames_; ++n)
+    {
+        auto lease = consumer->ReadNext();
+        ASSERT_TRUE(lease.IsValid());
+        EXPECT_EQ(lease.GetSequence(), static_cast<uint64_t>(n));
+        EXPECT_EQ(CountingCapture::FrameNumberOf(lease.Get()), static_cast<uint32_t>(n));
+        EXPECT_EQ(lease->Format.GetSizeOfFrame(), static_cast<uint64_t>(CountingCapture::DefaultLength * 2));
+    }
+    auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    controller.FinishCapture();
+
+    // a single worker would need three intervals per frame
+    EXPECT_LT(elapsed_us, static_cast<int64_t>(numFrames_) * interval_us_ * 2);
+    EXPECT_EQ(consumer->GetStats().Dropped, 0u);
+    EXPECT_EQ(controller.GetNumDropped(), 0u);
+    EXPECT_GE(controller.GetNumProcessed(), static_cast<uint64_t>(numFrames_));
+}
+
+// 無損失キューと処理段を組み合わせても、遅い読み手に合わせて待ち、映像の終わりまで全フレームを順に受け取れること
+TEST(TS_Frame_Pipeline, TC02)
+{
+    constexpr uint32_t numFrames = 100;
+    constexpr int depth = 2;
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 4;
+    config.NumStageWorkers = 2;
+    config.Buffering = BufferingPolicy::Lossless;
+    config.QueueDepth = depth;
+    config.QueueOverflow = QueueOverflowPolicy::Block;
+    config.Stages.push_back(std::make_shared<WideningStage>(100));
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 0.0, 0, numFrames), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    // the reader keeps a lease now and then, so that the commit also waits for a slot
+    uint32_t number = 0;
+    auto kept = FrameLease{};
+    while (auto lease = controller.Dequeue())
+    {
+        EXPECT_EQ(CountingCapture::FrameNumberOf(lease.Get()), number + 1);
+        number = CountingCapture::FrameNumberOf(lease.Get());
+        if (number % 10 == 0)
+        {
+            kept = std::move(lease);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    kept = FrameLease{};
+    EXPECT_EQ(number, numFrames);
+
+    controller.FinishCapture();
+
+    auto stats = controller.GetStats();
+    EXPECT_EQ(controller.GetNumDropped(), 0u);
+    EXPECT_EQ(controller.GetNumProcessed(), static_cast<uint64_t>(numFrames));
+    EXPECT_EQ(stats.QueueOverflows, 0u);
+    EXPECT_GT(stats.QueueBlocks, 0u);
+}
@@ -0,0 +1,130 @@
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/CaptureExecutor.hpp"
+#include "common/SyntheticCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static CaptureControllerConfig MakeLossless(QueueOverflowPolicy overflow, int depth)
+{
+    auto config = CaptureControllerConfig{};
+    config.Buffering = BufferingPolicy::Lossless;
+    config.QueueDepth = depth;
+    config.QueueOverflow = overflow;
+    return config;
+}
+
+
+// 満杯で待つ無損失キューでは、遅い読み手も全フレームを順に受け取り、撮影終了後も残りを受け取れること
+TEST(TS_Frame_Queue, TC01)
+{
+    constexpr uint32_t numFrames = 200;
+    constexpr int depth = 4;
+
+    auto controller = MultiThreadCaptureController(
+            new SyntheticCapture(64, 16, 3, 0.0, 0, numFrames), is_cap_delete_, MakeLossless(QueueOverflowPolicy::Block, depth), is_dbg_
+        );
+    EXPECT_GE(controller.GetNumCaptureData(), depth + 2);
+    controller.Setup();
+    controller.StartCapture();
+
+    uint32_t number = 0;
+    while (auto lease = controller.Dequeue())
+    {
+        EXPECT_EQ(SyntheticCapture::StampOf(lease.Get()).Number, number + 1);
+        number = SyntheticCapture::StampOf(lease.Get()).Number;
+        if (number % 20 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    EXPECT_EQ(number, numFrames);
+
+    auto stats = controller.GetStats();
+    EXPECT_EQ(stats.Produced, static_cast<uint64_t>(numFrames));
+    EXPECT_EQ(stats.QueueDepth, 0u);
+    EXPECT_EQ(stats.QueueHighWater, static_cast<uint64_t>(depth));
+    EXPECT_GT(stats.QueueBlocks, 0u);
+    EXPECT_EQ(stats.QueueOverflows, 0u);
+    controller.FinishCapture();
+}
+
+// 満杯で捨てる無損失キューでは、キュー内のフレームは上書きされず、あふれたフレームが数えられること
+TEST(TS_Frame_Queue, TC02)
+{
+    constexpr int depth = 4;
+
+    auto controller = MultiThreadCaptureController(
+            new SyntheticCapture(64, 16, 3, 1000.0), is_cap_delete_, MakeLossless(QueueOverflowPolicy::Drop, depth), is_dbg_
+        );
+    controller.Setup();
+    controller.StartCapture();
+
+    // the producer goes on while the queue is full, and readers of the latest frame still see new frames
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto stats = controller.GetStats();
+    EXPECT_EQ(stats.QueueDepth, static_cast<uint64_t>(depth));
+    EXPECT_GT(stats.QueueOverflows, 0u);
+    EXPECT_EQ(SyntheticCapture::StampOf(controller.Lease().Get()).Number, static_cast<uint32_t>(depth));
+
+    for (uint32_t n = 1; n <= depth; ++n)
+    {
+        auto lease = controller.Dequeue();
+        ASSERT_TRUE(lease.IsValid());
+        EXPECT_EQ(SyntheticCapture::StampOf(lease.Get()).Number, n);
+    }
+
+    // frames captured while the queue was full are gone; the queue goes on with the next ones published
+    auto lease = controller.Dequeue();
+    ASSERT_TRUE(lease.IsValid());
+    EXPECT_GT(SyntheticCapture::StampOf(lease.Get()).Number, static_cast<uint32_t>(depth + 1));
+    EXPECT_EQ(lease.GetSequence(), static_cast<uint64_t>(depth + 1));
+    lease = FrameLease{};
+
+    controller.FinishCapture();
+    EXPECT_EQ(controller.GetStats().QueueHighWater, static_cast<uint64_t>(depth));
+}
+
+// 最新フレーム方式ではキューから取り出せず、共有された作業スレッドは満杯のキューで塞がれないこと
+TEST(TS_Frame_Queue, TC03)
+{
+    auto latest = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 1000.0), is_cap_delete_, is_dbg_);
+    latest.Setup();
+    latest.StartCapture();
+    EXPECT_FALSE(latest.Dequeue(1000 * 1000).IsValid());
+    EXPECT_EQ(latest.GetStats().QueueDepth, 0u);
+    latest.FinishCapture();
+
+    auto executor = CaptureExecutor(1);
+    auto config = MakeLossless(QueueOverflowPolicy::Block, 2);
+    config.Executor = &executor;
+    auto blocked = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 0.0), is_cap_delete_, config, is_dbg_);
+    config.Buffering = BufferingPolicy::LatestOnly;
+    auto other = MultiThreadCaptureController(new SyntheticCapture(64, 16, 3, 1000.0), is_cap_delete_, config, is_dbg_);
+    for (auto controller : { &blocked, &other })
+    {
+        controller->Setup();
+        controller->StartCapture();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(blocked.GetStats().QueueDepth, 2u);
+    auto sequence = other.Lease().GetSequence();
+    EXPECT_TRUE(other.LeaseNext(sequence, 100 * 1000 * 1000).IsValid());
+
+    EXPECT_EQ(SyntheticCapture::StampOf(blocked.Dequeue().Get()).Number, 1u);
+    EXPECT_EQ(SyntheticCapture::StampOf(blocked.Dequeue().Get()).Number, 2u);
+    EXPECT_EQ(SyntheticCapture::StampOf(blocked.Dequeue().Get()).Number, 3u);
+
+    blocked.FinishCapture();
+    other.FinishCapture();
+}
@@ -0,0 +1,129 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/FrameWindowBuffer.hpp"
+#include "common/SyntheticCapture.hpp"
+#include "helpers/CountingCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int numWindows_ = 50;
+
+
+// 最新の連続したフレームが古い順に固定されて返り、履歴の深さ以上の長さは拒否されること
+TEST(TS_Frame_Window, TC01)
+{
+    constexpr int length = 4;
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 8;
+    auto controller = MultiThreadCaptureController(new CountingCapture(), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    EXPECT_FALSE(controller.ReadWindow(0));
+    EXPECT_FALSE(controller.ReadWindow(config.NumCaptureData));
+    EXPECT_FALSE(controller.ReadWindow(length, true));
+
+    for (int n = 0; n < numWindows_; ++n)
+    {
+        auto window = controller.ReadWindow(length);
+        ASSERT_TRUE(window.IsValid());
+        ASSERT_EQ(window.GetLength(), length);
+        EXPECT_FALSE(window.IsPacked());
+
+        for (int k = 1; k < length; ++k)
+        {
+            EXPECT_EQ(window.GetSequence(k), window.GetSequence(k - 1) + 1);
+            EXPECT_GE(window.GetCapturedTime(k), window.GetCapturedTime(k - 1));
+            EXPECT_EQ(CountingCapture::FrameNumberOf(window[k].Get()), CountingCapture::FrameNumberOf(window[k - 1].Get()) + 1);
+        }
+
+        // the frames stay as they were while the window is held
+        auto first = CountingCapture::FrameNumberOf(window[0].Get());
+        std::this_thread::sleep_for(std::chrono::microseconds(CountingCapture::DefaultIntervalUs * 3));
+        EXPECT_EQ(CountingCapture::FrameNumberOf(window[0].Get()), first);
+    }
+
+    controller.FinishCapture();
+}
+
+// 詰めたウィンドウが各フレームと同じ内容を連続した領域に持ち、バッファの終端をまたいでも連続していること
+TEST(TS_Frame_Window, TC02)
+{
+    constexpr int length = 5;
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 8;
+    config.PackedWindowCapacity = 8;
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 16, 4, 1000.0), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    auto numPacked = 0;
+    for (int n = 0; n < numWindows_; ++n)
+    {
+        auto window = controller.ReadWindow(length, true);
+        ASSERT_TRUE(window.IsValid());
+        if (!window.IsPacked())
+        {
+            continue;
+        }
+        ++numPacked;
+
+        auto packed = static_cast<const uint8_t*>(window.GetPacked());
+        auto sizeOfFrame = window.GetSizeOfFrame();
+        for (int k = 0; k < length; ++k)
+        {
+            EXPECT_EQ(std::memcmp(packed + sizeOfFrame * k, window[k].Data(), sizeOfFrame), 0);
+            EXPECT_EQ(SyntheticCapture::StampOf(window[k].Get()).Number, SyntheticCapture::StampOf(window[0].Get()).Number + k);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_GT(numPacked, numWindows_ / 2);
+
+    controller.FinishCapture();
+}
+
+// 読み手が固定した枠は上書きされず、二重写像できない大きさでは終端をまたぐ窓を返さないこと
+TEST(TS_Frame_Window, TC03)
+{
+    auto format = FrameFormat{ 10, 1, 3, 1, 0 };  // 30 bytes: no page-aligned capacity close to the one requested
+    auto buffer = FrameWindowBuffer(format, 4);
+    ASSERT_TRUE(buffer.IsValid());
+    EXPECT_FALSE(buffer.IsMirrored());
+    EXPECT_EQ(buffer.GetCapacity(), 4);
+
+    auto data = std::vector<uint8_t>(format.GetSizeOfFrame());
+    auto frame = CaptureDataObject(data.data(), format);
+    for (uint64_t sequence = 1; sequence <= 4; ++sequence)
+    {
+        std::memset(data.data(), static_cast<int>(sequence), data.size());
+        EXPECT_TRUE(buffer.Write(&frame, sequence));
+    }
+
+    auto packed = buffer.Pin(1, 3);
+    ASSERT_NE(packed, nullptr);
+    EXPECT_EQ(packed[format.GetSizeOfFrame() * 2], 3);
+    EXPECT_EQ(buffer.Pin(3, 2), nullptr);  // 3, 4 then 1: across the end
+
+    // frame 5 would go where frame 1 is pinned
+    EXPECT_FALSE(buffer.Write(&frame, 5));
+    EXPECT_EQ(buffer.GetNumSkipped(), 1u);
+    EXPECT_EQ(packed[0], 1);
+
+    buffer.Unpin(1, 3);
+    EXPECT_TRUE(buffer.Write(&frame, 5));
+    EXPECT_EQ(buffer.Pin(4, 1)[0], 4);
+    buffer.Unpin(4, 1);
+}
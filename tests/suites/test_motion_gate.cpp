@@ -0,0 +1,185 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/MotionGate.hpp"
+#include "common/SyntheticCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+// Gray scene of one value, which steps by 50 every numFramesPerScene frames; ends after numFrames frames
+class SceneCapture : public ICapturable
+{
+    private:
+        FrameFormat format_;
+        int numFramesPerScene_;
+        int numFrames_;
+        int interval_us_;
+        int count_;
+
+    public:
+        SceneCapture(int numFramesPerScene, int numFrames, int interval_us)
+            : format_{ 64, 32, 1, 1, 0 }, numFramesPerScene_(numFramesPerScene), numFrames_(numFrames),
+              interval_us_(interval_us), count_(0)
+        {
+        }
+
+        bool Capture(const CaptureDataObject* captureDataObject) override
+        {
+            if (count_ == numFrames_)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+            auto value = ValueOf(count_++);
+            std::memset(const_cast<void*>(captureDataObject->Data), value, format_.GetSizeOfFrame());
+            return true;
+        }
+
+        uint64_t GetNBytes() override { return sizeof(uint8_t); }
+
+        uint64_t GetLength() override { return format_.GetSizeOfFrame(); }
+
+        FrameFormat GetFormat() override { return format_; }
+
+        int ValueOf(int n) const { return (n / numFramesPerScene_) * 50 % 250; }
+};
+
+
+// 格子状に間引いた行と区間だけで平均差分が求まること
+TEST(TS_Motion_Gate, TC01)
+{
+    auto format = FrameFormat{ 256, 8, 1, 1, 0 };
+    auto a = std::vector<uint8_t>(format.GetSizeOfFrame(), 10);
+    auto b = std::vector<uint8_t>(format.GetSizeOfFrame(), 10);
+    auto frame = CaptureDataObject(a.data(), format);
+    auto reference = CaptureDataObject(b.data(), format);
+
+    auto gate = MotionGate(4.0, 2);
+    EXPECT_EQ(gate.Measure(&frame, &reference), 0.0);
+    EXPECT_TRUE(gate.IsStill(&frame, &reference));
+
+    // rows 0, 2, 4, 6 and bytes 0-63, 128-191 are sampled
+    for (uint32_t y = 0; y < format.Height; ++y)
+    {
+        std::memset(a.data() + 256 * y + 64, 200, 64);
+        std::memset(a.data() + 256 * y + 192, 200, 64);
+    }
+    for (uint32_t y = 1; y < format.Height; y += 2)
+    {
+        std::memset(a.data() + 256 * y, 200, 256);
+    }
+    EXPECT_EQ(gate.Measure(&frame, &reference), 0.0);
+
+    a[256 * 2 + 128] = 10 + 128;
+    EXPECT_DOUBLE_EQ(gate.Measure(&frame, &reference), 128.0 / (4 * 128));
+    EXPECT_TRUE(gate.IsStill(&frame, &reference));
+
+    std::memset(a.data() + 256 * 4, 210, 64);
+    EXPECT_FALSE(gate.IsStill(&frame, &reference));
+
+    auto other = CaptureDataObject(b.data(), FrameFormat{ 128, 16, 1, 1, 0 });
+    EXPECT_LT(gate.Measure(&frame, &other), 0.0);
+    EXPECT_FALSE(gate.IsStill(&frame, &other));
+}
+
+// 変化のないフレームは公開されず、読み手は場面が変わったフレームだけを受け取ること
+TEST(TS_Motion_Gate, TC02)
+{
+    constexpr int numFramesPerScene = 10;
+    constexpr int numFrames = 100;
+
+    auto config = CaptureControllerConfig{};
+    config.MotionThreshold = 10.0;
+    config.MotionKeepAlive = 0;
+    auto cap = new SceneCapture(numFramesPerScene, numFrames, 500);
+    auto controller = MultiThreadCaptureController(cap, is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    auto consumer = controller.RegisterConsumer();
+    controller.StartCapture();
+
+    auto values = std::vector<int>{};
+    while (auto lease = consumer->ReadNext())
+    {
+        values.push_back(static_cast<const uint8_t*>(lease.Data())[0]);
+    }
+
+    for (size_t n = 1; n < values.size(); ++n)
+    {
+        EXPECT_NE(values[n], values[n - 1]);
+    }
+
+    consumer.reset();
+    controller.FinishCapture();
+
+    auto stats = controller.GetStats();
+    EXPECT_EQ(stats.Produced, static_cast<uint64_t>(numFrames / numFramesPerScene));
+    EXPECT_EQ(stats.Suppressed, static_cast<uint64_t>(numFrames - numFrames / numFramesPerScene));
+    EXPECT_EQ(stats.MotionCheck.Count, static_cast<uint64_t>(numFrames - 1));
+}
+
+// 変化がなくても指定した間隔でフレームが公開されること
+TEST(TS_Motion_Gate, TC03)
+{
+    constexpr int numFrames = 100;
+    constexpr int interval_us = 1000;
+
+    auto config = CaptureControllerConfig{};
+    config.MotionThreshold = 10.0;
+    config.MotionKeepAlive = 20 * 1000 * 1000;
+    auto controller = MultiThreadCaptureController(new SceneCapture(numFrames, numFrames, interval_us), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    while (controller.GetState() != MultiThreadCaptureController::CaptureState::Quit)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    controller.FinishCapture();
+
+    auto stats = controller.GetStats();
+    EXPECT_GE(stats.Produced, 2u);
+    EXPECT_GT(stats.Suppressed, stats.Produced);
+    EXPECT_EQ(stats.Produced + stats.Suppressed, static_cast<uint64_t>(numFrames));
+    EXPECT_GE(stats.FrameInterval.GetPercentile(0.0), config.MotionKeepAlive / 2);
+}
+
+// 遅延デコードで変化のないフレームが抑えられても、読み手は次の取り込みを待つだけで最新のフレームを受け取れること
+TEST(TS_Motion_Gate, TC04)
+{
+    constexpr int numReads = 10;
+    constexpr auto maxWait = std::chrono::milliseconds(100);  // a frame comes every 10 ms
+
+    auto config = CaptureControllerConfig{};
+    config.LazyRetrieve = true;
+    config.MotionThreshold = 1000.0;
+    config.MotionKeepAlive = 0;
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, 100.0, 0, 300), is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    // every frame after the first is suppressed, so the first one stands for all the grabs
+    for (int n = 0; n < numReads; ++n)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        auto lease = controller.Lease();
+        EXPECT_LT(std::chrono::steady_clock::now() - begin, maxWait);
+        ASSERT_TRUE(lease.IsValid());
+        EXPECT_EQ(lease.GetSequence(), 1u);
+        EXPECT_EQ(SyntheticCapture::StampOf(lease.Get()).Number, 1u);
+        std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    }
+
+    controller.FinishCapture();
+    EXPECT_GT(controller.GetStats().Suppressed, 0u);
+}
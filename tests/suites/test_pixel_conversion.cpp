@@ -0,0 +1,192 @@
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include "common/PixelConversion.hpp"
+#include "common/PixelConversionStage.hpp"
+
+
+static constexpr PixelIsa isas_[] = { PixelIsa::Scalar, PixelIsa::Sse41, PixelIsa::Avx2, PixelIsa::Neon };
+
+static constexpr PixelConversionType types_[] = {
+    PixelConversionType::BgrToRgb,
+    PixelConversionType::BgrToGray,
+    PixelConversionType::BgrToPlanar,
+    PixelConversionType::YuyvToBgr,
+    PixelConversionType::U8ToF32,
+    PixelConversionType::BgrToRgbPlanarF32,
+};
+
+// frame in a std::vector together with the CaptureDataObject describing it
+struct TestFrame
+{
+    std::vector<uint8_t> Buffer;
+    std::unique_ptr<CaptureDataObject> Object;
+
+    explicit TestFrame(const FrameFormat& format)
+        : Buffer(format.GetSizeOfFrame()),
+          Object(new CaptureDataObject(Buffer.data(), format))
+    {
+    }
+};
+
+static FrameFormat MakeInputFormat(PixelConversionType type, uint32_t width, uint32_t height, uint64_t padding)
+{
+    auto format = FrameFormat{};
+    format.Width = width;
+    format.Height = height;
+    format.NumChannels = (type == PixelConversionType::YuyvToBgr) ? 2 : 3;
+    format.NumBytesPerChannel = 1;
+    format.Stride = format.GetRowBytes() + padding;
+    return format;
+}
+
+
+// どの命令セットのカーネルもスカラー版と同じ結果を返すこと (端数の画素と行のパディングを含む)
+TEST(TS_Pixel_Conversion, TC01)
+{
+    auto engine = std::mt19937(12345);
+    const float mean[] = { 123.675f, 116.28f, 103.53f, 0.0f };
+    const float scale[] = { 1.0f / 58.395f, 1.0f / 57.12f, 1.0f / 57.375f, 1.0f };
+
+    for (auto type : types_)
+    {
+        auto inputFormat = MakeInputFormat(type, 38 + 64, 5, 13);
+        auto input = TestFrame(inputFormat);
+        for (auto& value : input.Buffer)
+        {
+            value = static_cast<uint8_t>(engine());
+        }
+
+        auto outputFormat = PixelConversion::GetOutputFormat(type, inputFormat);
+        auto expected = TestFrame(outputFormat);
+        ASSERT_TRUE(PixelConversion::SetIsa(PixelIsa::Scalar));
+        ASSERT_TRUE(PixelConversion::Convert(type, input.Object.get(), expected.Object.get(), mean, scale));
+
+        for (auto isa : isas_)
+        {
+            if (!PixelConversion::SetIsa(isa))
+            {
+                continue;
+            }
+
+            auto actual = TestFrame(outputFormat);
+            ASSERT_TRUE(PixelConversion::Convert(type, input.Object.get(), actual.Object.get(), mean, scale));
+            EXPECT_EQ(std::memcmp(actual.Buffer.data(), expected.Buffer.data(), actual.Buffer.size()), 0)
+                << "conversion " << static_cast<int>(type) << " with " << PixelConversion::GetIsaName(isa);
+        }
+    }
+
+    PixelConversion::SetIsa(PixelConversion::GetBestIsa());
+}
+
+// 既知の画素値が期待どおりに変換されること
+TEST(TS_Pixel_Conversion, TC02)
+{
+    auto bgrFormat = MakeInputFormat(PixelConversionType::BgrToRgb, 32, 1, 0);
+    auto bgr = TestFrame(bgrFormat);
+    for (size_t idx = 0; idx < bgr.Buffer.size(); idx += 3)
+    {
+        bgr.Buffer[idx + 0] = 10;
+        bgr.Buffer[idx + 1] = 20;
+        bgr.Buffer[idx + 2] = 30;
+    }
+    bgr.Buffer[0] = 0;
+    bgr.Buffer[1] = 0;
+    bgr.Buffer[2] = 255;
+
+    auto rgb = TestFrame(PixelConversion::GetOutputFormat(PixelConversionType::BgrToRgb, bgrFormat));
+    ASSERT_TRUE(PixelConversion::Convert(PixelConversionType::BgrToRgb, bgr.Object.get(), rgb.Object.get()));
+    EXPECT_EQ(rgb.Buffer[0], 255);
+    EXPECT_EQ(rgb.Buffer[3], 30);
+    EXPECT_EQ(rgb.Buffer[4], 20);
+    EXPECT_EQ(rgb.Buffer[5], 10);
+
+    auto gray = TestFrame(PixelConversion::GetOutputFormat(PixelConversionType::BgrToGray, bgrFormat));
+    ASSERT_TRUE(PixelConversion::Convert(PixelConversionType::BgrToGray, bgr.Object.get(), gray.Object.get()));
+    EXPECT_EQ(gray.Buffer[0], 76);  // pure red
+    EXPECT_EQ(gray.Buffer[1], 22);
+
+    const float mean[] = { 1.0f, 2.0f, 3.0f, 0.0f };
+    const float scale[] = { 0.5f, 0.5f, 0.5f, 1.0f };
+    auto planarFormat = PixelConversion::GetOutputFormat(PixelConversionType::BgrToRgbPlanarF32, bgrFormat);
+    EXPECT_TRUE(planarFormat.IsPlanar);
+    EXPECT_EQ(planarFormat.GetSizeOfFrame(), 32u * 3 * sizeof(float));
+
+    auto planar = TestFrame(planarFormat);
+    ASSERT_TRUE(PixelConversion::Convert(PixelConversionType::BgrToRgbPlanarF32, bgr.Object.get(), planar.Object.get(), mean, scale));
+    auto planes = reinterpret_cast<const float*>(planar.Buffer.data());
+    EXPECT_FLOAT_EQ(planes[1], 14.5f);  // R
+    EXPECT_FLOAT_EQ(planes[32 + 1], 9.0f);  // G
+    EXPECT_FLOAT_EQ(planes[64 + 1], 3.5f);  // B
+
+    auto yuyvFormat = MakeInputFormat(PixelConversionType::YuyvToBgr, 32, 1, 0);
+    auto yuyv = TestFrame(yuyvFormat);
+    for (size_t idx = 0; idx < yuyv.Buffer.size(); idx += 4)
+    {
+        yuyv.Buffer[idx + 0] = 235;  // white
+        yuyv.Buffer[idx + 1] = 128;
+        yuyv.Buffer[idx + 2] = 16;  // black
+        yuyv.Buffer[idx + 3] = 128;
+    }
+
+    auto fromYuyv = TestFrame(PixelConversion::GetOutputFormat(PixelConversionType::YuyvToBgr, yuyvFormat));
+    ASSERT_TRUE(PixelConversion::Convert(PixelConversionType::YuyvToBgr, yuyv.Object.get(), fromYuyv.Object.get()));
+    EXPECT_EQ(fromYuyv.Buffer[0], 255);
+    EXPECT_EQ(fromYuyv.Buffer[2], 255);
+    EXPECT_EQ(fromYuyv.Buffer[3], 0);
+    EXPECT_EQ(fromYuyv.Buffer[5], 0);
+}
+
+// 形式の合わない入出力を拒否し、ステージとして出力形式を伝えること
+TEST(TS_Pixel_Conversion, TC03)
+{
+    auto yuyvFormat = MakeInputFormat(PixelConversionType::YuyvToBgr, 16, 2, 0);
+    EXPECT_FALSE(PixelConversion::IsConvertible(PixelConversionType::BgrToGray, yuyvFormat));
+
+    auto yuyv = TestFrame(yuyvFormat);
+    auto wrong = TestFrame(yuyvFormat);
+    EXPECT_FALSE(PixelConversion::Convert(PixelConversionType::YuyvToBgr, yuyv.Object.get(), wrong.Object.get()));
+
+    auto stage = PixelConversionStage(PixelConversionType::YuyvToBgr);
+    auto outputFormat = stage.GetOutputFormat(yuyvFormat);
+    EXPECT_EQ(outputFormat.NumChannels, 3u);
+
+    auto output = TestFrame(outputFormat);
+    EXPECT_TRUE(stage.Process(yuyv.Object.get(), output.Object.get()));
+}
+
+// 差分絶対値和がどの命令セットでも定義どおりの値になること (端数のバイトを含む)
+TEST(TS_Pixel_Conversion, TC04)
+{
+    auto engine = std::mt19937(54321);
+    auto a = std::vector<uint8_t>(1000);
+    auto b = std::vector<uint8_t>(1000);
+    for (size_t idx = 0; idx < a.size(); ++idx)
+    {
+        a[idx] = static_cast<uint8_t>(engine());
+        b[idx] = static_cast<uint8_t>(engine());
+    }
+
+    for (size_t length : { 0, 1, 15, 16, 33, 100, 1000 })
+    {
+        uint64_t expected = 0;
+        for (size_t idx = 0; idx < length; ++idx)
+        {
+            expected += (a[idx] > b[idx]) ? a[idx] - b[idx] : b[idx] - a[idx];
+        }
+
+        for (auto isa : isas_)
+        {
+            if (!PixelConversion::SetIsa(isa))
+            {
+                continue;
+            }
+            EXPECT_EQ(PixelConversion::SumOfAbsDiff(a.data(), b.data(), length), expected)
+                << length << " bytes with " << PixelConversion::GetIsaName(isa);
+        }
+    }
+
+    PixelConversion::SetIsa(PixelConversion::GetBestIsa());
+}
@@ -0,0 +1,141 @@
+#include <string>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/RawRecorder.hpp"
+#include "common/RawReplayCapture.hpp"
+#include "helpers/CountingCapture.hpp"
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static constexpr int interval_us_ = CountingCapture::DefaultIntervalUs;
+static constexpr int numFrames_ = 50;
+
+// records numFrames_ frames of a CountingCapture through the controller
+static std::string MakeRecording(void)
+{
+    auto path = (std::filesystem::temp_directory_path() / "TS_Raw_Recording.raw").string();
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 16;
+    auto controller = MultiThreadCaptureController(new CountingCapture(interval_us_), is_cap_delete_, config, is_dbg_);
+    auto recorder = RawRecorder(path, controller.GetFormat(), numFrames_);
+    EXPECT_TRUE(recorder.IsOpen());
+
+    controller.Setup();
+    EXPECT_TRUE(recorder.Start(&controller));
+    controller.StartCapture();
+
+    while (recorder.GetNumFrames() < numFrames_)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(interval_us_));
+    }
+
+    controller.FinishCapture();
+    recorder.Close();
+
+    return path;
+}
+
+
+// 記録した全フレームを順番どおりにマッピング上のまま返し、最後にnullptrを返すこと
+TEST(TS_Raw_Recording, TC01)
+{
+    auto path = MakeRecording();
+    auto cap = RawReplayCapture(path);
+    ASSERT_TRUE(cap.IsOpen());
+    ASSERT_EQ(cap.GetNumFrames(), static_cast<uint64_t>(numFrames_));
+    EXPECT_TRUE(cap.IsZeroCopy());
+    EXPECT_EQ(cap.GetFormat().GetSizeOfFrame(), static_cast<uint64_t>(CountingCapture::DefaultLength));
+
+    uint32_t lastNumber = 0;
+    for (int n = 0; n < numFrames_; ++n)
+    {
+        auto frame = cap.Borrow();
+        ASSERT_NE(frame, nullptr);
+        EXPECT_TRUE(cap.Contains(frame->Data));
+        EXPECT_GT(CountingCapture::FrameNumberOf(frame.get()), lastNumber);
+        lastNumber = CountingCapture::FrameNumberOf(frame.get());
+    }
+    EXPECT_EQ(cap.Borrow(), nullptr);
+}
+
+// コントローラ経由で元の撮影間隔を保って再生し、フレームをコピーせずに配ること
+TEST(TS_Raw_Recording, TC02)
+{
+    auto path = MakeRecording();
+    auto cap = RawReplayCapture(path, true);
+    ASSERT_TRUE(cap.IsOpen());
+    auto recorded = cap.GetCapturedTime(numFrames_ - 1) - cap.GetCapturedTime(0);
+
+    auto config = CaptureControllerConfig{};
+    config.NumCaptureData = 16;
+    auto controller = MultiThreadCaptureController(&cap, !is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    auto consumer = controller.RegisterConsumer();
+
+    auto begin = std::chrono::steady_clock::now();
+    controller.StartCapture();
+
+    uint32_t lastNumber = 0;
+    int numRead = 0;
+    while (auto lease = consumer->ReadNext())
+    {
+        EXPECT_TRUE(cap.Contains(lease.Data()));
+        EXPECT_GT(CountingCapture::FrameNumberOf(lease.Get()), lastNumber);
+        lastNumber = CountingCapture::FrameNumberOf(lease.Get());
+        ++numRead;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+
+    EXPECT_EQ(numRead, numFrames_);
+    EXPECT_EQ(consumer->GetStats().Dropped, 0);
+    EXPECT_GE(static_cast<uint64_t>(elapsed), recorded);
+
+    consumer.reset();
+    controller.FinishCapture();
+}
+
+// 再生ソースを破棄した後も、受け取ったフレームを参照できること
+TEST(TS_Raw_Recording, TC03)
+{
+    auto path = MakeRecording();
+    auto cap = new RawReplayCapture(path);
+    auto frame = cap->Borrow();
+    ASSERT_NE(frame, nullptr);
+    auto number = CountingCapture::FrameNumberOf(frame.get());
+
+    delete cap;
+    EXPECT_EQ(CountingCapture::FrameNumberOf(frame.get()), number);
+}
+
+// 容量を超えたフレームは書かれずに数えられ、壊れたファイルは開けないこと
+TEST(TS_Raw_Recording, TC04)
+{
+    auto path = (std::filesystem::temp_directory_path() / "TS_Raw_Recording_small.raw").string();
+    auto format = FrameFormat{ 8, 2, 1, 1, 0 };
+    uint8_t buffer[16] = {};
+    auto frame = CaptureDataObject(buffer, format);
+
+    {
+        auto recorder = RawRecorder(path, format, 2);
+        EXPECT_TRUE(recorder.Append(&frame, 10, 1));
+        EXPECT_TRUE(recorder.Append(&frame, 20, 2));
+        EXPECT_FALSE(recorder.Append(&frame, 30, 3));
+        EXPECT_EQ(recorder.GetNumFrames(), 2);
+        EXPECT_EQ(recorder.GetNumDropped(), 1);
+    }
+
+    EXPECT_EQ(RawReplayCapture(path).GetNumFrames(), 2);
+
+    std::filesystem::resize_file(path, 16);
+    EXPECT_FALSE(RawReplayCapture(path).IsOpen());
+}
@@ -0,0 +1,258 @@
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/SharedFramePublisher.hpp"
+#include "common/SharedFrameCapture.hpp"
+#include "common/SyntheticCapture.hpp"
+
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+static const auto format_ = FrameFormat{ 64, 16, 3, 1, 0 };
+
+static std::string MakeName(const char* test)
+{
+    return "/TS_Shared_Frames_" + std::string(test) + "_" + std::to_string(getpid());
+}
+
+static std::vector<uint8_t> MakeFrame(uint32_t number)
+{
+    auto data = std::vector<uint8_t>(format_.GetSizeOfFrame(), static_cast<uint8_t>(number));
+    auto stamp = SyntheticCapture::Stamp{ number, 0, number * 1000ull };
+    std::memcpy(data.data(), &stamp, sizeof(stamp));
+    return data;
+}
+
+static bool Publish(SharedFramePublisher& publisher, uint32_t number)
+{
+    auto data = MakeFrame(number);
+    auto frame = CaptureDataObject(data.data(), format_);
+    return publisher.Publish(&frame, number * 1000ull, number);
+}
+
+
+// 最初に最新のフレームを、その後は順にフレームを共有メモリ上のまま受け取り、固定中の枠は上書きされないこと
+TEST(TS_Shared_Frames, TC01)
+{
+    auto name = MakeName("TC01");
+    auto publisher = SharedFramePublisher(name, format_, 3);
+    ASSERT_TRUE(publisher.IsOpen());
+
+    auto client = SharedFrameCapture(name);
+    ASSERT_TRUE(client.IsOpen());
+    EXPECT_TRUE(client.IsZeroCopy());
+    EXPECT_EQ(client.GetFormat().GetSizeOfFrame(), format_.GetSizeOfFrame());
+
+    for (uint32_t n = 1; n <= 3; ++n)
+    {
+        EXPECT_TRUE(Publish(publisher, n));
+    }
+
+    auto first = client.Borrow();
+    ASSERT_NE(first, nullptr);
+    EXPECT_TRUE(client.Contains(first->Data));
+    EXPECT_EQ(SyntheticCapture::StampOf(first.get()).Number, 3u);
+    EXPECT_EQ(client.GetLastCapturedTime(), 3000u);
+    first.reset();
+
+    EXPECT_TRUE(Publish(publisher, 4));
+    EXPECT_TRUE(Publish(publisher, 5));
+    auto fourth = client.Borrow();
+    auto fifth = client.Borrow();
+    ASSERT_NE(fourth, nullptr);
+    ASSERT_NE(fifth, nullptr);
+    EXPECT_EQ(SyntheticCapture::StampOf(fourth.get()).Number, 4u);
+    EXPECT_EQ(SyntheticCapture::StampOf(fifth.get()).Number, 5u);
+    EXPECT_EQ(static_cast<const uint8_t*>(fifth->Data)[format_.GetSizeOfFrame() - 1], 5);
+    EXPECT_EQ(publisher.GetNumPinned(), 2);
+
+    // 4 and 5 are pinned and 6 is the newest: no slot left for 7
+    EXPECT_TRUE(Publish(publisher, 6));
+    EXPECT_FALSE(Publish(publisher, 7));
+    EXPECT_EQ(publisher.GetNumSkipped(), 1u);
+    EXPECT_EQ(SyntheticCapture::StampOf(fourth.get()).Number, 4u);
+
+    fourth.reset();
+    EXPECT_TRUE(Publish(publisher, 8));
+    EXPECT_EQ(SyntheticCapture::StampOf(client.Borrow().get()).Number, 6u);
+    EXPECT_EQ(SyntheticCapture::StampOf(client.Borrow().get()).Number, 8u);
+    EXPECT_EQ(client.GetNumMissed(), 1u);  // 7
+
+    // frames held by the client outlive the ring
+    publisher.Close();
+    EXPECT_EQ(client.Borrow(), nullptr);
+    EXPECT_EQ(SyntheticCapture::StampOf(fifth.get()).Number, 5u);
+}
+
+// 一つの制御器のフレームを、複写なしと複写ありの二つの制御器がそれぞれ順に受け取り、公開の終了で終わること
+TEST(TS_Shared_Frames, TC02)
+{
+    constexpr int numReads = 20;
+    auto name = MakeName("TC02");
+
+    auto source = MultiThreadCaptureController(new SyntheticCapture(format_.Width, format_.Height, 3, 500.0), is_cap_delete_, is_dbg_);
+    source.Setup();
+    auto publisher = SharedFramePublisher(name, source.GetFormat(), 16);
+    ASSERT_TRUE(publisher.Start(&source));
+    source.StartCapture();
+
+    auto clients = std::vector<std::unique_ptr<MultiThreadCaptureController>>{};
+    for (auto isZeroCopy : { true, false })
+    {
+        auto capture = new SharedFrameCapture(name, isZeroCopy);
+        ASSERT_TRUE(capture->IsOpen());
+        clients.emplace_back(new MultiThreadCaptureController(capture, is_cap_delete_, is_dbg_));
+        clients.back()->Setup();
+        clients.back()->StartCapture();
+    }
+
+    for (auto& client : clients)
+    {
+        uint64_t lastSequence = 0;
+        uint32_t lastNumber = 0;
+        for (int n = 0; n < numReads; ++n)
+        {
+            auto lease = client->LeaseNext(lastSequence);
+            ASSERT_TRUE(lease.IsValid());
+            auto number = SyntheticCapture::StampOf(lease.Get()).Number;
+            EXPECT_GT(number, lastNumber);
+            EXPECT_EQ(static_cast<const uint8_t*>(lease.Data())[format_.GetSizeOfFrame() - 1], static_cast<uint8_t>(number));
+            lastNumber = number;
+            lastSequence = lease.GetSequence();
+        }
+    }
+    EXPECT_GT(publisher.GetNumPublished(), static_cast<uint64_t>(numReads));
+
+    source.FinishCapture();
+    publisher.Close();
+
+    // the clients' sources end, so their readers get an invalid lease
+    for (auto& client : clients)
+    {
+        uint64_t lastSequence = 0;
+        while (auto lease = client->LeaseNext(lastSequence))
+        {
+            lastSequence = lease.GetSequence();
+        }
+        client->FinishCapture();
+    }
+}
+
+// 別のプロセスが名前で共有メモリを開き、公開されたフレームを順に受け取れること
+TEST(TS_Shared_Frames, TC03)
+{
+    constexpr uint32_t numFrames = 10;
+    auto name = MakeName("TC03");
+
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        // wait for the parent to create the ring
+        auto client = std::unique_ptr<SharedFrameCapture>{};
+        for (int n = 0; (n < 2000) && ((client == nullptr) || !client->IsOpen()); ++n)
+        {
+            client.reset(new SharedFrameCapture(name, false));
+            usleep(1000);
+        }
+        if (!client->IsOpen())
+        {
+            _exit(2);
+        }
+
+        auto data = std::vector<uint8_t>(format_.GetSizeOfFrame());
+        auto frame = CaptureDataObject(data.data(), format_);
+        uint32_t lastNumber = 0;
+        for (uint32_t n = 0; n < numFrames; ++n)
+        {
+            if (!client->Capture(&frame))
+            {
+                _exit(3);
+            }
+            auto number = SyntheticCapture::StampOf(&frame).Number;
+            if ((number <= lastNumber) || (data.back() != static_cast<uint8_t>(number)))
+            {
+                _exit(4);
+            }
+            lastNumber = number;
+        }
+        _exit(0);
+    }
+
+    auto publisher = SharedFramePublisher(name, format_, 4);
+    ASSERT_TRUE(publisher.IsOpen());
+
+    auto status = 0;
+    auto isExited = false;
+    for (uint32_t n = 1; (n < 5000) && !isExited; ++n)
+    {
+        Publish(publisher, n);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        isExited = (waitpid(pid, &status, WNOHANG) == pid);
+    }
+    if (!isExited)
+    {
+        publisher.Close();
+        waitpid(pid, &status, 0);
+    }
+
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+// フレームを固定したまま終了したプロセスの固定を公開側が取り戻し、生きている利用者の固定は残すこと
+TEST(TS_Shared_Frames, TC04)
+{
+    auto name = MakeName("TC04");
+    auto publisher = SharedFramePublisher(name, format_, 2);
+    ASSERT_TRUE(publisher.IsOpen());
+    EXPECT_TRUE(Publish(publisher, 1));
+
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        // dies holding frame 1, without unpinning it
+        auto client = new SharedFrameCapture(name);
+        auto frame = client->IsOpen() ? client->Borrow() : nullptr;
+        auto leaked = new std::shared_ptr<CaptureDataObject>(frame);
+        _exit(((*leaked != nullptr) && (SyntheticCapture::StampOf(leaked->get()).Number == 1)) ? 0 : 2);
+    }
+
+    // a process not reaped yet still counts as alive
+    auto status = 0;
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(publisher.GetNumPinned(), 1);
+
+    // 1 is pinned by the dead client and 2 is the newest: 3 only fits once the pin is taken back
+    EXPECT_TRUE(Publish(publisher, 2));
+    EXPECT_TRUE(Publish(publisher, 3));
+    EXPECT_EQ(publisher.GetNumReclaimed(), 1u);
+    EXPECT_EQ(publisher.GetNumSkipped(), 0u);
+
+    auto client = SharedFrameCapture(name);
+    ASSERT_TRUE(client.IsOpen());
+    auto held = client.Borrow();
+    ASSERT_NE(held, nullptr);
+    EXPECT_EQ(SyntheticCapture::StampOf(held.get()).Number, 3u);
+
+    // the pin of a live client stays
+    EXPECT_TRUE(Publish(publisher, 4));
+    EXPECT_FALSE(Publish(publisher, 5));
+    EXPECT_EQ(publisher.GetNumReclaimed(), 1u);
+    EXPECT_EQ(SyntheticCapture::StampOf(held.get()).Number, 3u);
+}
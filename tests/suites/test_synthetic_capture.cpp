@@ -0,0 +1,139 @@
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <chrono>
+#include <gtest/gtest.h>
+#include "common/MultiThreadCaptureController.hpp"
+#include "common/SyntheticCapture.hpp"
+
+#ifndef NDEBUG
+constexpr bool is_dbg_ = true;
+#else
+constexpr bool is_dbg_ = false;
+#endif
+constexpr bool is_cap_delete_ = true;
+
+
+// 指定したフレームレートと揺らぎの範囲で番号順にフレームを生成し、指定枚数で終了すること
+TEST(TS_Synthetic_Capture, TC01)
+{
+    constexpr double fps = 200.0;
+    constexpr int jitter_us = 1000;
+    constexpr int numFrames = 20;
+    constexpr uint64_t period = static_cast<uint64_t>(1e9 / fps);
+
+    auto cap = SyntheticCapture(32, 18, 3, fps, jitter_us, numFrames, 1);
+    EXPECT_EQ(cap.GetFormat().GetSizeOfFrame(), 32u * 18u * 3u);
+
+    auto buffer = std::vector<uint8_t>(cap.GetFormat().GetSizeOfFrame());
+    auto object = CaptureDataObject(buffer.data(), cap.GetFormat());
+
+    uint64_t first = 0;
+    for (int n = 1; n <= numFrames; ++n)
+    {
+        ASSERT_TRUE(cap.Capture(&object));
+        auto stamp = SyntheticCapture::StampOf(&object);
+        EXPECT_EQ(stamp.Number, static_cast<uint32_t>(n));
+        EXPECT_EQ(buffer.back(), static_cast<uint8_t>(n));
+        EXPECT_LE(stamp.Time, SyntheticCapture::GetTimeAsNs());
+
+        if (n == 1)
+        {
+            first = stamp.Time;
+            continue;
+        }
+        // the first frame is itself up to +jitter late (never early, as it starts the schedule),
+        // so against it a frame is off by -2 jitter to +jitter
+        auto offset = static_cast<int64_t>(stamp.Time - first) - static_cast<int64_t>((n - 1) * period);
+        EXPECT_GE(offset, -2 * jitter_us * 1000);
+        EXPECT_LE(offset, jitter_us * 1000);
+    }
+    EXPECT_FALSE(cap.Capture(&object));
+}
+
+// 読み手の受け取る時刻がフレームの予定時刻より後になること
+TEST(TS_Synthetic_Capture, TC02)
+{
+    auto controller = MultiThreadCaptureController(new SyntheticCapture(64, 36, 3, 500.0, 0, 50), is_cap_delete_, is_dbg_);
+    controller.Setup();
+    auto consumer = controller.RegisterConsumer();
+    controller.StartCapture();
+
+    uint32_t lastNumber = 0;
+    while (auto lease = consumer->ReadNext())
+    {
+        auto stamp = SyntheticCapture::StampOf(lease.Get());
+        EXPECT_GT(stamp.Number, lastNumber);
+        EXPECT_LE(stamp.Time, lease.GetCapturedTime());
+        lastNumber = stamp.Number;
+    }
+
+    consumer.reset();
+    controller.FinishCapture();
+}
+
+// 遅延デコードでは読み手の求めたフレームだけを取り出し、読み手が受け取るフレームは最新の取得であること
+TEST(TS_Synthetic_Capture, TC03)
+{
+    constexpr double fps = 500.0;
+    constexpr int numFrames = 200;
+    constexpr int numReads = 10;
+
+    auto config = CaptureControllerConfig{};
+    config.LazyRetrieve = true;
+    auto cap = new SyntheticCapture(64, 36, 3, fps, 0, numFrames);
+    auto controller = MultiThreadCaptureController(cap, !is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    controller.StartCapture();
+
+    uint32_t lastNumber = 0;
+    for (int n = 0; n < numReads; ++n)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        auto lease = controller.Lease();
+        ASSERT_TRUE(lease.IsValid());
+
+        // a read waits for the next grab rather than return a frame grabbed before it
+        auto stamp = SyntheticCapture::StampOf(lease.Get());
+        EXPECT_GT(stamp.Number, lastNumber + 1);
+        lastNumber = stamp.Number;
+    }
+
+    controller.FinishCapture();
+    auto stats = controller.GetStats();
+    EXPECT_EQ(stats.Produced, cap->GetNumRetrieved());
+    EXPECT_EQ(stats.Produced + stats.NotRetrieved, cap->GetNumCaptured());
+    EXPECT_LT(cap->GetNumRetrieved() * 2, cap->GetNumCaptured());
+    delete cap;
+}
+
+// 遅延デコードでも待ち続ける読み手には取得順にフレームが届くこと
+TEST(TS_Synthetic_Capture, TC04)
+{
+    constexpr int numFrames = 50;
+
+    auto config = CaptureControllerConfig{};
+    config.LazyRetrieve = true;
+    auto cap = new SyntheticCapture(64, 36, 3, 200.0, 0, numFrames);
+    auto controller = MultiThreadCaptureController(cap, !is_cap_delete_, config, is_dbg_);
+    controller.Setup();
+    auto consumer = controller.RegisterConsumer();
+    controller.StartCapture();
+
+    uint32_t lastNumber = 0;
+    uint64_t numRead = 0;
+    while (auto lease = consumer->ReadNext())
+    {
+        auto stamp = SyntheticCapture::StampOf(lease.Get());
+        EXPECT_GT(stamp.Number, lastNumber);
+        lastNumber = stamp.Number;
+        ++numRead;
+    }
+
+    consumer.reset();
+    controller.FinishCapture();
+    auto stats = controller.GetStats();
+    EXPECT_EQ(stats.Produced + stats.NotRetrieved, static_cast<uint64_t>(numFrames));
+    EXPECT_GE(numRead * 2, static_cast<uint64_t>(numFrames));
+    delete cap;
+}
@@ -1,7 +1,83 @@
 #!/usr/bin/python3
 
+"""Write numbered images for CvImageSequenceCapture.
+
+Frames come from a movie (e.g. ./movie/firework.mp4) or, with --synthetic, are generated;
+a synthetic frame n is filled with the value n % 256, so readers can check order and content.
+
+    tools/make_seqimages.py ./movie/firework.mp4 ./seqimages
+    tools/make_seqimages.py --synthetic 320x240 --count 100 --ext jpg ./seqimages
+"""
+
+import argparse
+import os
+import sys
+
+import cv2
+import numpy as np
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='write numbered images from a movie or synthetic frames')
+    parser.add_argument('input', nargs='?', help='movie to split (omit with --synthetic)')
+    parser.add_argument('output', help='directory to write the images to')
+    parser.add_argument('--synthetic', metavar='WxH', help='generate frames of this size instead of reading a movie')
+    parser.add_argument('--count', type=int, default=0, help='number of frames (0: whole movie, 100 for --synthetic)')
+    parser.add_argument('--start', type=int, default=0, help='number of the first image')
+    parser.add_argument('--step', type=int, default=1, help='keep every n-th frame of the movie')
+    parser.add_argument('--ext', default='png', choices=['png', 'jpg', 'bmp', 'tiff', 'webp'], help='image format')
+    parser.add_argument('--pattern', default='frame_%06d', help='printf pattern of the file names, without extension')
+
+    args = parser.parse_args()
+    if (args.input is None) == (args.synthetic is None):
+        parser.error('give either a movie or --synthetic WxH')
+
+    return args
+
+
+def synthetic_frames(size, count):
+    width, height = (int(v) for v in size.lower().split('x'))
+    for n in range(count if count > 0 else 100):
+        yield np.full((height, width, 3), n % 256, dtype=np.uint8)
+
+
+def movie_frames(path, count, step):
+    cap = cv2.VideoCapture(path)
+    if not cap.isOpened():
+        sys.exit('fail to open ' + path)
+
+    written = 0
+    index = 0
+    while count == 0 or written < count:
+        ret, frame = cap.read()
+        if not ret:
+            break
+        if index % step == 0:
+            written += 1
+            yield frame
+        index += 1
+
+    cap.release()
+
+
+def main():
+    args = parse_args()
+    os.makedirs(args.output, exist_ok=True)
+
+    if args.synthetic is not None:
+        frames = synthetic_frames(args.synthetic, args.count)
+    else:
+        frames = movie_frames(args.input, args.count, max(args.step, 1))
+
+    number = args.start
+    for frame in frames:
+        path = os.path.join(args.output, (args.pattern % number) + '.' + args.ext)
+        if not cv2.imwrite(path, frame):
+            sys.exit('fail to write ' + path)
+        number += 1
+
+    print('{} images written to {}'.format(number - args.start, args.output))
 
 
 if __name__ == '__main__':
     main()
-